@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CpuRadixSort.h"
+#include "MultiRadixSort.h"
+#include "MultiRadixSortVerifyPass.h"
+#include "SingleRadixSortPass.h"
+#include "engine/util/KeyGenerator.h"
+
+#include <map>
+#include <ostream>
+
+namespace engine {
+    /**
+     * Sweeps element counts, key widths, key distributions, key value payload, sorting engines and blocks per work group.
+     * Every configuration is sorted m_warmup + m_repetitions times from the same (deterministic) input, the GPU time is the
+     * sum of the timestamp query timings of the dispatches (ComputePass profiling), the wall time includes submission and waiting.
+     * The key width is the number of significant bits of the keys, the multi radix sort only runs the required 8 bit digit passes.
+     * Configurations that do not fit into the device (memory budget, storage buffer range) or are not supported by an engine are
+     * reported as skipped.
+     */
+    class RadixSortBench {
+    public:
+        enum class Engine {
+            SINGLE, // single work group GPU radix sort
+            MULTI,  // multiple work groups GPU radix sort
+            CPU,    // multi-threaded cpu radix sort (CpuRadixSort)
+            STD,    // std::sort / std::stable_sort reference
+        };
+
+        struct Config {
+            std::vector<uint64_t> m_numElements = {100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+            std::vector<uint32_t> m_keyBits = {32};
+            std::vector<KeyGenerator::Distribution> m_distributions = {KeyGenerator::Distribution::UNIFORM};
+            std::vector<bool> m_payload = {false, true};
+            std::vector<Engine> m_engines = {Engine::SINGLE, Engine::MULTI, Engine::CPU, Engine::STD};
+            std::vector<uint32_t> m_blocksPerWorkgroup = {MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP}; // 0 = persistent work groups
+            uint32_t m_warmup = 2;
+            uint32_t m_repetitions = 10;
+            uint64_t m_seed = 42;
+            uint64_t m_singleMaxElements = 1000000; // the single work group sort gets very slow for large inputs
+            bool m_verify = true;
+
+            std::string m_singleResourceDirectoryPath; // shaders of the single and multi radix sort
+            std::string m_multiResourceDirectoryPath;
+        };
+
+        struct Result {
+            Engine m_engine;
+            uint64_t m_numElements;
+            uint32_t m_keyBits;
+            bool m_payload;
+            uint32_t m_blocksPerWorkgroup; // multi radix sort only
+            uint32_t m_workgroups;         // multi radix sort only
+            uint32_t m_repetitions;
+            KeyGenerator::Distribution m_distribution = KeyGenerator::Distribution::UNIFORM;
+
+            double m_gpuMedianMs = 0.0; // timestamp queries, 0 for the cpu
+            double m_gpuP95Ms = 0.0;
+            double m_gpuMinMs = 0.0;
+            double m_gpuMeanMs = 0.0;
+            double m_wallMedianMs = 0.0;
+            double m_wallP95Ms = 0.0;
+
+            std::string m_status = "ok"; // "ok", "failed" or "skipped: <reason>"
+
+            // million keys per second of the median (gpu time if measured, wall time otherwise)
+            [[nodiscard]] double getMillionKeysPerSecond() const;
+        };
+
+        RadixSortBench(GPUContext *gpuContext, Config config);
+
+        std::vector<Result> run();
+
+        void release();
+
+        static std::string getEngineName(Engine engine);
+
+        static Engine parseEngine(const std::string &name);
+
+        static void writeCsv(std::ostream &stream, const std::vector<Result> &results);
+
+        void writeJson(std::ostream &stream, const std::vector<Result> &results) const;
+
+    private:
+        GPUContext *m_gpuContext;
+        Config m_config;
+
+        // created once per variant, the shaders are compiled on creation
+        std::map<std::pair<bool, bool>, std::shared_ptr<MultiRadixSortPass>> m_multiPasses; // {keyValue, largeElementCount}
+        std::map<bool, std::shared_ptr<MultiRadixSortVerifyPass>> m_verifyPasses; // {keyValue}
+        std::shared_ptr<SingleRadixSortPass> m_singlePass;
+        CpuRadixSort m_cpuRadixSort;
+
+        static inline const char *PRINT_PREFIX = "[RadixSortBench] ";
+
+        Result runSingle(const std::vector<SORT_TYPE> &keys, uint32_t keyBits);
+
+        Result runMulti(const std::vector<SORT_TYPE> &keys, uint32_t keyBits, bool payload, uint32_t blocksPerWorkgroup);
+
+        // CPU or STD engine
+        Result runCpu(Engine engine, const std::vector<SORT_TYPE> &keys, uint32_t keyBits, bool payload);
+
+        std::shared_ptr<MultiRadixSortPass> getMultiPass(bool keyValue, bool largeElementCount);
+
+        std::shared_ptr<MultiRadixSortVerifyPass> getVerifyPass(bool keyValue);
+
+        // keys with keyBits significant bits, deterministic for the seed
+        void generateKeys(std::vector<SORT_TYPE> &keys, uint64_t numElements, uint32_t keyBits, KeyGenerator::Distribution distribution) const;
+
+        // sorted by the keyBits least significant bits, values (if not empty) are the indices of the keys in the input
+        static bool verify(const std::vector<SORT_TYPE> &input, const std::vector<SORT_TYPE> &keys, const std::vector<VALUE_TYPE> &values);
+
+        // median, p95, min and mean of the measurements
+        static void computeStatistics(std::vector<double> measurements, double &median, double &p95, double &min, double &mean);
+
+        static double getElapsedMs(std::chrono::steady_clock::time_point begin);
+    };
+} // namespace engine
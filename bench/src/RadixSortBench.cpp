@@ -0,0 +1,443 @@
+#include "RadixSortBench.h"
+
+#include <numeric>
+
+namespace engine {
+
+    double RadixSortBench::Result::getMillionKeysPerSecond() const {
+        const double ms = m_gpuMedianMs > 0.0 ? m_gpuMedianMs : m_wallMedianMs;
+        return ms > 0.0 ? static_cast<double>(m_numElements) / (ms * 1e3) : 0.0;
+    }
+
+    RadixSortBench::RadixSortBench(GPUContext *gpuContext, Config config) : m_gpuContext(gpuContext), m_config(std::move(config)) {
+    }
+
+    std::vector<RadixSortBench::Result> RadixSortBench::run() {
+        std::vector<Result> results;
+        std::vector<SORT_TYPE> keys;
+        for (const uint64_t numElements: m_config.m_numElements) {
+            for (const uint32_t keyBits: m_config.m_keyBits) {
+                if (keyBits == 0 || keyBits > sizeof(SORT_TYPE) * 8) {
+                    throw std::runtime_error("Invalid key width " + std::to_string(keyBits) + "!");
+                }
+                for (const KeyGenerator::Distribution distribution: m_config.m_distributions) {
+                    try {
+                        generateKeys(keys, numElements, keyBits, distribution);
+                    } catch (const std::bad_alloc &) {
+                        std::cerr << PRINT_PREFIX << "Not enough host memory for " << numElements << " keys, skipping." << std::endl;
+                        continue;
+                    }
+                    for (const Engine engine: m_config.m_engines) {
+                        for (const bool payload: m_config.m_payload) {
+                            // the blocks per work group are only swept for the multi radix sort
+                            const std::vector<uint32_t> blocks = engine == Engine::MULTI ? m_config.m_blocksPerWorkgroup : std::vector<uint32_t>{0};
+                            for (const uint32_t blocksPerWorkgroup: blocks) {
+                                Result result{engine, numElements, keyBits, payload, 0, 0, m_config.m_repetitions};
+                                try {
+                                    if (engine == Engine::SINGLE && payload) {
+                                        result.m_status = "skipped: no key value support";
+                                    } else if (engine == Engine::SINGLE) {
+                                        result = runSingle(keys, keyBits);
+                                    } else if (engine == Engine::MULTI) {
+                                        result = runMulti(keys, keyBits, payload, blocksPerWorkgroup);
+                                    } else {
+                                        result = runCpu(engine, keys, keyBits, payload);
+                                    }
+                                } catch (const std::exception &e) {
+                                    result.m_status = std::string("failed: ") + e.what();
+                                }
+                                result.m_distribution = distribution;
+                                std::cout << PRINT_PREFIX << getEngineName(engine) << " n=" << numElements << " bits=" << keyBits << " distribution=" << KeyGenerator::getDistributionName(distribution) << " payload=" << payload;
+                                if (engine == Engine::MULTI) {
+                                    std::cout << " blocks=" << result.m_blocksPerWorkgroup << " workgroups=" << result.m_workgroups;
+                                }
+                                if (result.m_status == "ok") {
+                                    std::cout << " gpu median=" << result.m_gpuMedianMs << "[ms] p95=" << result.m_gpuP95Ms << "[ms] wall median=" << result.m_wallMedianMs << "[ms] " << result.getMillionKeysPerSecond() << "[Mkeys/s]" << std::endl;
+                                } else {
+                                    std::cout << " " << result.m_status << std::endl;
+                                }
+                                results.push_back(result);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+    void RadixSortBench::release() {
+        for (auto &[variant, pass]: m_multiPasses) {
+            pass->release();
+        }
+        m_multiPasses.clear();
+        for (auto &[keyValue, pass]: m_verifyPasses) {
+            pass->release();
+        }
+        m_verifyPasses.clear();
+        if (m_singlePass) {
+            m_singlePass->release();
+            m_singlePass = nullptr;
+        }
+    }
+
+    RadixSortBench::Result RadixSortBench::runSingle(const std::vector<SORT_TYPE> &keys, uint32_t keyBits) {
+        const uint64_t numElements = keys.size();
+        Result result{Engine::SINGLE, numElements, keyBits, false, 0, 1, m_config.m_repetitions};
+        if (m_gpuContext == nullptr) {
+            result.m_status = "skipped: no device";
+            return result;
+        }
+        if (numElements > m_config.m_singleMaxElements) {
+            result.m_status = "skipped: more than " + std::to_string(m_config.m_singleMaxElements) + " elements";
+            return result;
+        }
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        const VkDeviceSize keyBytes = numElements * sizeof(SORT_TYPE);
+        if (keyBytes > deviceProperties.limits.maxStorageBufferRange) {
+            result.m_status = "skipped: larger than maxStorageBufferRange";
+            return result;
+        }
+
+        if (!m_singlePass) {
+            Paths::m_resourceDirectoryPath = m_config.m_singleResourceDirectoryPath;
+            m_singlePass = std::make_shared<SingleRadixSortPass>(m_gpuContext);
+            m_singlePass->create();
+            m_singlePass->enableProfiling();
+            m_singlePass->setGlobalInvocationSize(SingleRadixSortPass::RADIX_SORT, 256, 1, 1); // a single work group
+        }
+        m_singlePass->m_pushConstants.g_num_elements = static_cast<uint32_t>(numElements);
+
+        auto input = Buffer::fillDeviceWithStagingBuffer(m_gpuContext, {.m_sizeBytes = keyBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "bench.input"}, keys.data());
+        auto buffer0 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = keyBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "bench.elementBuffer0"});
+        auto buffer1 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = keyBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "bench.elementBuffer1"});
+        m_singlePass->setStorageBuffer(SingleRadixSortPass::RADIX_SORT, 0, buffer0.get());
+        m_singlePass->setStorageBuffer(SingleRadixSortPass::RADIX_SORT, 1, buffer1.get());
+
+        std::vector<double> gpuTimes;
+        std::vector<double> wallTimes;
+        for (uint32_t i = 0; i < m_config.m_warmup + m_config.m_repetitions; i++) {
+            m_gpuContext->executeCommands([&](VkCommandBuffer commandBuffer) {
+                VkBufferCopy copyRegion{.srcOffset = 0, .dstOffset = 0, .size = keyBytes};
+                vkCmdCopyBuffer(commandBuffer, input->getBuffer(), buffer0->getBuffer(), 1, &copyRegion);
+            });
+            m_singlePass->clearProfilingResults();
+
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            m_singlePass->execute(VK_NULL_HANDLE);
+            m_singlePass->wait();
+            const double wallTime = getElapsedMs(begin);
+
+            double gpuTime = 0.0;
+            for (const auto &timing: m_singlePass->getProfilingResults()) {
+                gpuTime += timing.m_milliseconds;
+            }
+            if (i >= m_config.m_warmup) {
+                gpuTimes.push_back(gpuTime);
+                wallTimes.push_back(wallTime);
+            }
+        }
+        double unused;
+        computeStatistics(gpuTimes, result.m_gpuMedianMs, result.m_gpuP95Ms, result.m_gpuMinMs, result.m_gpuMeanMs);
+        computeStatistics(wallTimes, result.m_wallMedianMs, result.m_wallP95Ms, unused, unused);
+
+        if (m_config.m_verify) {
+            std::vector<SORT_TYPE> sorted(numElements);
+            buffer0->downloadWithStagingBuffer(sorted.data());
+            if (!verify(keys, sorted, {})) {
+                result.m_status = "failed";
+            }
+        }
+
+        input->release();
+        buffer0->release();
+        buffer1->release();
+        return result;
+    }
+
+    RadixSortBench::Result RadixSortBench::runMulti(const std::vector<SORT_TYPE> &keys, uint32_t keyBits, bool payload, uint32_t blocksPerWorkgroup) {
+        const uint64_t numElements = keys.size();
+        Result result{Engine::MULTI, numElements, keyBits, payload, blocksPerWorkgroup, 0, m_config.m_repetitions};
+        if (m_gpuContext == nullptr) {
+            result.m_status = "skipped: no device";
+            return result;
+        }
+        const bool largeElementCount = MultiRadixSortPass::requiresLargeElementCount(m_gpuContext, numElements);
+        if (largeElementCount && !m_gpuContext->supportsLargeBuffers()) {
+            result.m_status = "skipped: larger than maxStorageBufferRange";
+            return result;
+        }
+        const VkDeviceSize keyBytes = numElements * sizeof(SORT_TYPE);
+        const VkDeviceSize valueBytes = payload ? numElements * sizeof(VALUE_TYPE) : 0;
+        if (3 * (keyBytes + valueBytes) > m_gpuContext->getDeviceLocalMemoryBudget()) { // input, ping pong buffers
+            result.m_status = "skipped: device memory budget";
+            return result;
+        }
+
+        auto pass = getMultiPass(payload, largeElementCount);
+        result.m_blocksPerWorkgroup = blocksPerWorkgroup > 0 ? blocksPerWorkgroup : MultiRadixSortPass::getPersistentBlocksPerWorkgroup(m_gpuContext, numElements);
+        try {
+            pass->setNumElements(numElements, result.m_blocksPerWorkgroup);
+        } catch (const std::runtime_error &e) {
+            result.m_status = std::string("skipped: ") + e.what();
+            return result;
+        }
+        result.m_workgroups = pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT).width;
+
+        VkBufferUsageFlags usages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        std::optional<VkMemoryAllocateFlagBits> allocateFlags{};
+        if (largeElementCount) {
+            usages |= MultiRadixSortPass::LARGE_ELEMENT_COUNT_BUFFER_USAGES;
+            allocateFlags = MultiRadixSortPass::LARGE_ELEMENT_COUNT_MEMORY_ALLOCATE_FLAGS;
+        }
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        auto input = Buffer::fillDeviceWithStagingBuffer(m_gpuContext, {.m_sizeBytes = keyBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "bench.input"}, keys.data());
+        auto buffer0 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = keyBytes, .m_bufferUsages = usages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = allocateFlags, .m_name = "bench.elementBuffer0"});
+        auto buffer1 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = keyBytes, .m_bufferUsages = usages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = allocateFlags, .m_name = "bench.elementBuffer1"});
+        auto histograms = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = MultiRadixSortPass::getHistogramsSizeBytes(result.m_workgroups), .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "bench.histograms"});
+        buffers = {input, buffer0, buffer1, histograms};
+        std::shared_ptr<Buffer> valuesInput;
+        std::shared_ptr<Buffer> values0;
+        std::shared_ptr<Buffer> values1;
+        if (payload) {
+            std::vector<VALUE_TYPE> values(numElements);
+            std::iota(values.begin(), values.end(), 0);
+            valuesInput = Buffer::fillDeviceWithStagingBuffer(m_gpuContext, {.m_sizeBytes = valueBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "bench.valuesInput"}, values.data());
+            values0 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = valueBytes, .m_bufferUsages = usages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = allocateFlags, .m_name = "bench.valueBuffer0"});
+            values1 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = valueBytes, .m_bufferUsages = usages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = allocateFlags, .m_name = "bench.valueBuffer1"});
+            buffers.insert(buffers.end(), {valuesInput, values0, values1});
+        }
+
+        // only the digit passes covering keyBits, the result is in buffer1 for an odd number of passes
+        const uint32_t numIterations = (keyBits + 7) / 8;
+        std::vector<double> gpuTimes;
+        std::vector<double> wallTimes;
+        for (uint32_t i = 0; i < m_config.m_warmup + m_config.m_repetitions; i++) {
+            m_gpuContext->executeCommands([&](VkCommandBuffer commandBuffer) {
+                VkBufferCopy copyRegion{.srcOffset = 0, .dstOffset = 0, .size = keyBytes};
+                vkCmdCopyBuffer(commandBuffer, input->getBuffer(), buffer0->getBuffer(), 1, &copyRegion);
+                if (payload) {
+                    copyRegion.size = valueBytes;
+                    vkCmdCopyBuffer(commandBuffer, valuesInput->getBuffer(), values0->getBuffer(), 1, &copyRegion);
+                }
+            });
+            pass->setBuffers(buffer0.get(), buffer1.get(), histograms.get(), values0.get(), values1.get()); // the ping pong starts at the active index
+            pass->clearProfilingResults();
+
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            pass->sort(VK_NULL_HANDLE, numIterations);
+            pass->wait();
+            const double wallTime = getElapsedMs(begin);
+
+            double gpuTime = 0.0;
+            for (const auto &timing: pass->getProfilingResults()) {
+                gpuTime += timing.m_milliseconds;
+            }
+            if (i >= m_config.m_warmup) {
+                gpuTimes.push_back(gpuTime);
+                wallTimes.push_back(wallTime);
+            }
+        }
+        double unused;
+        computeStatistics(gpuTimes, result.m_gpuMedianMs, result.m_gpuP95Ms, result.m_gpuMinMs, result.m_gpuMeanMs);
+        computeStatistics(wallTimes, result.m_wallMedianMs, result.m_wallP95Ms, unused, unused);
+
+        if (m_config.m_verify && !largeElementCount) {
+            // on the gpu, the values are the indices of the keys so the stability is checked as well
+            auto verifyPass = getVerifyPass(payload);
+            verifyPass->setBuffers(input.get(), (numIterations % 2 == 0 ? buffer0 : buffer1).get(), valuesInput.get(), (numIterations % 2 == 0 ? values0 : values1).get());
+            if (!verifyPass->verify(numElements, payload).isValid()) {
+                result.m_status = "failed";
+            }
+        } else if (m_config.m_verify) {
+            // the verification pass indexes with 32 bits
+            std::vector<SORT_TYPE> sorted(numElements);
+            (numIterations % 2 == 0 ? buffer0 : buffer1)->downloadWithStagingBuffer(sorted.data());
+            std::vector<VALUE_TYPE> sortedValues;
+            if (payload) {
+                sortedValues.resize(numElements);
+                (numIterations % 2 == 0 ? values0 : values1)->downloadWithStagingBuffer(sortedValues.data());
+            }
+            if (!verify(keys, sorted, sortedValues)) {
+                result.m_status = "failed";
+            }
+        }
+
+        for (auto &buffer: buffers) {
+            buffer->release();
+        }
+        return result;
+    }
+
+    RadixSortBench::Result RadixSortBench::runCpu(Engine engine, const std::vector<SORT_TYPE> &keys, uint32_t keyBits, bool payload) {
+        const uint64_t numElements = keys.size();
+        Result result{engine, numElements, keyBits, payload, 0, 0, m_config.m_repetitions};
+
+        // the std engine sorts (key, index) pairs stably, the radix sort the keys and the indices in place
+        const bool useStd = engine == Engine::STD;
+        std::vector<SORT_TYPE> sorted;
+        std::vector<VALUE_TYPE> sortedValues;
+        std::vector<std::pair<SORT_TYPE, VALUE_TYPE>> pairs;
+        std::vector<double> wallTimes;
+        for (uint32_t i = 0; i < m_config.m_warmup + m_config.m_repetitions; i++) {
+            sorted = keys;
+            if (payload && useStd) {
+                pairs.resize(numElements);
+                for (uint64_t j = 0; j < numElements; j++) {
+                    pairs[j] = {keys[j], static_cast<VALUE_TYPE>(j)};
+                }
+            } else if (payload) {
+                sortedValues.resize(numElements);
+                std::iota(sortedValues.begin(), sortedValues.end(), 0);
+            }
+
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            if (useStd && payload) {
+                std::stable_sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+            } else if (useStd) {
+                std::sort(sorted.begin(), sorted.end());
+            } else if (payload) {
+                m_cpuRadixSort.sortInPlace(sorted, sortedValues);
+            } else {
+                m_cpuRadixSort.sortInPlace(sorted);
+            }
+            const double wallTime = getElapsedMs(begin);
+            if (i >= m_config.m_warmup) {
+                wallTimes.push_back(wallTime);
+            }
+        }
+        double unused;
+        computeStatistics(wallTimes, result.m_wallMedianMs, result.m_wallP95Ms, unused, unused);
+
+        if (m_config.m_verify) {
+            if (payload && useStd) {
+                sortedValues.resize(numElements);
+                for (uint64_t j = 0; j < numElements; j++) {
+                    sorted[j] = pairs[j].first;
+                    sortedValues[j] = pairs[j].second;
+                }
+            }
+            if (!verify(keys, sorted, sortedValues)) {
+                result.m_status = "failed";
+            }
+        }
+        return result;
+    }
+
+    std::shared_ptr<MultiRadixSortPass> RadixSortBench::getMultiPass(bool keyValue, bool largeElementCount) {
+        auto &pass = m_multiPasses[{keyValue, largeElementCount}];
+        if (!pass) {
+            Paths::m_resourceDirectoryPath = m_config.m_multiResourceDirectoryPath;
+            pass = std::make_shared<MultiRadixSortPass>(m_gpuContext, keyValue, largeElementCount);
+            pass->create();
+            pass->enableProfiling();
+        }
+        return pass;
+    }
+
+    std::shared_ptr<MultiRadixSortVerifyPass> RadixSortBench::getVerifyPass(bool keyValue) {
+        auto &pass = m_verifyPasses[keyValue];
+        if (!pass) {
+            Paths::m_resourceDirectoryPath = m_config.m_multiResourceDirectoryPath;
+            pass = std::make_shared<MultiRadixSortVerifyPass>(m_gpuContext, keyValue);
+            pass->create();
+        }
+        return pass;
+    }
+
+    void RadixSortBench::generateKeys(std::vector<SORT_TYPE> &keys, uint64_t numElements, uint32_t keyBits, KeyGenerator::Distribution distribution) const {
+        keys.resize(numElements);
+        KeyGenerator({.m_distribution = distribution, .m_seed = m_config.m_seed, .m_keyBits = keyBits}, numElements).generate(std::span<SORT_TYPE>(keys));
+    }
+
+    bool RadixSortBench::verify(const std::vector<SORT_TYPE> &input, const std::vector<SORT_TYPE> &keys, const std::vector<VALUE_TYPE> &values) {
+        for (uint64_t i = 1; i < keys.size(); i++) {
+            if (keys[i - 1] > keys[i]) {
+                std::cerr << PRINT_PREFIX << "keys[" << i - 1 << "] = " << keys[i - 1] << " > keys[" << i << "] = " << keys[i] << std::endl;
+                return false;
+            }
+        }
+        if (values.empty()) {
+            return true;
+        }
+        for (uint64_t i = 0; i < keys.size(); i++) {
+            if (values[i] >= input.size() || input[values[i]] != keys[i] || (i > 0 && keys[i - 1] == keys[i] && values[i - 1] >= values[i])) {
+                std::cerr << PRINT_PREFIX << "values[" << i << "] = " << values[i] << " is not the stable position of keys[" << i << "] = " << keys[i] << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void RadixSortBench::computeStatistics(std::vector<double> measurements, double &median, double &p95, double &min, double &mean) {
+        if (measurements.empty()) {
+            median = p95 = min = mean = 0.0;
+            return;
+        }
+        std::sort(measurements.begin(), measurements.end());
+        const size_t n = measurements.size();
+        median = n % 2 == 1 ? measurements[n / 2] : 0.5 * (measurements[n / 2 - 1] + measurements[n / 2]);
+        p95 = measurements[std::min(n - 1, static_cast<size_t>(std::ceil(0.95 * static_cast<double>(n))) - 1)]; // nearest rank
+        min = measurements.front();
+        mean = std::accumulate(measurements.begin(), measurements.end(), 0.0) / static_cast<double>(n);
+    }
+
+    double RadixSortBench::getElapsedMs(std::chrono::steady_clock::time_point begin) {
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3);
+    }
+
+    std::string RadixSortBench::getEngineName(Engine engine) {
+        switch (engine) {
+            case Engine::SINGLE:
+                return "single";
+            case Engine::MULTI:
+                return "multi";
+            case Engine::CPU:
+                return "cpu";
+            case Engine::STD:
+                return "std";
+        }
+        return "unknown";
+    }
+
+    RadixSortBench::Engine RadixSortBench::parseEngine(const std::string &name) {
+        for (const Engine engine: {Engine::SINGLE, Engine::MULTI, Engine::CPU, Engine::STD}) {
+            if (getEngineName(engine) == name) {
+                return engine;
+            }
+        }
+        throw std::invalid_argument("Unknown engine " + name + "!");
+    }
+
+    void RadixSortBench::writeCsv(std::ostream &stream, const std::vector<Result> &results) {
+        stream << "engine,num_elements,key_bits,distribution,payload,blocks_per_workgroup,workgroups,repetitions,gpu_median_ms,gpu_p95_ms,gpu_min_ms,gpu_mean_ms,wall_median_ms,wall_p95_ms,mkeys_per_s,status" << std::endl;
+        for (const auto &result: results) {
+            stream << getEngineName(result.m_engine) << "," << result.m_numElements << "," << result.m_keyBits << "," << KeyGenerator::getDistributionName(result.m_distribution) << "," << result.m_payload << "," << result.m_blocksPerWorkgroup << "," << result.m_workgroups << "," << result.m_repetitions << ","
+                   << result.m_gpuMedianMs << "," << result.m_gpuP95Ms << "," << result.m_gpuMinMs << "," << result.m_gpuMeanMs << "," << result.m_wallMedianMs << "," << result.m_wallP95Ms << "," << result.getMillionKeysPerSecond() << ",\"" << result.m_status << "\"" << std::endl;
+        }
+    }
+
+    void RadixSortBench::writeJson(std::ostream &stream, const std::vector<Result> &results) const {
+        stream << "{\n";
+        if (m_gpuContext != nullptr) {
+            VkPhysicalDeviceProperties deviceProperties;
+            vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+            stream << "  \"device\": \"" << deviceProperties.deviceName << "\",\n";
+            stream << "  \"driverVersion\": " << deviceProperties.driverVersion << ",\n";
+            stream << "  \"apiVersion\": \"" << VK_API_VERSION_MAJOR(deviceProperties.apiVersion) << "." << VK_API_VERSION_MINOR(deviceProperties.apiVersion) << "." << VK_API_VERSION_PATCH(deviceProperties.apiVersion) << "\",\n";
+        }
+        stream << "  \"cpuThreads\": " << m_cpuRadixSort.getNumThreads() << ",\n  \"cpuHistogramKernel\": \"" << CpuRadixSort::getHistogramKernelName() << "\",\n";
+        stream << "  \"warmup\": " << m_config.m_warmup << ",\n  \"seed\": " << m_config.m_seed << ",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto &result = results[i];
+            stream << (i == 0 ? "\n    " : ",\n    ");
+            stream << "{\"engine\": \"" << getEngineName(result.m_engine) << "\", \"numElements\": " << result.m_numElements << ", \"keyBits\": " << result.m_keyBits << ", \"distribution\": \"" << KeyGenerator::getDistributionName(result.m_distribution) << "\", \"payload\": " << (result.m_payload ? "true" : "false")
+                   << ", \"blocksPerWorkgroup\": " << result.m_blocksPerWorkgroup << ", \"workgroups\": " << result.m_workgroups << ", \"repetitions\": " << result.m_repetitions
+                   << ", \"gpuMedianMs\": " << result.m_gpuMedianMs << ", \"gpuP95Ms\": " << result.m_gpuP95Ms << ", \"gpuMinMs\": " << result.m_gpuMinMs << ", \"gpuMeanMs\": " << result.m_gpuMeanMs
+                   << ", \"wallMedianMs\": " << result.m_wallMedianMs << ", \"wallP95Ms\": " << result.m_wallP95Ms << ", \"mkeysPerSecond\": " << result.getMillionKeysPerSecond() << ", \"status\": \"" << result.m_status << "\"}";
+        }
+        stream << "\n  ]\n}" << std::endl;
+    }
+} // namespace engine
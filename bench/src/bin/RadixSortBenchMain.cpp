@@ -0,0 +1,131 @@
+#include "RadixSortBench.h"
+#include "engine/core/GPUContext.h"
+
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+static void printUsage() {
+    std::cerr << "usage: radixsort_bench [--sizes N,...] [--key-bits B,...] [--distributions D,...] [--payload 0,1] [--engines single,multi,cpu,std] [--blocks N,...]" << std::endl;
+    std::cerr << "                       [--warmup N] [--repetitions N] [--seed N] [--single-max-elements N] [--no-verify] [--csv path] [--json path]" << std::endl;
+    std::cerr << "                       [--device best|index|uuid|name-regex] [--list-devices]" << std::endl;
+    std::cerr << "  --sizes                element counts (default 100,1000,...,1000000000, configurations exceeding the device are skipped)" << std::endl;
+    std::cerr << "  --key-bits             significant bits of the random keys, 8 to 32 (default 32)" << std::endl;
+    std::cerr << "  --distributions        uniform, sorted, reverse-sorted, nearly-sorted, all-equal, few-unique, zipf, morton (default uniform)" << std::endl;
+    std::cerr << "  --payload              0: keys only, 1: keys with a 32-bit value each (default 0,1)" << std::endl;
+    std::cerr << "  --engines              single / multi work group gpu sort, cpu: multi-threaded cpu radix sort, std: std::sort (default all)" << std::endl;
+    std::cerr << "  --blocks               blocks per work group of the multi radix sort, 0 for persistent work groups (default 32)" << std::endl;
+    std::cerr << "  --warmup/--repetitions unmeasured and measured runs per configuration (default 2 / 10)" << std::endl;
+    std::cerr << "  --device               device selection (default: ENGINE_DEVICE or the best device), --list-devices prints the suitable devices" << std::endl;
+    std::cerr << "set VK_DRIVER_FILES (or VK_ICD_FILENAMES) to the lavapipe icd to benchmark without a gpu" << std::endl;
+}
+
+template<typename T>
+static std::vector<T> parseList(const std::string &list, const std::function<T(const std::string &)> &parse) {
+    std::vector<T> values;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(parse(item));
+    }
+    return values;
+}
+
+int main(int argc, char *argv[]) {
+    engine::RadixSortBench::Config config;
+#ifdef SINGLE_RESOURCE_DIRECTORY_PATH
+    config.m_singleResourceDirectoryPath = SINGLE_RESOURCE_DIRECTORY_PATH;
+#endif
+#ifdef MULTI_RESOURCE_DIRECTORY_PATH
+    config.m_multiResourceDirectoryPath = MULTI_RESOURCE_DIRECTORY_PATH;
+#endif
+
+    std::string csvPath;
+    std::string jsonPath;
+    std::optional<engine::GPUContext::DeviceSelection> deviceSelection;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--sizes" && hasValue) {
+                config.m_numElements = parseList<uint64_t>(argv[++i], [](const std::string &s) { return static_cast<uint64_t>(std::stod(s)); }); // accepts 1e9
+            } else if (arg == "--key-bits" && hasValue) {
+                config.m_keyBits = parseList<uint32_t>(argv[++i], [](const std::string &s) { return static_cast<uint32_t>(std::stoul(s)); });
+            } else if (arg == "--distributions" && hasValue) {
+                config.m_distributions = parseList<engine::KeyGenerator::Distribution>(argv[++i], engine::KeyGenerator::parseDistribution);
+            } else if (arg == "--payload" && hasValue) {
+                config.m_payload = parseList<bool>(argv[++i], [](const std::string &s) { return std::stoul(s) != 0; });
+            } else if (arg == "--engines" && hasValue) {
+                config.m_engines = parseList<engine::RadixSortBench::Engine>(argv[++i], engine::RadixSortBench::parseEngine);
+            } else if (arg == "--blocks" && hasValue) {
+                config.m_blocksPerWorkgroup = parseList<uint32_t>(argv[++i], [](const std::string &s) { return static_cast<uint32_t>(std::stoul(s)); });
+            } else if (arg == "--warmup" && hasValue) {
+                config.m_warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--repetitions" && hasValue) {
+                config.m_repetitions = std::max(1U, static_cast<uint32_t>(std::stoul(argv[++i])));
+            } else if (arg == "--seed" && hasValue) {
+                config.m_seed = std::stoull(argv[++i]);
+            } else if (arg == "--single-max-elements" && hasValue) {
+                config.m_singleMaxElements = static_cast<uint64_t>(std::stod(argv[++i]));
+            } else if (arg == "--no-verify") {
+                config.m_verify = false;
+            } else if (arg == "--csv" && hasValue) {
+                csvPath = argv[++i];
+            } else if (arg == "--json" && hasValue) {
+                jsonPath = argv[++i];
+            } else if (arg == "--device" && hasValue) {
+                deviceSelection = engine::GPUContext::DeviceSelection::parse(argv[++i]);
+            } else if (arg == "--list-devices") {
+                for (const auto &device: engine::GPUContext::enumerateDevices(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY)) {
+                    std::cout << "[" << device.m_index << "] " << device.m_name << " uuid " << device.m_uuid << ", " << (device.m_deviceLocalMemory >> 20) << " MiB, subgroup size " << device.m_subgroupSize << std::endl;
+                }
+                return EXIT_SUCCESS;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+    } catch (const std::exception &) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // the cpu engines run without a vulkan device
+    const bool needsDevice = std::any_of(config.m_engines.begin(), config.m_engines.end(), [](auto engine) { return engine == engine::RadixSortBench::Engine::SINGLE || engine == engine::RadixSortBench::Engine::MULTI; });
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    if (deviceSelection) {
+        gpu.m_deviceSelection = *deviceSelection;
+    }
+
+    try {
+        if (needsDevice) {
+            gpu.init();
+        }
+
+        engine::RadixSortBench bench(needsDevice ? &gpu : nullptr, config);
+        const auto results = bench.run();
+        bench.release();
+
+        if (!csvPath.empty()) {
+            std::ofstream file(csvPath);
+            engine::RadixSortBench::writeCsv(file, results);
+        }
+        if (!jsonPath.empty()) {
+            std::ofstream file(jsonPath);
+            bench.writeJson(file, results);
+        }
+
+        if (needsDevice) {
+            gpu.shutdown();
+        }
+
+        if (std::any_of(results.begin(), results.end(), [](const auto &result) { return result.m_status.rfind("failed", 0) == 0; })) {
+            std::cerr << "[RadixSortBench] Some configurations failed." << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+# Compiles shader variants with glslc at build time and embeds the SPIR-V as constexpr arrays (see engine/core/EmbeddedShader.h).
+#
+# embed_shaders(<target> NAME <Name> SOURCE_DIR <dir> VARIANTS <file>[:<define>,<define>...] ... [INCLUDES <file> ...])
+#
+# generates <binary dir>/include/shaders/<name in lower case>.h with the table
+#     inline constexpr std::span<const engine::EmbeddedShader> <Name>
+# which is passed to the Shader constructor. Without glslc or with ENGINE_EMBED_SHADERS=OFF the table is empty and the
+# shaders are compiled at runtime. INCLUDES are the files (in SOURCE_DIR) included by the shaders, every variant is recompiled when
+# one of them changes.
+
+option(ENGINE_EMBED_SHADERS "Compile the shaders at build time and embed the SPIR-V into the libraries." ON)
+set(ENGINE_EMBEDDED_SUBGROUP_SIZES "16;32;64;128" CACHE STRING "SUBGROUP_SIZE variants of the embedded shaders, other devices compile at runtime.")
+
+if (ENGINE_EMBED_SHADERS)
+    find_program(GLSLC_EXECUTABLE glslc HINTS ${Vulkan_GLSLC_EXECUTABLE} "$ENV{VULKAN_SDK}/bin")
+    if (NOT GLSLC_EXECUTABLE)
+        message(WARNING "glslc not found, the shaders are compiled at runtime.")
+    endif ()
+endif ()
+
+set(ENGINE_EMBED_SPIRV_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/EmbedSpirv.cmake)
+
+function(embed_shaders TARGET)
+    cmake_parse_arguments(ARG "" "NAME;SOURCE_DIR" "VARIANTS;INCLUDES" ${ARGN})
+    set(OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/include/shaders)
+    string(TOLOWER ${ARG_NAME} HEADER_NAME)
+    set(HEADER ${OUTPUT_DIR}/${HEADER_NAME}.h)
+    set(CONFIG ${CMAKE_CURRENT_BINARY_DIR}/${ARG_NAME}.embed.cmake)
+
+    set(SPIRV_FILES)
+    set(ENTRIES)
+    list(TRANSFORM ARG_INCLUDES PREPEND ${ARG_SOURCE_DIR}/)
+    if (ENGINE_EMBED_SHADERS AND GLSLC_EXECUTABLE)
+        foreach (VARIANT IN LISTS ARG_VARIANTS)
+            string(FIND "${VARIANT}" ":" SEPARATOR)
+            if (SEPARATOR EQUAL -1)
+                set(FILE_NAME ${VARIANT})
+                set(DEFINES)
+            else ()
+                string(SUBSTRING "${VARIANT}" 0 ${SEPARATOR} FILE_NAME)
+                math(EXPR SEPARATOR "${SEPARATOR} + 1")
+                string(SUBSTRING "${VARIANT}" ${SEPARATOR} -1 DEFINES)
+                string(REPLACE "," ";" DEFINES "${DEFINES}")
+                list(SORT DEFINES) # same order as EmbeddedShader::getDefinesKey
+            endif ()
+
+            set(SPIRV_NAME ${FILE_NAME})
+            set(DEFINE_ARGS)
+            foreach (DEFINE IN LISTS DEFINES)
+                string(APPEND SPIRV_NAME ".${DEFINE}")
+                list(APPEND DEFINE_ARGS -D${DEFINE})
+            endforeach ()
+            string(REPLACE "=" "_" SPIRV_NAME "${SPIRV_NAME}")
+            set(SPIRV_FILE ${CMAKE_CURRENT_BINARY_DIR}/spirv/${SPIRV_NAME}.spv)
+
+            add_custom_command(
+                    OUTPUT ${SPIRV_FILE}
+                    COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_CURRENT_BINARY_DIR}/spirv
+                    COMMAND ${GLSLC_EXECUTABLE} --target-spv=spv1.5 ${DEFINE_ARGS} ${ARG_SOURCE_DIR}/${FILE_NAME} -o ${SPIRV_FILE}
+                    DEPENDS ${ARG_SOURCE_DIR}/${FILE_NAME} ${ARG_INCLUDES}
+                    COMMENT "Compiling ${FILE_NAME} ${DEFINES}"
+                    VERBATIM)
+
+            string(REPLACE ";" "," DEFINES_KEY "${DEFINES}")
+            list(APPEND SPIRV_FILES ${SPIRV_FILE})
+            list(APPEND ENTRIES "${FILE_NAME}|${DEFINES_KEY}|${SPIRV_FILE}")
+        endforeach ()
+    endif ()
+
+    # the variants are passed to the script in a file, the lists would have to be escaped on the command line
+    file(GENERATE OUTPUT ${CONFIG} CONTENT "set(NAME \"${ARG_NAME}\")\nset(HEADER \"${HEADER}\")\nset(ENTRIES \"${ENTRIES}\")\n")
+    add_custom_command(
+            OUTPUT ${HEADER}
+            COMMAND ${CMAKE_COMMAND} -DCONFIG=${CONFIG} -P ${ENGINE_EMBED_SPIRV_SCRIPT}
+            DEPENDS ${SPIRV_FILES} ${CONFIG} ${ENGINE_EMBED_SPIRV_SCRIPT}
+            COMMENT "Embedding the SPIR-V of ${ARG_NAME}"
+            VERBATIM)
+    target_sources(${TARGET} PRIVATE ${HEADER})
+endfunction()
@@ -0,0 +1,35 @@
+# Writes the SPIR-V files of a config generated by embed_shaders (EmbedShaders.cmake) into a header of constexpr arrays.
+# cmake -DCONFIG=<file> -P EmbedSpirv.cmake
+
+cmake_minimum_required(VERSION 3.18)
+
+include(${CONFIG})
+
+set(ARRAYS "")
+set(TABLE "")
+set(INDEX 0)
+foreach (ENTRY IN LISTS ENTRIES)
+    # <file>|<defines key>|<spv>, the defines key may be empty
+    string(REGEX MATCH "^([^|]*)\\|([^|]*)\\|(.*)$" ENTRY "${ENTRY}")
+    set(FILE_NAME ${CMAKE_MATCH_1})
+    set(DEFINES_KEY "${CMAKE_MATCH_2}")
+    set(SPIRV_FILE ${CMAKE_MATCH_3})
+
+    # SPIR-V is a little endian stream of 32-bit words
+    file(READ ${SPIRV_FILE} HEX HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1U," WORDS "${HEX}")
+    string(STRIP "${FILE_NAME} ${DEFINES_KEY}" DESCRIPTION)
+    string(APPEND ARRAYS "    // ${DESCRIPTION}\n    inline constexpr uint32_t ${NAME}_${INDEX}[] = {${WORDS}};\n")
+    string(APPEND TABLE "        {\"${FILE_NAME}\", \"${DEFINES_KEY}\", ${NAME}_${INDEX}},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach ()
+
+set(CONTENT "// generated by cmake/EmbedSpirv.cmake, do not edit\n#pragma once\n\n#include \"engine/core/EmbeddedShader.h\"\n\nnamespace engine::embedded {\n")
+if (INDEX GREATER 0)
+    string(APPEND CONTENT "${ARRAYS}\n    inline constexpr EmbeddedShader ${NAME}_TABLE[] = {\n${TABLE}    };\n} // namespace engine::embedded\n\n")
+    string(APPEND CONTENT "namespace engine {\n    inline constexpr std::span<const EmbeddedShader> ${NAME}{embedded::${NAME}_TABLE};\n} // namespace engine\n")
+else ()
+    # nothing embedded, compiled at runtime
+    string(APPEND CONTENT "} // namespace engine::embedded\n\nnamespace engine {\n    inline constexpr std::span<const EmbeddedShader> ${NAME}{};\n} // namespace engine\n")
+endif ()
+file(WRITE ${HEADER} "${CONTENT}")
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bit>
 #include <cstring>
 #include <memory>
 #include <optional>
@@ -14,9 +15,10 @@ namespace engine {
     class Buffer {
     public:
         struct BufferSettings {
-            uint32_t m_sizeBytes;
+            VkDeviceSize m_sizeBytes;
             VkBufferUsageFlags m_bufferUsages;
             VkMemoryPropertyFlags m_memoryProperties;
+            VkMemoryPropertyFlags m_preferredMemoryProperties = 0; // used if a memory type with m_memoryProperties has them (e.g. HOST_VISIBLE for device local memory on unified memory)
             std::optional<VkMemoryAllocateFlagBits> m_memoryAllocateFlagBits{};
 
             std::string m_name = "undefined";
@@ -42,9 +44,40 @@ namespace engine {
             }
             m_buffer = nullptr;
             m_bufferMemory = nullptr;
+            m_hostPointer = nullptr;
         }
 
-        static std::shared_ptr<Buffer> fillDeviceWithStagingBuffer(GPUContext *gpuContext, const BufferSettings& settings, void *data) { // upload
+        // imports settings.m_sizeBytes bytes of host memory at hostPointer as buffer memory (VK_EXT_external_memory_host), no copy is made
+        // the host memory has to stay valid until the buffer is released, settings.m_memoryProperties are required from the imported memory type
+        // returns nullptr if the device cannot import the memory (extension not supported, pointer not suitably aligned, no matching memory type)
+        static std::shared_ptr<Buffer> importHostMemory(GPUContext *gpuContext, const BufferSettings &settings, void *hostPointer) {
+            if (gpuContext->getMinImportedHostPointerAlignment() == 0 || hostPointer == nullptr || settings.m_sizeBytes == 0) {
+                return nullptr;
+            }
+            auto buffer = std::shared_ptr<Buffer>(new Buffer(gpuContext, settings, hostPointer));
+            if (!buffer->m_bufferMemory) {
+                return nullptr;
+            }
+            return buffer;
+        }
+
+        static std::shared_ptr<Buffer> fillDeviceWithStagingBuffer(GPUContext *gpuContext, const BufferSettings& settings, const void *data) { // upload
+            auto buffer = std::make_shared<Buffer>(gpuContext, settings);
+
+            // mapped device local memory is written in place
+            if (buffer->isHostMappable()) {
+                buffer->updateHostMemory(settings.m_sizeBytes, data);
+                return buffer;
+            }
+
+            // the host memory is the transfer source itself if it can be imported (transfer source only, the memory is never written)
+            auto importedBuffer = importHostMemory(gpuContext, {settings.m_sizeBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT}, const_cast<void *>(data));
+            if (importedBuffer) {
+                copyBuffer(gpuContext, importedBuffer->m_buffer, buffer->m_buffer, settings.m_sizeBytes);
+                importedBuffer->release();
+                return buffer;
+            }
+
             Buffer stagingBuffer(gpuContext, {settings.m_sizeBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT});
 
             void *stagingMemory;
@@ -52,8 +85,6 @@ namespace engine {
             memcpy(stagingMemory, data, settings.m_sizeBytes);
             vkUnmapMemory(gpuContext->m_device, stagingBuffer.m_bufferMemory);
 
-            auto buffer = std::make_shared<Buffer>(gpuContext, settings);
-
             copyBuffer(gpuContext, stagingBuffer.m_buffer, buffer->m_buffer, settings.m_sizeBytes); // copy contents from staging buffer to high performance memory on GPU, which cannot be accessed directly by the CPU (therefore the staging buffer)
 
             stagingBuffer.release();
@@ -61,7 +92,27 @@ namespace engine {
             return buffer;
         }
 
+        // device local buffer with usages | TRANSFER_SRC | TRANSFER_DST (uploads, downloads and fills), filled with sizeBytes bytes of data if data is not nullptr
+        static std::shared_ptr<Buffer> createDeviceLocal(GPUContext *gpuContext, VkDeviceSize sizeBytes, VkBufferUsageFlags usages, const std::string &name, const void *data = nullptr, std::optional<VkMemoryAllocateFlagBits> memoryAllocateFlagBits = {}) {
+            const BufferSettings settings{.m_sizeBytes = sizeBytes, .m_bufferUsages = usages | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = memoryAllocateFlagBits, .m_name = name};
+            return data != nullptr ? fillDeviceWithStagingBuffer(gpuContext, settings, data) : std::make_shared<Buffer>(gpuContext, settings);
+        }
+
+        // buffers allocated for in place access (m_preferredMemoryProperties HOST_VISIBLE) are read directly if they got mapped memory,
+        // the submission writing them has to end with getHostReadBarrier() (a barrier on another queue does not cover its writes)
         void downloadWithStagingBuffer(void *data) {
+            if (isHostMappable() && (m_bufferSettings.m_preferredMemoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+                download(data);
+                return;
+            }
+            // the host memory is the transfer destination itself if it can be imported
+            auto importedBuffer = importHostMemory(m_gpuContext, {m_bufferSettings.m_sizeBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT}, data);
+            if (importedBuffer) {
+                copyBuffer(m_gpuContext, m_buffer, importedBuffer->m_buffer, m_bufferSettings.m_sizeBytes);
+                importedBuffer->release();
+                return;
+            }
+
             Buffer stagingBuffer(m_gpuContext, {m_bufferSettings.m_sizeBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT});
 
             copyBuffer(m_gpuContext, m_buffer, stagingBuffer.m_buffer, m_bufferSettings.m_sizeBytes); // copy contents from staging buffer to high performance memory on GPU, which cannot be accessed directly by the CPU (therefore the staging buffer)
@@ -78,7 +129,7 @@ namespace engine {
             vkUnmapMemory(m_gpuContext->m_device, m_bufferMemory);
         }
 
-        void updateHostMemory(uint32_t sizeBytes, void *data) {
+        void updateHostMemory(VkDeviceSize sizeBytes, const void *data) {
             void *memory;
             vkMapMemory(m_gpuContext->m_device, m_bufferMemory, 0, sizeBytes, 0, &memory); // memory-mapped I/O
             memcpy(memory, data, sizeBytes);
@@ -100,10 +151,31 @@ namespace engine {
             return m_buffer;
         }
 
-        [[nodiscard]] uint32_t getSizeBytes() const {
+        // makes the writes of srcAccessMask to the whole buffer visible to the host, recorded at the end of the producing submission
+        // (e.g. a release barrier of MultiRadixSortPass::sort) before the host reads mapped or imported memory
+        [[nodiscard]] VkBufferMemoryBarrier getHostReadBarrier(VkAccessFlags srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT) const {
+            return {.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, .srcAccessMask = srcAccessMask, .dstAccessMask = VK_ACCESS_HOST_READ_BIT, .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .buffer = m_buffer, .offset = 0, .size = VK_WHOLE_SIZE};
+        }
+
+        [[nodiscard]] VkDeviceSize getSizeBytes() const {
             return m_bufferSettings.m_sizeBytes;
         }
 
+        // property flags of the memory type the buffer memory was allocated from
+        [[nodiscard]] VkMemoryPropertyFlags getMemoryPropertyFlags() const {
+            return m_memoryPropertyFlags;
+        }
+
+        // HOST_VISIBLE | HOST_COHERENT memory that can be mapped without flushes / invalidations
+        [[nodiscard]] bool isHostMappable() const {
+            const VkMemoryPropertyFlags mappable = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            return (m_memoryPropertyFlags & mappable) == mappable && !isImportedHostMemory();
+        }
+
+        [[nodiscard]] bool isImportedHostMemory() const {
+            return m_hostPointer != nullptr;
+        }
+
         VkDeviceAddress getDeviceAddress() {
             VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .buffer = m_buffer};
             return vkGetBufferDeviceAddress(m_gpuContext->m_device, &addressInfo);
@@ -117,6 +189,13 @@ namespace engine {
 
         BufferSettings m_bufferSettings;
 
+        VkMemoryPropertyFlags m_memoryPropertyFlags = 0;
+        void *m_hostPointer = nullptr; // imported host memory, owned by the caller
+
+        Buffer(GPUContext *gpuContext, BufferSettings settings, void *hostPointer) : m_gpuContext(gpuContext), m_bufferSettings(std::move(settings)) {
+            importBuffer(hostPointer);
+        }
+
         void createBuffer() {
             VkBufferCreateInfo bufferInfo{};
             bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -134,7 +213,8 @@ namespace engine {
             VkMemoryAllocateInfo allocInfo{};
             allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
             allocInfo.allocationSize = memRequirements.size;
-            allocInfo.memoryTypeIndex = findMemoryType(m_gpuContext->m_physicalDevice, memRequirements.memoryTypeBits, m_bufferSettings.m_memoryProperties);
+            allocInfo.memoryTypeIndex = findMemoryType(m_gpuContext->m_physicalDevice, memRequirements.memoryTypeBits, m_bufferSettings.m_memoryProperties, m_bufferSettings.m_preferredMemoryProperties, memRequirements.size);
+            m_memoryPropertyFlags = getMemoryTypePropertyFlags(m_gpuContext->m_physicalDevice, allocInfo.memoryTypeIndex);
             VkMemoryAllocateFlagsInfo *pMemoryAllocateFlagsInfo = nullptr;
             VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
             if (m_bufferSettings.m_memoryAllocateFlagBits.has_value()) {
@@ -151,17 +231,103 @@ namespace engine {
             vkBindBufferMemory(m_gpuContext->m_device, m_buffer, m_bufferMemory, 0);
         }
 
-        static uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+        // leaves the buffer empty (m_bufferMemory == nullptr) if the host memory cannot be imported
+        void importBuffer(void *hostPointer) {
+            VkDevice device = m_gpuContext->m_device;
+            auto vkGetMemoryHostPointerPropertiesEXT = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(vkGetDeviceProcAddr(device, "vkGetMemoryHostPointerPropertiesEXT"));
+            if (!vkGetMemoryHostPointerPropertiesEXT) {
+                return;
+            }
+
+            // import the whole aligned pages around the data, the buffer is bound at the offset of the data
+            const VkDeviceSize alignment = m_gpuContext->getMinImportedHostPointerAlignment();
+            const auto address = reinterpret_cast<uintptr_t>(hostPointer);
+            void *alignedPointer = reinterpret_cast<void *>(address - address % alignment);
+            const VkDeviceSize offset = address % alignment;
+            const VkDeviceSize importSizeBytes = (offset + m_bufferSettings.m_sizeBytes + alignment - 1) / alignment * alignment;
+
+            VkMemoryHostPointerPropertiesEXT hostPointerProperties{.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT};
+            if (vkGetMemoryHostPointerPropertiesEXT(device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, alignedPointer, &hostPointerProperties) != VK_SUCCESS) {
+                return;
+            }
+
+            VkExternalMemoryBufferCreateInfo externalMemoryBufferInfo{.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO, .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT};
+            VkBufferCreateInfo bufferInfo{};
+            bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.pNext = &externalMemoryBufferInfo;
+            bufferInfo.size = m_bufferSettings.m_sizeBytes;
+            bufferInfo.usage = m_bufferSettings.m_bufferUsages;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if (vkCreateBuffer(device, &bufferInfo, nullptr, &m_buffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create buffer!");
+            }
+
+            VkMemoryRequirements memRequirements;
+            vkGetBufferMemoryRequirements(device, m_buffer, &memRequirements);
+            const std::optional<uint32_t> memoryTypeIndex = tryFindMemoryType(m_gpuContext->m_physicalDevice, memRequirements.memoryTypeBits & hostPointerProperties.memoryTypeBits, m_bufferSettings.m_memoryProperties);
+            if (offset % memRequirements.alignment != 0 || offset + memRequirements.size > importSizeBytes || !memoryTypeIndex.has_value()) {
+                release();
+                return;
+            }
+
+            VkImportMemoryHostPointerInfoEXT importInfo{.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT, .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, .pHostPointer = alignedPointer};
+            VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
+            if (m_bufferSettings.m_memoryAllocateFlagBits.has_value()) {
+                memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+                memoryAllocateFlagsInfo.flags = m_bufferSettings.m_memoryAllocateFlagBits.value();
+                importInfo.pNext = &memoryAllocateFlagsInfo;
+            }
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.pNext = &importInfo;
+            allocInfo.allocationSize = importSizeBytes;
+            allocInfo.memoryTypeIndex = memoryTypeIndex.value();
+            if (vkAllocateMemory(device, &allocInfo, nullptr, &m_bufferMemory) != VK_SUCCESS) {
+                m_bufferMemory = nullptr;
+                release();
+                return;
+            }
+
+            vkBindBufferMemory(device, m_buffer, m_bufferMemory, offset);
+            m_memoryPropertyFlags = getMemoryTypePropertyFlags(m_gpuContext->m_physicalDevice, memoryTypeIndex.value());
+            m_hostPointer = hostPointer;
+        }
+
+        // memory type with all required properties and the most preferred properties, types whose heap is smaller than sizeBytes are only used if there is no other
+        static std::optional<uint32_t> tryFindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties = 0, VkDeviceSize sizeBytes = 0) {
             VkPhysicalDeviceMemoryProperties memProperties;
             vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
 
+            std::optional<uint32_t> memoryTypeIndex;
+            int bestScore = -1;
             for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-                if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                    return i;
+                const VkMemoryPropertyFlags flags = memProperties.memoryTypes[i].propertyFlags;
+                if (!(typeFilter & (1 << i)) || (flags & properties) != properties) {
+                    continue;
                 }
+                const bool fitsHeap = memProperties.memoryHeaps[memProperties.memoryTypes[i].heapIndex].size >= sizeBytes;
+                const int score = (fitsHeap ? 64 : 0) + std::popcount(flags & preferredProperties); // the first type wins ties (driver order)
+                if (score > bestScore) {
+                    bestScore = score;
+                    memoryTypeIndex = i;
+                }
+            }
+
+            return memoryTypeIndex;
+        }
+
+        static uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties = 0, VkDeviceSize sizeBytes = 0) {
+            const std::optional<uint32_t> memoryTypeIndex = tryFindMemoryType(physicalDevice, typeFilter, properties, preferredProperties, sizeBytes);
+            if (!memoryTypeIndex.has_value()) {
+                throw std::runtime_error("Failed to find suitable memory type!");
             }
+            return memoryTypeIndex.value();
+        }
 
-            throw std::runtime_error("Failed to find suitable memory type!");
+        static VkMemoryPropertyFlags getMemoryTypePropertyFlags(VkPhysicalDevice physicalDevice, uint32_t memoryTypeIndex) {
+            VkPhysicalDeviceMemoryProperties memProperties;
+            vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+            return memProperties.memoryTypes[memoryTypeIndex].propertyFlags;
         }
 
         static void copyBuffer(GPUContext *gpuContext, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+    /**
+     * SPIR-V of a shader variant compiled at build time (embed_shaders in cmake/EmbedShaders.cmake), the tables are generated into
+     * include/shaders/<name>.h of the library as constexpr arrays and passed to the Shader constructor.
+     */
+    struct EmbeddedShader {
+        const char *m_fileName; // e.g. "multi_radixsort.comp"
+        const char *m_defines;  // sorted and comma separated, e.g. "KEY_VALUE,SUBGROUP_SIZE=32"
+        std::span<const uint32_t> m_code;
+
+        // the key of the defines in m_defines
+        static std::string getDefinesKey(std::vector<std::string> defines) {
+            std::sort(defines.begin(), defines.end());
+            std::string key;
+            for (const auto &define: defines) {
+                key += (key.empty() ? "" : ",") + define;
+            }
+            return key;
+        }
+
+        static const EmbeddedShader *find(std::span<const EmbeddedShader> embeddedShaders, std::string_view fileName, const std::vector<std::string> &defines) {
+            const std::string key = getDefinesKey(defines);
+            for (const auto &embeddedShader: embeddedShaders) {
+                if (fileName == embeddedShader.m_fileName && key == embeddedShader.m_defines) {
+                    return &embeddedShader;
+                }
+            }
+            return nullptr;
+        }
+    };
+} // namespace engine
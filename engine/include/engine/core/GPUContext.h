@@ -1,10 +1,17 @@
 #pragma once
 
 #include <cstring>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <regex>
+#include <string>
 #include <set>
+#include <thread>
 #include <stdexcept>
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -14,8 +21,48 @@
 namespace engine {
     class GPUContext {
     public:
+        // a suitable physical device (Vulkan 1.3 and the required queue families)
+        struct DeviceInfo {
+            uint32_t m_index = 0; // in vkEnumeratePhysicalDevices
+            std::string m_name;
+            std::string m_uuid; // 32 hex digits of VkPhysicalDeviceIDProperties::deviceUUID
+            VkPhysicalDeviceType m_type = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+            uint32_t m_subgroupSize = 0;
+            VkDeviceSize m_deviceLocalMemory = 0; // largest device local heap
+            double m_score = 0.0;                 // of DeviceSelection::Policy::BEST
+        };
+
+        // which device init() uses, never asks on stdin
+        struct DeviceSelection {
+            enum class Policy {
+                BEST,  // highest score: discrete > integrated > virtual > cpu, then device local memory, then subgroup size
+                INDEX, // m_index in vkEnumeratePhysicalDevices
+                UUID,  // m_uuid
+                NAME,  // first device whose name matches m_nameRegex (ECMAScript, case insensitive)
+            };
+
+            Policy m_policy = Policy::BEST;
+            uint32_t m_index = 0;
+            std::string m_uuid;
+            std::string m_nameRegex;
+
+            // "best", an index, a uuid (32 hex digits, dashes are ignored) or a name regex
+            static DeviceSelection parse(const std::string &selection);
+        };
+
         explicit GPUContext(uint32_t requiredQueueFamilies);
 
+        // set before init, defaults to the environment variable ENGINE_DEVICE (see DeviceSelection::parse) or the best device
+        DeviceSelection m_deviceSelection;
+
+        // suitable devices of the system (temporary instance), e.g. to create one context per device with Policy::INDEX
+        static std::vector<DeviceInfo> enumerateDevices(uint32_t requiredQueueFamilies);
+
+        // the selected device (after init)
+        [[nodiscard]] const DeviceInfo &getDeviceInfo() const {
+            return m_deviceInfo;
+        }
+
         virtual void init();
 
         virtual void shutdown();
@@ -25,23 +72,30 @@ namespace engine {
         VkDevice m_device{};
         std::shared_ptr<Queues> m_queues;
 
-        uint32_t m_activeIndex = 0;
-
         [[nodiscard]] uint32_t getMultiBufferedCount() const {
             return MAX_FRAMES_IN_FLIGHT;
         }
 
-        [[nodiscard]] uint32_t getActiveIndex() const {
-            return m_activeIndex;
-        }
-
         VkCommandPool m_commandPool{}; // TODO(Mirco): make this a transfer command pool only
 
+        // shared by the pipelines of all passes, loaded from m_pipelineCachePath on init and written back on shutdown
+        VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+
+        // file of the pipeline cache, set before init (empty: the cache is not persisted)
+        // defaults to ENGINE_PIPELINE_CACHE_PATH or vkradixsort_pipeline_cache_<device uuid>_<pipeline cache uuid>.bin in the temp directory
+        std::string m_pipelineCachePath;
+
+        // writes the pipeline cache to m_pipelineCachePath (also called by shutdown), e.g. after the passes of a long running process are created
+        void savePipelineCache();
+
+        // records and submits the commands to the transfer queue and waits for them, may be called from several threads at the same time
         void executeCommands(const std::function<void(VkCommandBuffer)> &recordCommands) {
+            const VkCommandPool commandPool = getThreadCommandPool();
+
             VkCommandBufferAllocateInfo allocInfo{};
             allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
             allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandPool = m_commandPool;
+            allocInfo.commandPool = commandPool;
             allocInfo.commandBufferCount = 1;
 
             VkCommandBuffer commandBuffer;
@@ -62,16 +116,49 @@ namespace engine {
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers = &commandBuffer;
 
-            vkQueueSubmit(m_queues->getQueue(Queues::TRANSFER), 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(m_queues->getQueue(Queues::TRANSFER));
+            // a fence instead of waiting for the queue, the submissions of other threads are not waited for
+            VkFenceCreateInfo fenceInfo{.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+            VkFence fence;
+            if (vkCreateFence(m_device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create fence!");
+            }
+            m_queues->submit(Queues::TRANSFER, 1, &submitInfo, fence);
+            vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+            vkDestroyFence(m_device, fence, nullptr);
+
+            vkFreeCommandBuffers(m_device, commandPool, 1, &commandBuffer);
+        }
 
-            vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+        [[nodiscard]] bool isDeviceExtensionEnabled(const std::string &extension) const {
+            return m_enabledDeviceExtensions.contains(extension);
         }
 
-        void incrementActiveIndex() {
-            m_activeIndex = (m_activeIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+        // bytes of the largest device local heap still available to this process (VK_EXT_memory_budget if supported, otherwise the heap size)
+        [[nodiscard]] VkDeviceSize getDeviceLocalMemoryBudget() const;
+
+        // alignment of host pointers imported with VK_EXT_external_memory_host, 0 if the extension is not supported
+        [[nodiscard]] VkDeviceSize getMinImportedHostPointerAlignment() const;
+
+        // size of the largest heap with DEVICE_LOCAL | HOST_VISIBLE | HOST_COHERENT memory, 0 if there is none
+        [[nodiscard]] VkDeviceSize getHostVisibleDeviceLocalHeapSize() const {
+            return m_hostVisibleDeviceLocalHeapSize;
+        }
+
+        // the whole device local memory is host visible (integrated gpus, cpu implementations, resizable BAR),
+        // buffers can be allocated as mapped device local memory instead of going through staging copies
+        [[nodiscard]] bool isUnifiedMemory() const {
+            return m_unifiedMemory;
         }
 
+        // invocations per subgroup of the physical device (SUBGROUP_SIZE of the shaders)
+        [[nodiscard]] uint32_t getSubgroupSize() const;
+
+        // number of streaming multiprocessors / compute units (VK_NV_shader_sm_builtins, VK_AMD_shader_core_properties), 0 if unknown
+        [[nodiscard]] uint32_t getComputeUnitCount() const;
+
+        // 64-bit integers in shaders, 64-bit subgroup operations and buffer device addresses (enabled with the device if supported)
+        [[nodiscard]] bool supportsLargeBuffers() const;
+
     protected:
         VkInstance m_instance{};
         VkDebugUtilsMessengerEXT m_debugMessenger{};
@@ -80,6 +167,9 @@ namespace engine {
 
         virtual std::vector<const char *> getDeviceExtensions();
 
+        // enabled only if supported by the physical device
+        virtual std::vector<const char *> getOptionalDeviceExtensions();
+
     private:
 #ifdef NDEBUG
         const bool enableValidationLayers = false;
@@ -102,11 +192,52 @@ namespace engine {
         static void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks *pAllocator);
         void pickPhysicalDevice();
 
+        DeviceInfo m_deviceInfo;
+
+        // suitable devices of the instance and their handles
+        static std::vector<std::pair<DeviceInfo, VkPhysicalDevice>> querySuitableDevices(VkInstance instance, const Queues &queues);
+
+        void detectMemoryHeaps();
+
         void createLogicalDevice();
 
+        std::set<std::string> m_enabledDeviceExtensions;
+
+        VkDeviceSize m_hostVisibleDeviceLocalHeapSize = 0;
+        bool m_unifiedMemory = false;
+
         void createCommandPool();
         void createCommandBuffers();
 
+        // command pools are externally synchronized, every thread records executeCommands into its own pool
+        // the pool is owned by a thread_local of the calling thread and destroyed when the thread exits, release destroys the remaining ones
+        struct ThreadCommandPools {
+            std::mutex m_mutex;
+            VkDevice m_device = VK_NULL_HANDLE; // VK_NULL_HANDLE after release, the thread owners then only drop their pools
+            std::set<VkCommandPool> m_commandPools;
+        };
+        std::shared_ptr<ThreadCommandPools> m_threadCommandPools;
+
+        VkCommandPool getThreadCommandPool();
+
+        // header of the pipeline cache file, the data is only used on the same device with the same driver
+        struct PipelineCacheFileHeader {
+            uint32_t m_magic;
+            uint32_t m_vendorID;
+            uint32_t m_deviceID;
+            uint32_t m_driverVersion;
+            uint8_t m_deviceUUID[VK_UUID_SIZE];
+            uint8_t m_pipelineCacheUUID[VK_UUID_SIZE];
+            uint64_t m_dataSize;
+            uint64_t m_dataHash; // truncated or corrupted files are not passed to the driver
+        };
+
+        static const uint32_t PIPELINE_CACHE_MAGIC = 0x43505256; // "VRPC"
+
+        void createPipelineCache();
+        [[nodiscard]] PipelineCacheFileHeader getPipelineCacheFileHeader() const;
+        static uint64_t hashPipelineCacheData(const std::vector<char> &data);
+
         const uint32_t MAX_FRAMES_IN_FLIGHT = 2;
     };
 } // namespace raven
\ No newline at end of file
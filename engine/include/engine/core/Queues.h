@@ -1,7 +1,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <vector>
 #include <set>
@@ -14,28 +16,42 @@ namespace engine {
             GRAPHICS_FAMILY = 0x00000001,
             COMPUTE_FAMILY = 0x00000002,
             TRANSFER_FAMILY = 0x00000004,
+            ASYNC_TRANSFER_FAMILY = 0x00000008, // transfer-only family if available (copies overlap with compute), otherwise the compute family
         };
 
         enum Queue {
             GRAPHICS = 0,
             COMPUTE = 1,
             TRANSFER = 2,
+            ASYNC_TRANSFER = 3,
         };
 
+        // compute queue selection of acquireComputeQueue
+        enum Priority {
+            PRIORITY_NORMAL = 0, // round robin over the compute queues (except the first one if there are several)
+            PRIORITY_HIGH = 1,   // the first compute queue, created with the highest priority
+        };
+
+        static constexpr uint32_t MAX_COMPUTE_QUEUES = 8;
+
         explicit Queues(uint32_t requiredQueueFamilies) : m_requiredQueueFamilies(requiredQueueFamilies){};
 
         struct QueueFamilyIndices {
             std::optional<uint32_t> graphicsFamily;
             std::optional<uint32_t> computeFamily;
             std::optional<uint32_t> transferFamily;
+            std::optional<uint32_t> asyncTransferFamily;
+            uint32_t computeQueueCount = 1; // queues created in the compute family, at most MAX_COMPUTE_QUEUES
 
             [[nodiscard]] bool isComplete(uint32_t requiredQueueFamilies) const {
                 uint32_t graphics = GRAPHICS_FAMILY & requiredQueueFamilies;
                 uint32_t compute = COMPUTE_FAMILY & requiredQueueFamilies;
                 uint32_t transfer = TRANSFER_FAMILY & requiredQueueFamilies;
+                uint32_t asyncTransfer = ASYNC_TRANSFER_FAMILY & requiredQueueFamilies;
                 return (!graphics || graphicsFamily.has_value())
                        && (!compute || computeFamily.has_value())
-                       && (!transfer || transferFamily.has_value());
+                       && (!transfer || transferFamily.has_value())
+                       && (!asyncTransfer || asyncTransferFamily.has_value());
             }
 
             void generateQueueCreateInfos(std::vector<VkDeviceQueueCreateInfo> *queueCreateInfos, const float *queuePriorities) {
@@ -49,13 +65,16 @@ namespace engine {
                 if (transferFamily.has_value()) {
                     uniqueQueueFamilies.emplace(transferFamily.value());
                 }
+                if (asyncTransferFamily.has_value()) {
+                    uniqueQueueFamilies.emplace(asyncTransferFamily.value());
+                }
 
                 for (uint32_t queueFamily: uniqueQueueFamilies) { // queue create infos for all required queues
                     VkDeviceQueueCreateInfo queueCreateInfo{};
                     queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
                     queueCreateInfo.queueFamilyIndex = queueFamily;
-                    queueCreateInfo.queueCount = 1;
-                    queueCreateInfo.pQueuePriorities = queuePriorities;
+                    queueCreateInfo.queueCount = computeFamily.has_value() && queueFamily == computeFamily.value() ? computeQueueCount : 1;
+                    queueCreateInfo.pQueuePriorities = queuePriorities; // at least MAX_COMPUTE_QUEUES
                     queueCreateInfos->push_back(queueCreateInfo);
                 }
             }
@@ -69,9 +88,41 @@ namespace engine {
 
         VkQueue getQueue(Queue queue);
 
+        // family of the queue (after createQueues)
+        [[nodiscard]] uint32_t getQueueFamilyIndex(Queue queue) const {
+            return m_queueFamilyIndices[queue];
+        }
+
+        // vkQueueSubmit / vkQueueWaitIdle serialized per VkQueue (queues are externally synchronized), thread safe
+        VkResult submit(Queue queue, uint32_t submitCount, const VkSubmitInfo *submits, VkFence fence);
+
+        VkResult waitIdle(Queue queue);
+
+        // all queues of the compute family, compute queue 0 is the COMPUTE queue
+        [[nodiscard]] uint32_t getComputeQueueCount() const {
+            return static_cast<uint32_t>(m_computeQueues.size());
+        }
+
+        // index of the compute queue for a new user (e.g. a pass), independent sorts on different queues overlap on the GPU, thread safe
+        uint32_t acquireComputeQueue(Priority priority = PRIORITY_NORMAL);
+
+        // submit / waitIdle of a compute queue by index, serialized with the other entries of the same VkQueue
+        VkResult submitCompute(uint32_t computeQueueIndex, uint32_t submitCount, const VkSubmitInfo *submits, VkFence fence);
+
+        VkResult waitIdleCompute(uint32_t computeQueueIndex);
+
+        [[nodiscard]] uint32_t getRequiredQueueFamilies() const {
+            return m_requiredQueueFamilies;
+        }
+
     private:
         uint32_t m_requiredQueueFamilies;
-        std::array<VkQueue, 3> m_queues{}; // destroyed implicitly with the device
+        std::array<VkQueue, 4> m_queues{}; // destroyed implicitly with the device
+        std::array<uint32_t, 4> m_queueFamilyIndices{};
+        std::array<std::shared_ptr<std::mutex>, 4> m_queueMutexes; // shared by the entries with the same VkQueue
+        std::vector<VkQueue> m_computeQueues;
+        std::vector<std::shared_ptr<std::mutex>> m_computeQueueMutexes;
+        std::atomic<uint32_t> m_nextComputeQueue = 0;
 
         [[nodiscard]] bool isFamilyRequired(QueueFamilies queueFamily) const;
     };
@@ -1,15 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "EmbeddedShader.h"
 #include "SPIRV-Reflect/spirv_reflect.h"
 #include "Uniform.h"
 
@@ -30,19 +35,37 @@ namespace engine {
             }
         };
 
-        Shader(GPUContext *gpuContext, const std::string &inputPath, const std::string &fileName) : m_gpuContext(gpuContext) {
-            std::cout << "[Shader] Compiling " << inputPath << "/" << fileName << std::endl;
-
-            std::stringstream outputPath;
-            outputPath << std::filesystem::canonical("/proc/self/exe").remove_filename().c_str() << "resources/shaders";
-            compileShader(inputPath, outputPath.str(), fileName);
-            std::vector<char> code = readFile(outputPath.str() + "/" + fileName + ".spv");
+        // defines are passed to glslc (-D), each set of defines is compiled into its own .spv file
+        // embeddedShaders: variants compiled at build time, the shader is only compiled at runtime if the variant is not embedded or m_runtimeCompilation is set
+        Shader(GPUContext *gpuContext, const std::string &inputPath, const std::string &fileName, const std::vector<std::string> &defines = {}, std::span<const EmbeddedShader> embeddedShaders = {}) : m_gpuContext(gpuContext) {
+            std::vector<char> code;
+            const EmbeddedShader *embeddedShader = m_runtimeCompilation ? nullptr : EmbeddedShader::find(embeddedShaders, fileName, defines);
+            if (embeddedShader != nullptr) {
+                code.resize(embeddedShader->m_code.size_bytes());
+                std::memcpy(code.data(), embeddedShader->m_code.data(), code.size());
+            } else {
+                std::lock_guard<std::mutex> lock(m_compileMutex); // passes created from several threads compile to the same .spv files
+                std::cout << "[Shader] Compiling " << inputPath << "/" << fileName << std::endl;
+
+                std::stringstream outputPath;
+                outputPath << std::filesystem::canonical("/proc/self/exe").remove_filename().c_str() << "resources/shaders";
+                std::string outputFileName = fileName;
+                for (const auto &define: defines) {
+                    outputFileName += "." + define;
+                }
+                std::replace(outputFileName.begin(), outputFileName.end(), '=', '_');
+                compileShader(inputPath, outputPath.str(), fileName, outputFileName, defines);
+                code = readFile(outputPath.str() + "/" + outputFileName + ".spv");
+            }
 
             reflect(code);
 
             m_shaderModule = createShaderModule(code, m_gpuContext->m_device);
         }
 
+        // compile all shaders with glslc from their sources (e.g. while editing them), set with the environment variable ENGINE_COMPILE_SHADERS
+        static inline bool m_runtimeCompilation = std::getenv("ENGINE_COMPILE_SHADERS") != nullptr;
+
         ~Shader() {
             release();
         }
@@ -84,6 +107,8 @@ namespace engine {
 
         VkExtent3D m_workGroupSize = {0, 0, 0};
 
+        static inline std::mutex m_compileMutex;
+
         static VkShaderModule createShaderModule(const std::vector<char> &code, VkDevice device) {
             VkShaderModuleCreateInfo createInfo{};
             createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -111,11 +136,15 @@ namespace engine {
             return buffer;
         }
 
-        static void compileShader(const std::string &inputPath, const std::string &outputPath, const std::string &fileName) {
+        static void compileShader(const std::string &inputPath, const std::string &outputPath, const std::string &fileName, const std::string &outputFileName, const std::vector<std::string> &defines) {
             std::filesystem::create_directories(outputPath);
 
             std::stringstream cmd;
-            cmd << "glslc --target-spv=spv1.5 " << inputPath << "/" << fileName << " -o " << outputPath << "/" << fileName << ".spv";
+            cmd << "glslc --target-spv=spv1.5";
+            for (const auto &define: defines) {
+                cmd << " -D" << define;
+            }
+            cmd << " " << inputPath << "/" << fileName << " -o " << outputPath << "/" << outputFileName << ".spv";
 
             std::string cmd_output;
             char read_buffer[1024];
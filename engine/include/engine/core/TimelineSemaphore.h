@@ -0,0 +1,255 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "GPUContext.h"
+#include <vulkan/vulkan_core.h>
+
+namespace engine {
+    /**
+     * Vulkan 1.2 timeline semaphore, every submission signals its own value of the monotonically increasing counter.
+     * The host waits for or polls a value without fences, later submissions wait for it on the GPU.
+     * Host waits and polls hold a shared lock, release destroys the semaphore once none of them is inside Vulkan anymore.
+     */
+    class TimelineSemaphore {
+    public:
+        explicit TimelineSemaphore(GPUContext *gpuContext) : m_gpuContext(gpuContext) {
+            VkSemaphoreTypeCreateInfo typeInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO, .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE, .initialValue = 0};
+            VkSemaphoreCreateInfo semaphoreInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &typeInfo};
+            if (vkCreateSemaphore(m_gpuContext->m_device, &semaphoreInfo, nullptr, &m_semaphore) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create timeline semaphore!");
+            }
+        }
+
+        ~TimelineSemaphore() {
+            release();
+        }
+
+        TimelineSemaphore(const TimelineSemaphore &) = delete;
+
+        TimelineSemaphore &operator=(const TimelineSemaphore &) = delete;
+
+        // waits for the host waits and polls in progress (release after the submitted values are reached, e.g. ComputePass::releaseAsync),
+        // later waits and polls of remaining handles count as completed
+        void release() {
+            std::unique_lock lock(m_mutex);
+            if (m_semaphore) {
+                vkDestroySemaphore(m_gpuContext->m_device, m_semaphore, nullptr);
+            }
+            m_semaphore = VK_NULL_HANDLE;
+        }
+
+        [[nodiscard]] VkSemaphore getSemaphore() const {
+            std::shared_lock lock(m_mutex);
+            return m_semaphore;
+        }
+
+        // the value to signal by the next submission
+        uint64_t nextValue() {
+            return ++m_lastValue;
+        }
+
+        // counter value reached by the GPU, all values count as reached after release
+        [[nodiscard]] uint64_t getCompletedValue() const {
+            std::shared_lock lock(m_mutex);
+            if (!m_semaphore) {
+                return UINT64_MAX;
+            }
+            uint64_t value = 0;
+            vkGetSemaphoreCounterValue(m_gpuContext->m_device, m_semaphore, &value);
+            return value;
+        }
+
+        // false if the timeout (nanoseconds) expired first
+        bool wait(uint64_t value, uint64_t timeout = UINT64_MAX) const {
+            std::shared_lock lock(m_mutex);
+            if (!m_semaphore) {
+                return true;
+            }
+            VkSemaphoreWaitInfo waitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO, .semaphoreCount = 1, .pSemaphores = &m_semaphore, .pValues = &value};
+            const VkResult result = vkWaitSemaphores(m_gpuContext->m_device, &waitInfo, timeout);
+            if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+                throw std::runtime_error("Failed to wait for timeline semaphore!");
+            }
+            return result == VK_SUCCESS;
+        }
+
+    private:
+        GPUContext *m_gpuContext;
+        VkSemaphore m_semaphore = VK_NULL_HANDLE;
+        std::atomic<uint64_t> m_lastValue = 0;
+        mutable std::shared_mutex m_mutex; // shared: host waits and polls, exclusive: release
+    };
+
+    /**
+     * One thread of the process waits for the semaphore values of SubmitHandle::toFuture and co_await and runs their continuations,
+     * instead of one thread per wait. Continuations run on this thread and delay the other waits, they should be short.
+     */
+    class SemaphoreWaiter {
+    public:
+        static SemaphoreWaiter &get() {
+            static SemaphoreWaiter waiter;
+            return waiter;
+        }
+
+        ~SemaphoreWaiter() {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_one();
+            m_thread.join();
+        }
+
+        SemaphoreWaiter(const SemaphoreWaiter &) = delete;
+
+        SemaphoreWaiter &operator=(const SemaphoreWaiter &) = delete;
+
+        // continuation runs once the semaphore reached the value
+        void add(std::shared_ptr<TimelineSemaphore> semaphore, uint64_t value, std::function<void()> continuation) {
+            {
+                std::lock_guard lock(m_mutex);
+                m_pending.push_back({std::move(semaphore), value, std::move(continuation)});
+            }
+            m_condition.notify_one();
+        }
+
+    private:
+        struct Pending {
+            std::shared_ptr<TimelineSemaphore> m_semaphore;
+            uint64_t m_value;
+            std::function<void()> m_continuation;
+        };
+
+        static const uint64_t POLL_TIMEOUT = 1000000; // nanoseconds of a wait for the oldest value before the others are polled again
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::vector<Pending> m_pending;
+        bool m_stop = false;
+        std::thread m_thread; // started last
+
+        SemaphoreWaiter() : m_thread([this]() { run(); }) {
+        }
+
+        void run() {
+            std::unique_lock lock(m_mutex);
+            while (true) {
+                m_condition.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+                if (m_stop) {
+                    return;
+                }
+                std::vector<Pending> pending = std::move(m_pending);
+                m_pending.clear();
+                lock.unlock(); // continuations may add waits
+
+                std::vector<Pending> remaining;
+                for (auto &wait: pending) {
+                    if (wait.m_semaphore->getCompletedValue() >= wait.m_value) {
+                        wait.m_continuation();
+                    } else {
+                        remaining.push_back(std::move(wait));
+                    }
+                }
+                if (!remaining.empty() && remaining.size() == pending.size()) {
+                    remaining.front().m_semaphore->wait(remaining.front().m_value, POLL_TIMEOUT);
+                }
+
+                lock.lock();
+                m_pending.insert(m_pending.end(), std::make_move_iterator(remaining.begin()), std::make_move_iterator(remaining.end()));
+            }
+        }
+    };
+
+    /**
+     * Completion of an asynchronous submission: a value of a timeline semaphore.
+     * A default constructed handle is already complete. Chain GPU work onto it with addWait (VkTimelineSemaphoreSubmitInfo),
+     * on the host wait() blocks, poll() does not, toFuture() and co_await wait on the thread of the SemaphoreWaiter.
+     */
+    class SubmitHandle {
+    public:
+        SubmitHandle() = default;
+
+        SubmitHandle(std::shared_ptr<TimelineSemaphore> semaphore, uint64_t value) : m_semaphore(std::move(semaphore)), m_value(value) {
+        }
+
+        [[nodiscard]] bool isValid() const {
+            return m_semaphore != nullptr;
+        }
+
+        // true if the submission has finished, never blocks
+        [[nodiscard]] bool poll() const {
+            return !m_semaphore || m_semaphore->getCompletedValue() >= m_value;
+        }
+
+        // false if the timeout (nanoseconds) expired before the submission finished
+        bool wait(uint64_t timeout = UINT64_MAX) const {
+            return !m_semaphore || m_semaphore->wait(m_value, timeout);
+        }
+
+        [[nodiscard]] VkSemaphore getSemaphore() const {
+            return m_semaphore ? m_semaphore->getSemaphore() : VK_NULL_HANDLE;
+        }
+
+        [[nodiscard]] uint64_t getValue() const {
+            return m_value;
+        }
+
+        // appends the handle to the wait semaphores of a submission (pWaitSemaphoreValues of its VkTimelineSemaphoreSubmitInfo)
+        void addWait(std::vector<VkSemaphore> &semaphores, std::vector<uint64_t> &values, std::vector<VkPipelineStageFlags> &stages, VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) const {
+            if (m_semaphore) {
+                semaphores.push_back(m_semaphore->getSemaphore());
+                values.push_back(m_value);
+                stages.push_back(stage);
+            }
+        }
+
+        // ready once the submission has finished
+        [[nodiscard]] std::future<void> toFuture() const {
+            if (poll()) {
+                std::promise<void> promise;
+                promise.set_value();
+                return promise.get_future();
+            }
+            auto promise = std::make_shared<std::promise<void>>();
+            std::future<void> future = promise->get_future();
+            SemaphoreWaiter::get().add(m_semaphore, m_value, [promise]() { promise->set_value(); });
+            return future;
+        }
+
+        // co_await handle: suspends the coroutine until the submission has finished, it is resumed on the thread of the SemaphoreWaiter
+        struct Awaiter {
+            std::shared_ptr<TimelineSemaphore> m_semaphore;
+            uint64_t m_value;
+
+            [[nodiscard]] bool await_ready() const {
+                return !m_semaphore || m_semaphore->getCompletedValue() >= m_value;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) const {
+                SemaphoreWaiter::get().add(m_semaphore, m_value, [coroutine]() { coroutine.resume(); });
+            }
+
+            void await_resume() const {
+            }
+        };
+
+        Awaiter operator co_await() const {
+            return Awaiter{m_semaphore, m_value};
+        }
+
+    private:
+        std::shared_ptr<TimelineSemaphore> m_semaphore; // kept alive by its handles
+        uint64_t m_value = 0;
+    };
+} // namespace engine
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "Pass.h"
+#include "engine/core/TimelineSemaphore.h"
+
+#include <fstream>
+#include <map>
+#include <ostream>
 
 namespace engine {
     class ComputePass : public Pass {
@@ -11,6 +16,116 @@ namespace engine {
         void create() override {
             Pass::create();
             m_workGroupCounts.resize(m_shaders.size());
+            m_computeQueueIndex = m_gpuContext->m_queues->acquireComputeQueue(m_queuePriority); // passes are spread over the compute queues
+        }
+
+        void release() override {
+            releaseProfiling();
+            releaseAsync();
+            Pass::release();
+        }
+
+        // gpu time of a single dispatch measured with timestamp queries
+        struct DispatchTiming {
+            std::string m_label;     // profiling label of the execution (setProfilingLabel)
+            std::string m_stageName; // getStageName(m_stageIndex)
+            uint32_t m_stageIndex;
+            double m_milliseconds;
+            uint64_t m_bytes; // bytes read and written by the dispatch (getStageBytes)
+
+            [[nodiscard]] double getGigabytesPerSecond() const {
+                return m_milliseconds > 0.0 ? static_cast<double>(m_bytes) / (m_milliseconds * 1e6) : 0.0;
+            }
+        };
+
+        // writes a timestamp before and after every dispatch of the following executions, does nothing if the compute queue has no timestamps
+        void enableProfiling() {
+            if (!m_queryPools.empty()) {
+                return;
+            }
+            VkPhysicalDeviceProperties deviceProperties;
+            vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(m_gpuContext->m_physicalDevice, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(m_gpuContext->m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+            if (queueFamilies[m_queueFamilyIndex].timestampValidBits == 0) {
+                std::cerr << "[ComputePass] Timestamps are not supported by the compute queue, profiling is disabled." << std::endl;
+                return;
+            }
+            m_timestampPeriod = deviceProperties.limits.timestampPeriod;
+            m_timestampMask = queueFamilies[m_queueFamilyIndex].timestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << queueFamilies[m_queueFamilyIndex].timestampValidBits) - 1;
+
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = MAX_PROFILED_DISPATCHES * 2;
+            m_queryPools.resize(m_gpuContext->getMultiBufferedCount());
+            m_pendingTimings.resize(m_gpuContext->getMultiBufferedCount());
+            for (auto &queryPool: m_queryPools) {
+                if (vkCreateQueryPool(m_gpuContext->m_device, &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create query pool!");
+                }
+            }
+        }
+
+        [[nodiscard]] bool isProfiling() const {
+            return !m_queryPools.empty();
+        }
+
+        // label of the dispatches recorded by the next executions (e.g. "digit 0")
+        void setProfilingLabel(const std::string &label) {
+            m_profilingLabel = label;
+        }
+
+        // waits for all profiled executions and returns their dispatch timings in execution order
+        const std::vector<DispatchTiming> &getProfilingResults() {
+            for (uint32_t i = 0; i < m_queryPools.size(); i++) {
+                vkWaitForFences(m_gpuContext->m_device, 1, &m_fences[i], VK_TRUE, UINT64_MAX);
+                collectProfilingResults(i);
+            }
+            return m_profilingResults;
+        }
+
+        void clearProfilingResults() {
+            getProfilingResults();
+            m_profilingResults.clear();
+        }
+
+        // per stage and label: number of dispatches, total time and achieved bandwidth
+        void printProfilingResults(std::ostream &stream) {
+            for (const auto &[key, timing]: getProfilingSummary()) {
+                stream << "[ComputePass] " << timing.m_label << (timing.m_label.empty() ? "" : " ") << timing.m_stageName << ": " << timing.m_milliseconds << "[ms], " << timing.getGigabytesPerSecond() << "[GB/s]" << std::endl;
+            }
+        }
+
+        // {"dispatches": [...], "summary": [...]}
+        void writeProfilingJson(std::ostream &stream) {
+            auto writeTiming = [&](const DispatchTiming &timing) {
+                stream << "{\"label\": \"" << timing.m_label << "\", \"stage\": \"" << timing.m_stageName << "\", \"stageIndex\": " << timing.m_stageIndex << ", \"ms\": " << timing.m_milliseconds << ", \"bytes\": " << timing.m_bytes << ", \"GBps\": " << timing.getGigabytesPerSecond() << "}";
+            };
+            const auto &results = getProfilingResults();
+            stream << "{\n  \"dispatches\": [";
+            for (size_t i = 0; i < results.size(); i++) {
+                stream << (i == 0 ? "\n    " : ",\n    ");
+                writeTiming(results[i]);
+            }
+            stream << "\n  ],\n  \"summary\": [";
+            bool first = true;
+            for (const auto &[key, timing]: getProfilingSummary()) {
+                stream << (first ? "\n    " : ",\n    ");
+                writeTiming(timing);
+                first = false;
+            }
+            stream << "\n  ]\n}" << std::endl;
+        }
+
+        void writeProfilingJson(const std::string &path) {
+            std::ofstream file(path);
+            if (!file) {
+                throw std::runtime_error("Failed to open " + path + "!");
+            }
+            writeProfilingJson(file);
         }
 
         void setGlobalInvocationSize(uint32_t stageIndex, uint32_t width, uint32_t height, uint32_t depth) {
@@ -29,11 +144,14 @@ namespace engine {
         }
 
         VkSemaphore execute(VkSemaphore awaitBeforeExecution) override {
-            vkWaitForFences(m_gpuContext->m_device, 1, &m_fences[m_gpuContext->getActiveIndex()], VK_TRUE, UINT64_MAX); // waiting for the previous frame to finish, blocks the CPU
-            vkResetFences(m_gpuContext->m_device, 1, &m_fences[m_gpuContext->getActiveIndex()]);
+            vkWaitForFences(m_gpuContext->m_device, 1, &m_fences[m_activeIndex], VK_TRUE, UINT64_MAX); // waiting for the previous frame to finish, blocks the CPU
+            vkResetFences(m_gpuContext->m_device, 1, &m_fences[m_activeIndex]);
+            if (isProfiling()) {
+                collectProfilingResults(m_activeIndex); // the timestamps of the previous execution with this index are available
+            }
 
-            vkResetCommandBuffer(m_commandBuffers[m_gpuContext->getActiveIndex()], 0);
-            fillCommandBuffer(m_commandBuffers[m_gpuContext->getActiveIndex()]);
+            vkResetCommandBuffer(m_commandBuffers[m_activeIndex], 0);
+            fillCommandBuffer(m_commandBuffers[m_activeIndex]);
 
             VkSubmitInfo submitInfo{};
             submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -44,22 +162,108 @@ namespace engine {
                 submitInfo.pWaitDstStageMask = waitStages;
             }
             submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &m_commandBuffers[m_gpuContext->getActiveIndex()];
+            submitInfo.pCommandBuffers = &m_commandBuffers[m_activeIndex];
             submitInfo.signalSemaphoreCount = 1;
-            submitInfo.pSignalSemaphores = &m_signalSemaphores[m_gpuContext->getActiveIndex()]; // is signaled when the command buffer has finished execution
+            submitInfo.pSignalSemaphores = &m_signalSemaphores[m_activeIndex]; // is signaled when the command buffer has finished execution
 
-            if (vkQueueSubmit(m_gpuContext->m_queues->getQueue(Queues::COMPUTE), 1, &submitInfo, m_fences[m_gpuContext->getActiveIndex()]) != VK_SUCCESS) { // signal fence after the command buffer finished execution
+            if (m_gpuContext->m_queues->submitCompute(m_computeQueueIndex, 1, &submitInfo, m_fences[m_activeIndex]) != VK_SUCCESS) { // signal fence after the command buffer finished execution
                 throw std::runtime_error("Failed to submit compute command buffer!");
             }
 
-            return m_signalSemaphores[m_gpuContext->getActiveIndex()];
+            return m_signalSemaphores[m_activeIndex];
+        }
+
+        // waits for all submitted executions of this pass, unlike vkQueueWaitIdle not for the work of other passes on the queue
+        void wait() {
+            vkWaitForFences(m_gpuContext->m_device, static_cast<uint32_t>(m_fences.size()), m_fences.data(), VK_TRUE, UINT64_MAX);
+            if (m_timelineSemaphore) {
+                m_timelineSemaphore->wait(m_asyncSubmittedValue);
+            }
+        }
+
+        // PRIORITY_HIGH submits to the first compute queue (highest queue priority), other passes are distributed round robin over the remaining ones
+        // changes the queue of a created pass, only while it is idle (wait)
+        void setQueuePriority(Queues::Priority priority) {
+            m_queuePriority = priority;
+            if (!m_shaders.empty()) {
+                m_computeQueueIndex = m_gpuContext->m_queues->acquireComputeQueue(priority);
+            }
+        }
+
+        // index of the compute queue the pass submits to (Queues::submitCompute)
+        [[nodiscard]] uint32_t getComputeQueueIndex() const {
+            return m_computeQueueIndex;
+        }
+
+        // records the commands of the pass into a command buffer recorded by the caller (e.g. a PassGraph), nothing is submitted
+        void record(VkCommandBuffer commandBuffer) {
+            m_recordingAsync = true; // no timestamps outside of execute
+            recordCommands(commandBuffer);
+            m_recordingAsync = false;
         }
 
         [[nodiscard]] VkExtent3D getWorkGroupCount(uint32_t stageIndex) {
             return m_workGroupCounts[stageIndex];
         }
 
+        // sets the dispatch size directly (e.g. more invocations than fit into setGlobalInvocationSize)
+        void setWorkGroupCount(uint32_t stageIndex, uint32_t width, uint32_t height, uint32_t depth) {
+            m_workGroupCounts[stageIndex] = {width, height, depth};
+        }
+
     protected:
+        // records the commands into a command buffer of its own and submits it to the compute queue without waiting for previous executions,
+        // the returned handle signals its completion, the commands wait for waitHandles on the GPU
+        // command buffers are reused once their submission has finished, timestamps are not written (profiling covers execute only)
+        SubmitHandle submitCommands(const std::function<void(VkCommandBuffer)> &recordCommands, const std::vector<SubmitHandle> &waitHandles = {}) {
+            if (!m_timelineSemaphore) {
+                m_timelineSemaphore = std::make_shared<TimelineSemaphore>(m_gpuContext);
+            }
+            VkCommandBuffer commandBuffer = acquireAsyncCommandBuffer();
+
+            VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording command buffer!");
+            }
+            m_recordingAsync = true;
+            recordCommands(commandBuffer);
+            m_recordingAsync = false;
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record command buffer!");
+            }
+
+            std::vector<VkSemaphore> waitSemaphores;
+            std::vector<uint64_t> waitValues;
+            std::vector<VkPipelineStageFlags> waitStages;
+            for (const auto &handle: waitHandles) {
+                handle.addWait(waitSemaphores, waitValues, waitStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            }
+            const uint64_t signalValue = m_timelineSemaphore->nextValue();
+            const VkSemaphore signalSemaphore = m_timelineSemaphore->getSemaphore();
+
+            VkTimelineSemaphoreSubmitInfo timelineInfo{.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+            timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+            timelineInfo.pWaitSemaphoreValues = waitValues.data();
+            timelineInfo.signalSemaphoreValueCount = 1;
+            timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+            VkSubmitInfo submitInfo{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO, .pNext = &timelineInfo};
+            submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+            submitInfo.pWaitSemaphores = waitSemaphores.data();
+            submitInfo.pWaitDstStageMask = waitStages.data();
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &signalSemaphore;
+
+            if (m_gpuContext->m_queues->submitCompute(m_computeQueueIndex, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to submit compute command buffer!");
+            }
+            m_asyncCommandBuffers.emplace_back(commandBuffer, signalValue);
+            m_asyncSubmittedValue = signalValue;
+            return {m_timelineSemaphore, signalValue};
+        }
+
         uint32_t findQueueFamilyIndex() override {
             Queues::QueueFamilyIndices queueFamilyIndices = m_gpuContext->m_queues->findQueueFamilies(m_gpuContext->m_physicalDevice);
             return queueFamilyIndices.computeFamily.value();
@@ -76,7 +280,7 @@ namespace engine {
                 pipelineInfo.stage = shaderStage;
 
                 m_pipelines.emplace_back();
-                if (vkCreateComputePipelines(m_gpuContext->m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[m_pipelines.size() - 1]) != VK_SUCCESS) {
+                if (vkCreateComputePipelines(m_gpuContext->m_device, m_gpuContext->m_pipelineCache, 1, &pipelineInfo, nullptr, &m_pipelines[m_pipelines.size() - 1]) != VK_SUCCESS) {
                     throw std::runtime_error("Failed to create compute pipeline!");
                 }
             }
@@ -93,12 +297,120 @@ namespace engine {
             getDescriptorSets(descriptorSets);
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayouts[stageIndex], 0, descriptorSets.size(), descriptorSets.data(), 0, nullptr);
 
+            const uint32_t activeIndex = m_activeIndex;
+            const bool profiled = isProfiling() && !m_recordingAsync && m_pendingTimings[activeIndex].size() < MAX_PROFILED_DISPATCHES;
+            const uint32_t query = profiled ? static_cast<uint32_t>(2 * m_pendingTimings[activeIndex].size()) : 0;
+            if (profiled) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, m_queryPools[activeIndex], query); // after the previous dispatches finished
+            }
+
             vkCmdDispatch(commandBuffer, m_workGroupCounts[stageIndex].width, m_workGroupCounts[stageIndex].height, m_workGroupCounts[stageIndex].depth);
+
+            if (profiled) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, m_queryPools[activeIndex], query + 1);
+                m_pendingTimings[activeIndex].push_back({m_profilingLabel, getStageName(stageIndex), stageIndex, 0.0, getStageBytes(stageIndex)});
+            }
+        }
+
+        // name of the stage in the profiling results
+        [[nodiscard]] virtual std::string getStageName(uint32_t stageIndex) const {
+            return "stage" + std::to_string(stageIndex);
+        }
+
+        // bytes read and written by a dispatch of the stage, used for the bandwidth in the profiling results
+        [[nodiscard]] virtual uint64_t getStageBytes(uint32_t stageIndex) const {
+            return 0;
         }
 
     private:
         std::vector<VkExtent3D> m_workGroupCounts;
 
+        // profiling
+        static const uint32_t MAX_PROFILED_DISPATCHES = 32; // per execution
+
+        std::vector<VkQueryPool> m_queryPools;                      // m_queryPools[multiBufferedIndex], empty if profiling is disabled
+        std::vector<std::vector<DispatchTiming>> m_pendingTimings;  // m_pendingTimings[multiBufferedIndex] - recorded but not yet collected
+        std::vector<DispatchTiming> m_profilingResults;
+        std::string m_profilingLabel;
+        float m_timestampPeriod = 1.0f; // nanoseconds per tick
+        uint64_t m_timestampMask = UINT64_MAX;
+
+        void collectProfilingResults(uint32_t multiBufferedIndex) {
+            auto &pendingTimings = m_pendingTimings[multiBufferedIndex];
+            if (pendingTimings.empty()) {
+                return;
+            }
+            std::vector<uint64_t> timestamps(2 * pendingTimings.size());
+            if (vkGetQueryPoolResults(m_gpuContext->m_device, m_queryPools[multiBufferedIndex], 0, timestamps.size(), timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to get query pool results!");
+            }
+            for (size_t i = 0; i < pendingTimings.size(); i++) {
+                const uint64_t ticks = ((timestamps[2 * i + 1] & m_timestampMask) - (timestamps[2 * i] & m_timestampMask)) & m_timestampMask;
+                pendingTimings[i].m_milliseconds = static_cast<double>(ticks) * m_timestampPeriod * 1e-6;
+                m_profilingResults.push_back(pendingTimings[i]);
+            }
+            pendingTimings.clear();
+        }
+
+        // accumulated timings per label and stage
+        std::map<std::pair<std::string, uint32_t>, DispatchTiming> getProfilingSummary() {
+            std::map<std::pair<std::string, uint32_t>, DispatchTiming> summary;
+            for (const auto &timing: getProfilingResults()) {
+                auto [it, inserted] = summary.try_emplace({timing.m_label, timing.m_stageIndex}, DispatchTiming{timing.m_label, timing.m_stageName, timing.m_stageIndex, 0.0, 0});
+                it->second.m_milliseconds += timing.m_milliseconds;
+                it->second.m_bytes += timing.m_bytes;
+            }
+            return summary;
+        }
+
+        Queues::Priority m_queuePriority = Queues::PRIORITY_NORMAL;
+        uint32_t m_computeQueueIndex = 0;
+
+        // submitCommands
+        std::shared_ptr<TimelineSemaphore> m_timelineSemaphore; // created on first use, shared with the handles
+        std::vector<std::pair<VkCommandBuffer, uint64_t>> m_asyncCommandBuffers; // with the signal value of their last submission
+        uint64_t m_asyncSubmittedValue = 0;
+        bool m_recordingAsync = false;
+
+        // a command buffer whose submission has finished or a new one
+        VkCommandBuffer acquireAsyncCommandBuffer() {
+            const uint64_t completedValue = m_timelineSemaphore->getCompletedValue();
+            for (size_t i = 0; i < m_asyncCommandBuffers.size(); i++) {
+                if (m_asyncCommandBuffers[i].second <= completedValue) {
+                    const VkCommandBuffer commandBuffer = m_asyncCommandBuffers[i].first;
+                    m_asyncCommandBuffers.erase(m_asyncCommandBuffers.begin() + static_cast<std::ptrdiff_t>(i));
+                    return commandBuffer; // reset by vkBeginCommandBuffer (VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+                }
+            }
+            VkCommandBufferAllocateInfo allocInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, .commandPool = m_commandPool, .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, .commandBufferCount = 1};
+            VkCommandBuffer commandBuffer;
+            if (vkAllocateCommandBuffers(m_gpuContext->m_device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate command buffer!");
+            }
+            return commandBuffer;
+        }
+
+        void releaseAsync() {
+            if (!m_timelineSemaphore) {
+                return;
+            }
+            m_timelineSemaphore->wait(m_asyncSubmittedValue);
+            m_asyncCommandBuffers.clear(); // freed with the command pool
+            m_timelineSemaphore->release(); // after the host waits in progress, remaining handles count as completed
+            m_timelineSemaphore = nullptr;
+        }
+
+        void releaseProfiling() {
+            if (isProfiling()) {
+                getProfilingResults();
+            }
+            for (auto &queryPool: m_queryPools) {
+                vkDestroyQueryPool(m_gpuContext->m_device, queryPool, nullptr);
+            }
+            m_queryPools.clear();
+            m_pendingTimings.clear();
+        }
+
         void fillCommandBuffer(VkCommandBuffer commandBuffer) {
             // fill command buffer
             VkCommandBufferBeginInfo beginInfo{};
@@ -108,6 +420,10 @@ namespace engine {
                 throw std::runtime_error("failed to begin recording command buffer!");
             }
 
+            if (isProfiling()) {
+                vkCmdResetQueryPool(commandBuffer, m_queryPools[m_activeIndex], 0, MAX_PROFILED_DISPATCHES * 2);
+            }
+
             recordCommands(commandBuffer);
 
             if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
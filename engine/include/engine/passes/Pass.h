@@ -107,9 +107,21 @@ namespace engine {
             return m_uniforms[set][binding];
         }
 
+        // multi-buffered index of the next execution (descriptor sets, command buffers, fences), owned by the pass
+        // so that passes of the same context can be executed from different threads, a single pass is used by one thread at a time
+        [[nodiscard]] uint32_t getActiveIndex() const {
+            return m_activeIndex;
+        }
+
+        void incrementActiveIndex() {
+            m_activeIndex = (m_activeIndex + 1) % m_gpuContext->getMultiBufferedCount();
+        }
+
     protected:
         GPUContext *m_gpuContext;
 
+        uint32_t m_activeIndex = 0;
+
         std::vector<VkPipelineLayout> m_pipelineLayouts{};
         std::vector<VkPipeline> m_pipelines{};
 
@@ -154,9 +166,9 @@ namespace engine {
         virtual std::vector<std::shared_ptr<Shader>> createShaders() = 0;
 
         void getDescriptorSets(std::vector<VkDescriptorSet> &sets) {
-            sets.resize(m_descriptorSets[m_gpuContext->getActiveIndex()].size());
-            for (uint32_t i = 0; i < m_descriptorSets[m_gpuContext->getActiveIndex()].size(); i++) {
-                sets[i] = m_descriptorSets[m_gpuContext->getActiveIndex()][i];
+            sets.resize(m_descriptorSets[m_activeIndex].size());
+            for (uint32_t i = 0; i < m_descriptorSets[m_activeIndex].size(); i++) {
+                sets[i] = m_descriptorSets[m_activeIndex][i];
             }
         }
 
@@ -0,0 +1,571 @@
+#pragma once
+
+#include "engine/core/Buffer.h"
+#include "engine/core/GPUContext.h"
+#include "engine/core/TimelineSemaphore.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace engine {
+    /**
+     * Frame graph of passes that declare the buffers they read and write.
+     * The passes run in the order they were added (a valid topological order). From the declared accesses the graph derives
+     * the dependencies (read after write, write after write, write after read) and
+     * - merges consecutive passes of a queue into one command buffer (batch), a batch is only split where a pass has to wait for another queue,
+     * - records buffer memory barriers only between passes with a hazard on the same queue (independent passes overlap),
+     * - synchronizes batches of different queues with one timeline semaphore per queue, transfers the ownership of buffers between
+     *   queue families (release at the end of the producing batch, acquire before the consuming pass),
+     * - makes buffers read on the host (readOnHost) visible once the returned handles have completed.
+     * Buffers are owned by the family of their first pass, the ownership after an execution is remembered for the next one.
+     * Passes added on Queues::COMPUTE are spread over all compute queues of the context (Queues::getComputeQueueCount): a pass stays on the
+     * queue of its latest compute dependency, passes of the same dependency level that are independent of each other go to different queues
+     * (round robin), so they overlap on the GPU. setSpreadComputePasses(false) keeps all of them on the COMPUTE queue.
+     */
+    class PassGraph {
+    public:
+        explicit PassGraph(GPUContext *gpuContext) : m_gpuContext(gpuContext) {
+        }
+
+        ~PassGraph() {
+            release();
+        }
+
+        PassGraph(const PassGraph &) = delete;
+
+        PassGraph &operator=(const PassGraph &) = delete;
+
+        // stage: VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT (shader reads and writes), VK_PIPELINE_STAGE_TRANSFER_BIT (copies and fills) or both,
+        // the accesses of a buffer are made visible to every stage of the pass
+        // a buffer in reads and writes is read and written, record must not synchronize with other passes itself
+        uint32_t addPass(const std::string &name, Queues::Queue queue, VkPipelineStageFlags stage, const std::vector<Buffer *> &reads, const std::vector<Buffer *> &writes, const std::function<void(VkCommandBuffer)> &record) {
+            m_passes.push_back({name, queue, queue, stage, reads, writes, record});
+            return static_cast<uint32_t>(m_passes.size() - 1);
+        }
+
+        // true (default): independent passes added on Queues::COMPUTE are scheduled onto separate compute queues
+        void setSpreadComputePasses(bool spreadComputePasses) {
+            m_spreadComputePasses = spreadComputePasses;
+        }
+
+        // the buffer is read by the host after the execution
+        void readOnHost(Buffer *buffer) {
+            m_hostReads.push_back(buffer);
+        }
+
+        // removes the passes (e.g. to build the graph of the next frame), the buffer ownership is kept
+        void clear() {
+            m_passes.clear();
+            m_hostReads.clear();
+        }
+
+        // records and submits the batches without blocking, waits for the previous execution of the graph first (its command buffers are reused)
+        // the first batch of every queue waits for waitHandles, the returned handles (one per used queue) complete with the graph
+        std::vector<SubmitHandle> execute(const std::vector<SubmitHandle> &waitHandles = {}) {
+            wait();
+            for (const auto &[family, commandPool]: m_commandPools) {
+                vkResetCommandPool(m_gpuContext->m_device, commandPool, 0);
+            }
+            compile();
+
+            std::vector<VkCommandBuffer> commandBuffers(m_batches.size());
+            std::vector<uint64_t> signalValues(m_batches.size());
+            std::vector<bool> queueUsed(getLaneCount());
+            m_semaphores.resize(getLaneCount());
+            for (uint32_t i = 0; i < m_batches.size(); i++) {
+                const Batch &batch = m_batches[i];
+                commandBuffers[i] = allocateCommandBuffer(getFamily(batch.m_lane));
+                recordBatch(batch, commandBuffers[i]);
+
+                auto &semaphore = m_semaphores[batch.m_lane];
+                if (!semaphore) {
+                    semaphore = std::make_shared<TimelineSemaphore>(m_gpuContext);
+                }
+                signalValues[i] = semaphore->nextValue(); // batches are submitted in creation order, the values of a queue increase
+
+                std::vector<VkSemaphore> waitSemaphores;
+                std::vector<uint64_t> waitValues;
+                std::vector<VkPipelineStageFlags> waitStages;
+                for (uint32_t queue = 0; queue < batch.m_waitBatches.size(); queue++) {
+                    if (batch.m_waitBatches[queue] >= 0) {
+                        SubmitHandle(m_semaphores[queue], signalValues[batch.m_waitBatches[queue]]).addWait(waitSemaphores, waitValues, waitStages);
+                    }
+                }
+                if (!queueUsed[batch.m_lane]) {
+                    for (const auto &handle: waitHandles) {
+                        handle.addWait(waitSemaphores, waitValues, waitStages);
+                    }
+                }
+                queueUsed[batch.m_lane] = true;
+
+                const VkSemaphore signalSemaphore = semaphore->getSemaphore();
+                VkTimelineSemaphoreSubmitInfo timelineInfo{.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+                timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+                timelineInfo.pWaitSemaphoreValues = waitValues.data();
+                timelineInfo.signalSemaphoreValueCount = 1;
+                timelineInfo.pSignalSemaphoreValues = &signalValues[i];
+
+                VkSubmitInfo submitInfo{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO, .pNext = &timelineInfo};
+                submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+                submitInfo.pWaitSemaphores = waitSemaphores.data();
+                submitInfo.pWaitDstStageMask = waitStages.data();
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &commandBuffers[i];
+                submitInfo.signalSemaphoreCount = 1;
+                submitInfo.pSignalSemaphores = &signalSemaphore;
+                if (submit(batch.m_lane, submitInfo) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to submit pass graph batch!");
+                }
+            }
+
+            m_pendingHandles.clear();
+            for (uint32_t lane = 0; lane < queueUsed.size(); lane++) {
+                if (queueUsed[lane]) {
+                    m_pendingHandles.emplace_back(m_semaphores[lane], signalValues[getLastBatch(lane)]);
+                }
+            }
+            return m_pendingHandles;
+        }
+
+        // waits for the last execution
+        void wait() {
+            for (const auto &handle: m_pendingHandles) {
+                handle.wait();
+            }
+            m_pendingHandles.clear();
+        }
+
+        void release() {
+            wait();
+            for (const auto &[family, commandPool]: m_commandPools) {
+                vkDestroyCommandPool(m_gpuContext->m_device, commandPool, nullptr);
+            }
+            m_commandPools.clear();
+            for (auto &semaphore: m_semaphores) {
+                if (semaphore) {
+                    semaphore->release();
+                }
+                semaphore = nullptr;
+            }
+        }
+
+        // batches, waits and barriers of the last execution
+        void print(std::ostream &stream) const {
+            static const char *queueNames[] = {"GRAPHICS", "COMPUTE", "TRANSFER", "ASYNC_TRANSFER"};
+            for (uint32_t i = 0; i < m_batches.size(); i++) {
+                const Batch &batch = m_batches[i];
+                stream << "[PassGraph] batch " << i << " (";
+                if (batch.m_lane < NUM_QUEUES) {
+                    stream << queueNames[batch.m_lane];
+                } else {
+                    stream << "COMPUTE " << getComputeQueueIndex(batch.m_lane);
+                }
+                stream << ")";
+                for (uint32_t queue = 0; queue < batch.m_waitBatches.size(); queue++) {
+                    if (batch.m_waitBatches[queue] >= 0) {
+                        stream << " waits for batch " << batch.m_waitBatches[queue];
+                    }
+                }
+                stream << ":" << std::endl;
+                for (uint32_t j = 0; j < batch.m_passes.size(); j++) {
+                    stream << "[PassGraph]   " << m_passes[batch.m_passes[j]].m_name;
+                    if (!batch.m_barriers[j].empty()) {
+                        stream << " after " << batch.m_barriers[j].size() << " barrier(s)";
+                    }
+                    stream << std::endl;
+                }
+                if (!batch.m_endBarriers.empty()) {
+                    stream << "[PassGraph]   " << batch.m_endBarriers.size() << " release / host barrier(s)" << std::endl;
+                }
+            }
+        }
+
+    private:
+        struct GraphPass {
+            std::string m_name;
+            Queues::Queue m_queue;
+            uint32_t m_lane; // queue the pass is submitted to, assigned by compile (see getLaneCount)
+            VkPipelineStageFlags m_stage;
+            std::vector<Buffer *> m_reads;
+            std::vector<Buffer *> m_writes;
+            std::function<void(VkCommandBuffer)> m_record;
+        };
+
+        struct Barrier {
+            Buffer *m_buffer;
+            VkPipelineStageFlags m_srcStage;
+            VkAccessFlags m_srcAccess;
+            VkPipelineStageFlags m_dstStage;
+            VkAccessFlags m_dstAccess;
+            uint32_t m_srcFamily = VK_QUEUE_FAMILY_IGNORED; // different families: queue family ownership transfer
+            uint32_t m_dstFamily = VK_QUEUE_FAMILY_IGNORED;
+        };
+
+        // passes of one queue recorded into one command buffer
+        struct Batch {
+            uint32_t m_lane;
+            std::vector<uint32_t> m_passes;
+            std::vector<std::vector<Barrier>> m_barriers; // m_barriers[i]: before m_passes[i]
+            std::vector<Barrier> m_endBarriers;           // ownership releases and host reads
+            std::vector<int32_t> m_waitBatches;           // per queue the latest batch to wait for (-1: none)
+            bool m_open = true;
+        };
+
+        // hazard tracking of a buffer during compile
+        struct BufferState {
+            int32_t m_lastWriter = -1;
+            int32_t m_lastWriterBatch = -1;
+            std::vector<uint32_t> m_readers; // since the last write
+            int32_t m_lastBatch = -1;        // batch of the last access
+            int32_t m_lastPass = -1;         // pass of the last access
+        };
+
+        GPUContext *m_gpuContext;
+
+        std::vector<GraphPass> m_passes;
+        std::vector<Buffer *> m_hostReads;
+
+        std::vector<Batch> m_batches;                        // of the last execution
+        std::map<Buffer *, uint32_t> m_bufferOwners;         // queue family owning the buffer after the last execution
+        std::map<uint32_t, VkCommandPool> m_commandPools;    // per queue family
+        std::vector<std::shared_ptr<TimelineSemaphore>> m_semaphores; // per queue
+        std::vector<SubmitHandle> m_pendingHandles;
+        bool m_spreadComputePasses = true;
+
+        // the queues of the graph (lanes): the Queues::Queue values, then compute queue 1, 2, ... (compute queue 0 is Queues::COMPUTE)
+        static constexpr uint32_t NUM_QUEUES = 4;
+
+        [[nodiscard]] uint32_t getLaneCount() const {
+            return NUM_QUEUES + std::max(1U, m_gpuContext->m_queues->getComputeQueueCount()) - 1;
+        }
+
+        [[nodiscard]] static uint32_t getComputeQueueIndex(uint32_t lane) {
+            return lane < NUM_QUEUES ? 0 : lane - NUM_QUEUES + 1;
+        }
+
+        [[nodiscard]] static uint32_t getComputeLane(uint32_t computeQueueIndex) {
+            return computeQueueIndex == 0 ? Queues::COMPUTE : NUM_QUEUES + computeQueueIndex - 1;
+        }
+
+        [[nodiscard]] uint32_t getFamily(uint32_t lane) const {
+            return m_gpuContext->m_queues->getQueueFamilyIndex(lane < NUM_QUEUES ? static_cast<Queues::Queue>(lane) : Queues::COMPUTE);
+        }
+
+        VkResult submit(uint32_t lane, const VkSubmitInfo &submitInfo) {
+            if (lane < NUM_QUEUES) {
+                return m_gpuContext->m_queues->submit(static_cast<Queues::Queue>(lane), 1, &submitInfo, VK_NULL_HANDLE);
+            }
+            return m_gpuContext->m_queues->submitCompute(getComputeQueueIndex(lane), 1, &submitInfo, VK_NULL_HANDLE);
+        }
+
+        // the read and write accesses of every stage bit of the pass
+        static VkAccessFlags getAccess(VkPipelineStageFlags stage, bool read, bool write) {
+            VkAccessFlags access = 0;
+            if (stage & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) {
+                access |= (read ? VK_ACCESS_SHADER_READ_BIT : 0) | (write ? VK_ACCESS_SHADER_WRITE_BIT : 0);
+            }
+            if (stage & VK_PIPELINE_STAGE_TRANSFER_BIT) {
+                access |= (read ? VK_ACCESS_TRANSFER_READ_BIT : 0) | (write ? VK_ACCESS_TRANSFER_WRITE_BIT : 0);
+            }
+            return access;
+        }
+
+        [[nodiscard]] bool writes(uint32_t pass, Buffer *buffer) const {
+            const auto &passWrites = m_passes[pass].m_writes;
+            return std::find(passWrites.begin(), passWrites.end(), buffer) != passWrites.end();
+        }
+
+        [[nodiscard]] bool reads(uint32_t pass, Buffer *buffer) const {
+            const auto &passReads = m_passes[pass].m_reads;
+            return std::find(passReads.begin(), passReads.end(), buffer) != passReads.end();
+        }
+
+        [[nodiscard]] int32_t getLastBatch(uint32_t lane) const {
+            for (int32_t i = static_cast<int32_t>(m_batches.size()) - 1; i >= 0; i--) {
+                if (m_batches[i].m_lane == lane) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        uint32_t addBatch(uint32_t lane, bool open) {
+            m_batches.push_back({.m_lane = lane, .m_waitBatches = std::vector<int32_t>(getLaneCount(), -1), .m_open = open});
+            return static_cast<uint32_t>(m_batches.size() - 1);
+        }
+
+        // the open batch of the queue, a new one if there is none
+        uint32_t getOpenBatch(uint32_t lane) {
+            const int32_t last = getLastBatch(lane);
+            if (last >= 0 && m_batches[last].m_open) {
+                return last;
+            }
+            return addBatch(lane, true);
+        }
+
+        // the earlier passes p depends on (read after write, write after write, write after read), states: last writer and readers since per buffer
+        void getDependencies(uint32_t p, std::map<Buffer *, std::pair<int32_t, std::vector<uint32_t>>> &states, std::vector<uint32_t> &dependencies) const {
+            dependencies.clear();
+            for (Buffer *buffer: m_passes[p].m_writes) {
+                auto &[lastWriter, readers] = states[buffer];
+                if (lastWriter >= 0) {
+                    dependencies.push_back(lastWriter);
+                }
+                dependencies.insert(dependencies.end(), readers.begin(), readers.end());
+                lastWriter = static_cast<int32_t>(p);
+                readers.clear();
+            }
+            for (Buffer *buffer: m_passes[p].m_reads) {
+                if (!writes(p, buffer)) {
+                    auto &[lastWriter, readers] = states[buffer];
+                    if (lastWriter >= 0) {
+                        dependencies.push_back(lastWriter);
+                    }
+                    readers.push_back(p);
+                }
+            }
+        }
+
+        // assigns the passes on Queues::COMPUTE to the compute queues from their dependency levels (longest chain of dependencies before them):
+        // a pass continues on the queue of its latest compute dependency unless a pass of the same level already runs there, otherwise it
+        // takes the next compute queue without a pass of its level (round robin), the other passes stay on their queue
+        void assignLanes() {
+            const uint32_t computeQueueCount = m_spreadComputePasses ? getLaneCount() - NUM_QUEUES + 1 : 1;
+            std::vector<uint32_t> levels(m_passes.size());
+            std::vector<int64_t> queueLevels(computeQueueCount, -1); // deepest level assigned to the compute queue
+            std::map<Buffer *, std::pair<int32_t, std::vector<uint32_t>>> states;
+            std::vector<uint32_t> dependencies;
+            uint32_t nextComputeQueue = 0;
+            for (uint32_t p = 0; p < m_passes.size(); p++) {
+                GraphPass &pass = m_passes[p];
+                getDependencies(p, states, dependencies);
+                int32_t latestCompute = -1;
+                for (const uint32_t dependency: dependencies) {
+                    levels[p] = std::max(levels[p], levels[dependency] + 1);
+                    if (m_passes[dependency].m_queue == Queues::COMPUTE) {
+                        latestCompute = std::max(latestCompute, static_cast<int32_t>(dependency));
+                    }
+                }
+
+                pass.m_lane = pass.m_queue;
+                if (pass.m_queue != Queues::COMPUTE || computeQueueCount == 1) {
+                    continue;
+                }
+                const int64_t level = levels[p];
+                int32_t computeQueue = latestCompute >= 0 ? static_cast<int32_t>(getComputeQueueIndex(m_passes[latestCompute].m_lane)) : -1;
+                if (computeQueue < 0 || queueLevels[computeQueue] >= level) {
+                    for (uint32_t i = 0; i < computeQueueCount; i++) {
+                        const uint32_t candidate = (nextComputeQueue + i) % computeQueueCount;
+                        if (queueLevels[candidate] < level) {
+                            computeQueue = static_cast<int32_t>(candidate);
+                            nextComputeQueue = candidate + 1;
+                            break;
+                        }
+                    }
+                }
+                if (computeQueue < 0) {
+                    computeQueue = static_cast<int32_t>(nextComputeQueue++ % computeQueueCount); // more independent passes than compute queues
+                }
+                queueLevels[computeQueue] = std::max(queueLevels[computeQueue], level);
+                pass.m_lane = getComputeLane(computeQueue);
+            }
+        }
+
+        // a queue of the family to release buffers owned from a previous execution
+        Queues::Queue findQueue(uint32_t family) {
+            for (const auto queue: {Queues::COMPUTE, Queues::TRANSFER, Queues::ASYNC_TRANSFER, Queues::GRAPHICS}) {
+                if (m_gpuContext->m_queues->getQueue(queue) != VK_NULL_HANDLE && getFamily(queue) == family) {
+                    return queue;
+                }
+            }
+            throw std::runtime_error("Failed to find a queue of the family owning a buffer!");
+        }
+
+        void compile() {
+            m_batches.clear();
+            assignLanes();
+            const uint32_t laneCount = getLaneCount();
+            std::map<Buffer *, BufferState> states;
+
+            for (uint32_t p = 0; p < m_passes.size(); p++) {
+                const GraphPass &pass = m_passes[p];
+                const uint32_t family = getFamily(pass.m_lane);
+
+                // buffers accessed by the pass once, read and written ones with both flags
+                struct Access {
+                    Buffer *m_buffer;
+                    bool m_read;
+                    bool m_write;
+                };
+                std::vector<Access> accesses;
+                for (Buffer *buffer: pass.m_writes) {
+                    accesses.push_back({buffer, reads(p, buffer), true});
+                }
+                for (Buffer *buffer: pass.m_reads) {
+                    if (!writes(p, buffer)) {
+                        accesses.push_back({buffer, true, false});
+                    }
+                }
+
+                // dependencies on other queues and queue family ownership transfers
+                std::vector<int32_t> waitBatches(laneCount, -1);
+                std::vector<Barrier> acquires;
+                for (const auto &[buffer, read, write]: accesses) {
+                    BufferState &state = states[buffer];
+                    std::vector<uint32_t> dependencies;
+                    if (state.m_lastWriter >= 0) {
+                        dependencies.push_back(state.m_lastWriter);
+                    }
+                    if (write) {
+                        dependencies.insert(dependencies.end(), state.m_readers.begin(), state.m_readers.end());
+                    }
+
+                    auto owner = m_bufferOwners.find(buffer);
+                    if (owner != m_bufferOwners.end() && owner->second != family) {
+                        // release at the end of the last batch accessing it (or in a batch of its own if owned since the previous execution)
+                        int32_t releaseBatch = state.m_lastBatch;
+                        VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                        VkAccessFlags srcAccess = 0;
+                        if (releaseBatch < 0) {
+                            releaseBatch = static_cast<int32_t>(addBatch(findQueue(owner->second), false));
+                        } else {
+                            srcStage = m_passes[state.m_lastPass].m_stage;
+                            srcAccess = getAccess(srcStage, false, writes(state.m_lastPass, buffer));
+                        }
+                        m_batches[releaseBatch].m_open = false;
+                        m_batches[releaseBatch].m_endBarriers.push_back({buffer, srcStage, srcAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, owner->second, family});
+                        const uint32_t releaseQueue = m_batches[releaseBatch].m_lane;
+                        waitBatches[releaseQueue] = std::max(waitBatches[releaseQueue], releaseBatch);
+                        acquires.push_back({buffer, pass.m_stage, 0, pass.m_stage, getAccess(pass.m_stage, read, write), owner->second, family});
+                        owner->second = family;
+                    } else {
+                        m_bufferOwners[buffer] = family;
+                    }
+
+                    for (const uint32_t dependency: dependencies) {
+                        const uint32_t dependencyQueue = m_passes[dependency].m_lane;
+                        if (dependencyQueue != pass.m_lane) {
+                            waitBatches[dependencyQueue] = std::max(waitBatches[dependencyQueue], state.m_lastBatch >= 0 && m_batches[state.m_lastBatch].m_lane == dependencyQueue ? state.m_lastBatch : getLastBatch(dependencyQueue));
+                        }
+                    }
+                }
+
+                // batches waited for are closed (they signal at their end), a batch of this queue is split if the wait is new
+                for (uint32_t queue = 0; queue < waitBatches.size(); queue++) {
+                    if (waitBatches[queue] >= 0) {
+                        m_batches[waitBatches[queue]].m_open = false;
+                    }
+                }
+                const int32_t openBatch = getLastBatch(pass.m_lane);
+                if (openBatch >= 0 && m_batches[openBatch].m_open) {
+                    for (uint32_t queue = 0; queue < waitBatches.size(); queue++) {
+                        if (waitBatches[queue] > m_batches[openBatch].m_waitBatches[queue]) {
+                            m_batches[openBatch].m_open = false;
+                        }
+                    }
+                }
+                const uint32_t batchIndex = getOpenBatch(pass.m_lane);
+                Batch &batch = m_batches[batchIndex];
+                for (uint32_t queue = 0; queue < waitBatches.size(); queue++) {
+                    batch.m_waitBatches[queue] = std::max(batch.m_waitBatches[queue], waitBatches[queue]);
+                }
+
+                // barriers to earlier passes of the same queue (earlier batches of the queue are earlier in submission order)
+                std::vector<Barrier> barriers = acquires;
+                for (const auto &[buffer, read, write]: accesses) {
+                    BufferState &state = states[buffer];
+                    auto addBarrier = [&](uint32_t dependency, bool dependencyWrites) {
+                        if (m_passes[dependency].m_lane != pass.m_lane) {
+                            return;
+                        }
+                        const VkPipelineStageFlags srcStage = m_passes[dependency].m_stage;
+                        barriers.push_back({buffer, srcStage, getAccess(srcStage, false, dependencyWrites), pass.m_stage, getAccess(pass.m_stage, read, write)});
+                    };
+                    const bool acquired = std::any_of(acquires.begin(), acquires.end(), [&](const Barrier &acquire) { return acquire.m_buffer == buffer; });
+                    if (!acquired) {
+                        if (state.m_lastWriter >= 0) {
+                            addBarrier(state.m_lastWriter, true);
+                        }
+                        if (write) {
+                            for (const uint32_t reader: state.m_readers) {
+                                addBarrier(reader, false); // write after read: execution dependency only
+                            }
+                        }
+                    }
+
+                    if (write) {
+                        state.m_lastWriter = static_cast<int32_t>(p);
+                        state.m_lastWriterBatch = static_cast<int32_t>(batchIndex);
+                        state.m_readers.clear();
+                    } else {
+                        state.m_readers.push_back(p);
+                    }
+                    state.m_lastBatch = static_cast<int32_t>(batchIndex);
+                    state.m_lastPass = static_cast<int32_t>(p);
+                }
+
+                batch.m_passes.push_back(p);
+                batch.m_barriers.push_back(barriers);
+            }
+
+            // host reads after the last write
+            for (Buffer *buffer: m_hostReads) {
+                const BufferState &state = states[buffer];
+                if (state.m_lastWriter < 0) {
+                    continue;
+                }
+                const VkPipelineStageFlags srcStage = m_passes[state.m_lastWriter].m_stage;
+                m_batches[state.m_lastWriterBatch].m_endBarriers.push_back({buffer, srcStage, getAccess(srcStage, false, true), VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT});
+            }
+        }
+
+        VkCommandBuffer allocateCommandBuffer(uint32_t family) {
+            auto it = m_commandPools.find(family);
+            if (it == m_commandPools.end()) {
+                VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, .queueFamilyIndex = family};
+                VkCommandPool commandPool;
+                if (vkCreateCommandPool(m_gpuContext->m_device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create command pool!");
+                }
+                it = m_commandPools.emplace(family, commandPool).first;
+            }
+            VkCommandBufferAllocateInfo allocInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, .commandPool = it->second, .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, .commandBufferCount = 1};
+            VkCommandBuffer commandBuffer;
+            if (vkAllocateCommandBuffers(m_gpuContext->m_device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate command buffer!");
+            }
+            return commandBuffer; // freed by the reset of the pool in the next execution
+        }
+
+        // one vkCmdPipelineBarrier per pair of stage masks
+        static void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier> &barriers) {
+            std::map<std::pair<VkPipelineStageFlags, VkPipelineStageFlags>, std::vector<VkBufferMemoryBarrier>> bufferBarriers;
+            for (const auto &barrier: barriers) {
+                bufferBarriers[{barrier.m_srcStage, barrier.m_dstStage}].push_back({.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, .srcAccessMask = barrier.m_srcAccess, .dstAccessMask = barrier.m_dstAccess, .srcQueueFamilyIndex = barrier.m_srcFamily, .dstQueueFamilyIndex = barrier.m_dstFamily, .buffer = barrier.m_buffer->getBuffer(), .offset = 0, .size = VK_WHOLE_SIZE});
+            }
+            for (const auto &[stages, stageBarriers]: bufferBarriers) {
+                vkCmdPipelineBarrier(commandBuffer, stages.first, stages.second, {}, 0, nullptr, static_cast<uint32_t>(stageBarriers.size()), stageBarriers.data(), 0, nullptr);
+            }
+        }
+
+        void recordBatch(const Batch &batch, VkCommandBuffer commandBuffer) {
+            VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording command buffer!");
+            }
+            for (uint32_t i = 0; i < batch.m_passes.size(); i++) {
+                recordBarriers(commandBuffer, batch.m_barriers[i]);
+                m_passes[batch.m_passes[i]].m_record(commandBuffer);
+            }
+            recordBarriers(commandBuffer, batch.m_endBarriers);
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record command buffer!");
+            }
+        }
+    };
+} // namespace engine
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace engine {
+    /**
+     * Parallel generator of sort keys with deterministic, realistic distributions.
+     * Every key is a pure function of (seed, index): the random numbers come from a counter based generator (splitmix64 finalizer of
+     * the element index and a per stream key), so any range of the sequence can be generated independently by any number of threads,
+     * e.g. batch by batch directly into mapped staging memory, and always yields the same keys.
+     */
+    class KeyGenerator {
+    public:
+        enum class Distribution {
+            UNIFORM,        // uniform over the m_keyBits least significant bits (full width for 32 / 64 key bits)
+            SORTED,         // ascending, spread over the key range
+            REVERSE_SORTED, // descending
+            NEARLY_SORTED,  // ascending with m_unsortedFraction of the keys replaced by random keys
+            ALL_EQUAL,      // a single random key
+            FEW_UNIQUE,     // m_numUniqueKeys random keys
+            ZIPF,           // m_zipfNumKeys random keys, the key of rank r is drawn with probability ~ 1 / r^m_zipfExponent
+            MORTON,         // morton codes of clustered 3d points (m_keyBits / 3 bits per axis)
+        };
+
+        struct Settings {
+            Distribution m_distribution = Distribution::UNIFORM;
+            uint64_t m_seed = 42;
+            uint32_t m_keyBits = 32; // significant bits of the keys
+            double m_unsortedFraction = 0.01;
+            uint32_t m_numUniqueKeys = 16;
+            uint32_t m_zipfNumKeys = 1 << 16;
+            double m_zipfExponent = 1.0;
+            uint32_t m_numClusters = 32;   // morton codes
+            double m_clusterRadius = 0.05; // relative to the unit cube
+            uint32_t m_numThreads = 0;     // 0: hardware concurrency
+        };
+
+        // numElements: length of the sequence, the sorted distributions are spread over it
+        KeyGenerator(const Settings &settings, uint64_t numElements) : m_settings(settings), m_numElements(numElements) {
+            if (m_settings.m_keyBits == 0 || m_settings.m_keyBits > 64) {
+                throw std::invalid_argument("Invalid key width " + std::to_string(m_settings.m_keyBits) + "!");
+            }
+            m_mask = m_settings.m_keyBits == 64 ? UINT64_MAX : (uint64_t(1) << m_settings.m_keyBits) - 1;
+            m_numUniqueKeys = std::max(1U, m_settings.m_numUniqueKeys);
+
+            if (m_settings.m_distribution == Distribution::ZIPF) {
+                // cumulative distribution of the ranks, sampled by binary search
+                m_zipfCdf.resize(std::max(1U, m_settings.m_zipfNumKeys));
+                double sum = 0.0;
+                for (uint32_t rank = 0; rank < m_zipfCdf.size(); rank++) {
+                    sum += 1.0 / std::pow(static_cast<double>(rank + 1), m_settings.m_zipfExponent);
+                    m_zipfCdf[rank] = sum;
+                }
+                for (auto &value: m_zipfCdf) {
+                    value /= sum;
+                }
+            }
+            if (m_settings.m_distribution == Distribution::MORTON) {
+                m_bitsPerAxis = std::min(21U, m_settings.m_keyBits / 3);
+                if (m_bitsPerAxis == 0) {
+                    throw std::invalid_argument("Morton codes require at least 3 key bits!");
+                }
+            }
+        }
+
+        // keys [firstIndex, firstIndex + keys.size()) of the sequence, in parallel for large ranges
+        template<typename T>
+        void generate(std::span<T> keys, uint64_t firstIndex = 0) const {
+            generate(keys.data(), keys.size(), firstIndex);
+        }
+
+        template<typename T>
+        void generate(T *keys, uint64_t count, uint64_t firstIndex = 0) const {
+            if (m_settings.m_keyBits > sizeof(T) * 8) {
+                throw std::invalid_argument("Key width " + std::to_string(m_settings.m_keyBits) + " exceeds the key type!");
+            }
+            const uint32_t numThreads = count < MIN_ELEMENTS_PER_THREAD ? 1 : std::max(1U, m_settings.m_numThreads > 0 ? m_settings.m_numThreads : std::thread::hardware_concurrency());
+            const uint64_t elementsPerThread = (count + numThreads - 1) / numThreads;
+            if (numThreads == 1) {
+                generateRange(keys, 0, count, firstIndex);
+                return;
+            }
+            std::vector<std::thread> threads;
+            for (uint64_t first = 0; first < count; first += elementsPerThread) {
+                const uint64_t last = std::min(count, first + elementsPerThread);
+                threads.emplace_back([this, keys, first, last, firstIndex]() { generateRange(keys, first, last, firstIndex); });
+            }
+            for (auto &thread: threads) {
+                thread.join();
+            }
+        }
+
+        // key at index of the sequence
+        [[nodiscard]] uint64_t getKey(uint64_t index) const {
+            switch (m_settings.m_distribution) {
+                case Distribution::UNIFORM:
+                    return random(index, STREAM_KEYS) & m_mask;
+                case Distribution::SORTED:
+                    return getSortedKey(index);
+                case Distribution::REVERSE_SORTED:
+                    return getSortedKey(m_numElements > index ? m_numElements - 1 - index : 0);
+                case Distribution::NEARLY_SORTED:
+                    if (getUniform(index, STREAM_SELECTION) < m_settings.m_unsortedFraction) {
+                        return random(index, STREAM_KEYS) & m_mask;
+                    }
+                    return getSortedKey(index);
+                case Distribution::ALL_EQUAL:
+                    return random(0, STREAM_VALUES) & m_mask;
+                case Distribution::FEW_UNIQUE:
+                    return random(random(index, STREAM_SELECTION) % m_numUniqueKeys, STREAM_VALUES) & m_mask;
+                case Distribution::ZIPF: {
+                    const double u = getUniform(index, STREAM_SELECTION);
+                    const uint64_t rank = std::min<uint64_t>(std::lower_bound(m_zipfCdf.begin(), m_zipfCdf.end(), u) - m_zipfCdf.begin(), m_zipfCdf.size() - 1);
+                    return random(rank, STREAM_VALUES) & m_mask;
+                }
+                case Distribution::MORTON:
+                    return getMortonKey(index);
+            }
+            return 0;
+        }
+
+        // counter based random number: the splitmix64 finalizer of the counter in the stream of the seed
+        [[nodiscard]] uint64_t random(uint64_t counter, uint64_t stream) const {
+            return mix(mix(m_settings.m_seed ^ (stream * 0xD1B54A32D192ED03ULL)) + (counter + 1) * 0x9E3779B97F4A7C15ULL);
+        }
+
+        static std::string getDistributionName(Distribution distribution) {
+            switch (distribution) {
+                case Distribution::UNIFORM:
+                    return "uniform";
+                case Distribution::SORTED:
+                    return "sorted";
+                case Distribution::REVERSE_SORTED:
+                    return "reverse-sorted";
+                case Distribution::NEARLY_SORTED:
+                    return "nearly-sorted";
+                case Distribution::ALL_EQUAL:
+                    return "all-equal";
+                case Distribution::FEW_UNIQUE:
+                    return "few-unique";
+                case Distribution::ZIPF:
+                    return "zipf";
+                case Distribution::MORTON:
+                    return "morton";
+            }
+            return "unknown";
+        }
+
+        static Distribution parseDistribution(const std::string &name) {
+            for (const Distribution distribution: ALL_DISTRIBUTIONS) {
+                if (getDistributionName(distribution) == name) {
+                    return distribution;
+                }
+            }
+            throw std::invalid_argument("Unknown key distribution " + name + "!");
+        }
+
+        static constexpr Distribution ALL_DISTRIBUTIONS[] = {Distribution::UNIFORM, Distribution::SORTED, Distribution::REVERSE_SORTED, Distribution::NEARLY_SORTED,
+                                                             Distribution::ALL_EQUAL, Distribution::FEW_UNIQUE, Distribution::ZIPF, Distribution::MORTON};
+
+    private:
+        Settings m_settings;
+        uint64_t m_numElements;
+        uint64_t m_mask;
+        uint32_t m_numUniqueKeys;
+        uint32_t m_bitsPerAxis = 0;
+        std::vector<double> m_zipfCdf;
+
+        // independent random streams per element
+        static const uint64_t STREAM_KEYS = 0;
+        static const uint64_t STREAM_SELECTION = 1;
+        static const uint64_t STREAM_VALUES = 2; // indexed by value (unique key, cluster) instead of element
+        static const uint64_t STREAM_POSITION = 3;
+
+        static const uint64_t MIN_ELEMENTS_PER_THREAD = 1 << 16;
+
+        template<typename T>
+        void generateRange(T *keys, uint64_t first, uint64_t last, uint64_t firstIndex) const {
+            for (uint64_t i = first; i < last; i++) {
+                keys[i] = static_cast<T>(getKey(firstIndex + i));
+            }
+        }
+
+        static uint64_t mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // uniform in [0, 1) from the 53 most significant bits
+        [[nodiscard]] double getUniform(uint64_t counter, uint64_t stream) const {
+            return static_cast<double>(random(counter, stream) >> 11) * 0x1.0p-53;
+        }
+
+        // monotonic in index, spread evenly over [0, mask]
+        [[nodiscard]] uint64_t getSortedKey(uint64_t index) const {
+            if (m_numElements <= 1) {
+                return 0;
+            }
+            const long double position = static_cast<long double>(std::min(index, m_numElements - 1)) / static_cast<long double>(m_numElements - 1);
+            return std::min(m_mask, static_cast<uint64_t>(position * static_cast<long double>(m_mask)));
+        }
+
+        [[nodiscard]] uint64_t getMortonKey(uint64_t index) const {
+            const uint64_t cluster = random(index, STREAM_SELECTION) % std::max(1U, m_settings.m_numClusters);
+            const uint64_t axisMax = (uint64_t(1) << m_bitsPerAxis) - 1;
+            uint64_t key = 0;
+            for (uint32_t axis = 0; axis < 3; axis++) {
+                // cluster center plus a triangular offset (sum of two uniforms), clamped to the unit cube
+                const double center = getUniform(cluster * 3 + axis, STREAM_VALUES);
+                const double offset = (getUniform(index * 3 + axis, STREAM_POSITION) + getUniform(index * 3 + axis, STREAM_KEYS) - 1.0) * m_settings.m_clusterRadius;
+                const double position = std::clamp(center + offset, 0.0, 1.0);
+                const uint64_t quantized = std::min(axisMax, static_cast<uint64_t>(position * static_cast<double>(axisMax + 1)));
+                for (uint32_t bit = 0; bit < m_bitsPerAxis; bit++) {
+                    key |= ((quantized >> bit) & 1) << (bit * 3 + axis);
+                }
+            }
+            return key;
+        }
+    };
+} // namespace engine
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace engine {
+    /**
+     * File mapped into the address space (POSIX mmap), the pages are read / written back by the kernel on demand.
+     */
+    class MappedFile {
+    public:
+        // maps an existing file read only
+        explicit MappedFile(const std::string &path) : m_path(path) {
+            m_fd = open(path.c_str(), O_RDONLY);
+            if (m_fd < 0) {
+                throw std::runtime_error("Failed to open file " + path + "!");
+            }
+            const off_t size = lseek(m_fd, 0, SEEK_END);
+            if (size < 0) {
+                release();
+                throw std::runtime_error("Failed to determine the size of file " + path + "!");
+            }
+            m_sizeBytes = static_cast<uint64_t>(size);
+            map(PROT_READ);
+        }
+
+        // creates (or truncates) a file of sizeBytes bytes and maps it read write
+        MappedFile(const std::string &path, uint64_t sizeBytes) : m_path(path), m_sizeBytes(sizeBytes) {
+            m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (m_fd < 0) {
+                throw std::runtime_error("Failed to create file " + path + "!");
+            }
+            if (ftruncate(m_fd, static_cast<off_t>(sizeBytes)) != 0) {
+                release();
+                throw std::runtime_error("Failed to resize file " + path + "!");
+            }
+            map(PROT_READ | PROT_WRITE);
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+            release();
+        }
+
+        void release() {
+            if (m_data) {
+                munmap(m_data, m_sizeBytes);
+            }
+            if (m_fd >= 0) {
+                close(m_fd);
+            }
+            m_data = nullptr;
+            m_fd = -1;
+        }
+
+        // access pattern hint for the kernel's read ahead (e.g. MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED)
+        void advise(int advice) const {
+            if (m_data) {
+                madvise(m_data, m_sizeBytes, advice);
+            }
+        }
+
+        [[nodiscard]] void *getData() const {
+            return m_data;
+        }
+
+        [[nodiscard]] uint64_t getSizeBytes() const {
+            return m_sizeBytes;
+        }
+
+        [[nodiscard]] const std::string &getPath() const {
+            return m_path;
+        }
+
+    private:
+        std::string m_path;
+        uint64_t m_sizeBytes = 0;
+
+        int m_fd = -1;
+        void *m_data = nullptr;
+
+        void map(int protection) {
+            if (m_sizeBytes == 0) {
+                return; // empty files cannot be mapped
+            }
+            void *data = mmap(nullptr, m_sizeBytes, protection, MAP_SHARED, m_fd, 0);
+            if (data == MAP_FAILED) {
+                release();
+                throw std::runtime_error("Failed to map file " + m_path + "!");
+            }
+            m_data = data;
+        }
+    };
+} // namespace engine
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine {
+    /**
+     * Fixed set of worker threads for fork-join loops, avoids creating threads for every parallel step of an algorithm.
+     * parallelFor runs the tasks on the workers and the calling thread and returns when all tasks have finished,
+     * calls from multiple threads are serialized.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency())) : m_numThreads(std::max(1U, numThreads)) {
+            // the calling thread is one of the numThreads threads
+            for (uint32_t i = 1; i < m_numThreads; i++) {
+                m_workers.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wakeCondition.notify_all();
+            for (auto &worker: m_workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        [[nodiscard]] uint32_t getNumThreads() const {
+            return m_numThreads;
+        }
+
+        // calls task(i) for every i in [0, numTasks), the first exception thrown by a task is rethrown
+        void parallelFor(uint32_t numTasks, const std::function<void(uint32_t)> &task) {
+            if (numTasks == 0) {
+                return;
+            }
+            std::lock_guard<std::mutex> submitLock(m_submitMutex);
+            if (m_workers.empty() || numTasks == 1) {
+                for (uint32_t i = 0; i < numTasks; i++) {
+                    task(i);
+                }
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_task = &task;
+                m_numTasks = numTasks;
+                m_nextTask = 0;
+                m_activeWorkers = static_cast<uint32_t>(m_workers.size());
+                m_exception = nullptr;
+                m_generation++;
+            }
+            m_wakeCondition.notify_all();
+
+            runTasks();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_doneCondition.wait(lock, [this]() { return m_activeWorkers == 0; });
+            m_task = nullptr;
+            if (m_exception) {
+                std::rethrow_exception(m_exception);
+            }
+        }
+
+    private:
+        uint32_t m_numThreads;
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_submitMutex;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCondition;
+        std::condition_variable m_doneCondition;
+
+        const std::function<void(uint32_t)> *m_task = nullptr;
+        uint32_t m_numTasks = 0;
+        std::atomic<uint32_t> m_nextTask = 0;
+        uint32_t m_activeWorkers = 0;
+        uint64_t m_generation = 0;
+        std::exception_ptr m_exception;
+        bool m_stop = false;
+
+        void runTasks() {
+            for (uint32_t i = m_nextTask++; i < m_numTasks; i = m_nextTask++) {
+                try {
+                    (*m_task)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_exception) {
+                        m_exception = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        void workerLoop() {
+            uint64_t generation = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wakeCondition.wait(lock, [&]() { return m_stop || m_generation != generation; });
+                    if (m_stop) {
+                        return;
+                    }
+                    generation = m_generation;
+                }
+                runTasks();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_activeWorkers--;
+                }
+                m_doneCondition.notify_one();
+            }
+        }
+    };
+} // namespace engine
@@ -1,7 +1,17 @@
 #include "engine/core/GPUContext.h"
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
 namespace engine {
     GPUContext::GPUContext(uint32_t requiredQueueFamilies) : m_queues(std::make_shared<Queues>(requiredQueueFamilies)) {
+        if (const char *selection = std::getenv("ENGINE_DEVICE")) {
+            m_deviceSelection = DeviceSelection::parse(selection);
+        }
     }
 
     void GPUContext::init() {
@@ -16,14 +26,28 @@ namespace engine {
         createInstance();
         setupDebugMessenger();
         pickPhysicalDevice();
+        detectMemoryHeaps();
         createLogicalDevice();
         m_queues->createQueues(m_device, m_physicalDevice);
         createCommandPool();
         createCommandBuffers();
+        createPipelineCache();
     }
 
     void GPUContext::releaseVulkan() {
+        savePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        m_pipelineCache = VK_NULL_HANDLE;
         vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(m_threadCommandPools->m_mutex);
+            for (const VkCommandPool commandPool: m_threadCommandPools->m_commandPools) {
+                vkDestroyCommandPool(m_device, commandPool, nullptr);
+            }
+            m_threadCommandPools->m_commandPools.clear();
+            m_threadCommandPools->m_device = VK_NULL_HANDLE;
+        }
+        m_threadCommandPools.reset();
         vkDestroyDevice(m_device, nullptr);
         if (enableValidationLayers) {
             DestroyDebugUtilsMessengerEXT(m_instance, m_debugMessenger, nullptr);
@@ -149,57 +173,187 @@ namespace engine {
         }
     }
 
-    void GPUContext::pickPhysicalDevice() {
-        uint32_t deviceCount = 0;
-        vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
-        if (deviceCount == 0) {
-            throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+    GPUContext::DeviceSelection GPUContext::DeviceSelection::parse(const std::string &selection) {
+        DeviceSelection deviceSelection;
+        std::string hexDigits = selection;
+        hexDigits.erase(std::remove(hexDigits.begin(), hexDigits.end(), '-'), hexDigits.end());
+        if (selection.empty() || selection == "best") {
+            deviceSelection.m_policy = Policy::BEST;
+        } else if (std::all_of(selection.begin(), selection.end(), [](unsigned char c) { return std::isdigit(c); }) && selection.size() < 10) {
+            deviceSelection.m_policy = Policy::INDEX;
+            deviceSelection.m_index = static_cast<uint32_t>(std::stoul(selection));
+        } else if (hexDigits.size() == 2 * VK_UUID_SIZE && std::all_of(hexDigits.begin(), hexDigits.end(), [](unsigned char c) { return std::isxdigit(c); })) {
+            deviceSelection.m_policy = Policy::UUID;
+            deviceSelection.m_uuid = hexDigits;
+        } else {
+            deviceSelection.m_policy = Policy::NAME;
+            deviceSelection.m_nameRegex = selection;
         }
+        return deviceSelection;
+    }
+
+    std::vector<std::pair<GPUContext::DeviceInfo, VkPhysicalDevice>> GPUContext::querySuitableDevices(VkInstance instance, const Queues &queues) {
+        uint32_t deviceCount = 0;
+        vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
         std::vector<VkPhysicalDevice> devices(deviceCount);
-        vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
-        std::cout << "Available devices: (" << deviceCount << ")" << std::endl;
+        vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+        std::vector<std::pair<DeviceInfo, VkPhysicalDevice>> suitableDevices;
         for (uint32_t i = 0; i < deviceCount; i++) {
-            const auto &device = devices[i];
-            VkPhysicalDeviceProperties deviceProperties;
-            vkGetPhysicalDeviceProperties(device, &deviceProperties);
-            std::cout << "[" << i << "] " << deviceProperties.deviceName << std::endl;
-        }
-        std::cout << "Enter the number of the device... ";
-        std::string s;
-        if (deviceCount == 1) {
-            s = "0";
-            std::cout << s << std::endl;
-        } else {
-            std::cin >> s;
-        }
-        int i;
-        try {
-            i = std::stoi(s);
-        } catch (std::invalid_argument const &ex) {
-            std::cout << ex.what() << std::endl;
-        } catch (std::out_of_range const &ex) {
-            std::cout << ex.what() << std::endl;
-        }
-        if (i >= 0 && i < deviceCount) {
-            m_physicalDevice = devices[i];
-        } else {
-            std::cout << "Out of range." << std::endl;
+            VkPhysicalDeviceIDProperties idProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+            VkPhysicalDeviceSubgroupProperties subgroupProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES, .pNext = &idProperties};
+            VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &subgroupProperties};
+            vkGetPhysicalDeviceProperties2(devices[i], &properties);
+            if (properties.properties.apiVersion < VK_API_VERSION_1_3 || !queues.findQueueFamilies(devices[i]).isComplete(queues.getRequiredQueueFamilies())) {
+                continue;
+            }
+
+            DeviceInfo info{.m_index = i, .m_name = properties.properties.deviceName, .m_type = properties.properties.deviceType, .m_subgroupSize = subgroupProperties.subgroupSize};
+            std::stringstream uuid;
+            for (uint8_t byte: idProperties.deviceUUID) {
+                uuid << std::hex << std::setw(2) << std::setfill('0') << static_cast<uint32_t>(byte);
+            }
+            info.m_uuid = uuid.str();
+            VkPhysicalDeviceMemoryProperties memoryProperties;
+            vkGetPhysicalDeviceMemoryProperties(devices[i], &memoryProperties);
+            for (uint32_t heap = 0; heap < memoryProperties.memoryHeapCount; heap++) {
+                if (memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                    info.m_deviceLocalMemory = std::max(info.m_deviceLocalMemory, memoryProperties.memoryHeaps[heap].size);
+                }
+            }
+            double typeScore = 0.0;
+            switch (info.m_type) {
+                case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                    typeScore = 4.0;
+                    break;
+                case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                    typeScore = 3.0;
+                    break;
+                case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                    typeScore = 2.0;
+                    break;
+                case VK_PHYSICAL_DEVICE_TYPE_CPU:
+                    typeScore = 1.0;
+                    break;
+                default:
+                    break;
+            }
+            // the type dominates the memory (MiB), the memory dominates the subgroup size
+            info.m_score = typeScore * 1e12 + static_cast<double>(info.m_deviceLocalMemory >> 20) * 1e3 + info.m_subgroupSize;
+            suitableDevices.emplace_back(info, devices[i]);
+        }
+        return suitableDevices;
+    }
+
+    std::vector<GPUContext::DeviceInfo> GPUContext::enumerateDevices(uint32_t requiredQueueFamilies) {
+        VkApplicationInfo applicationInfo{.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO, .apiVersion = VK_API_VERSION_1_3};
+        VkInstanceCreateInfo instanceCreateInfo{.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO, .pApplicationInfo = &applicationInfo};
+        VkInstance instance;
+        if (vkCreateInstance(&instanceCreateInfo, nullptr, &instance) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create instance!");
+        }
+        std::vector<DeviceInfo> devices;
+        for (const auto &[info, physicalDevice]: querySuitableDevices(instance, Queues(requiredQueueFamilies))) {
+            devices.push_back(info);
+        }
+        vkDestroyInstance(instance, nullptr);
+        return devices;
+    }
+
+    void GPUContext::pickPhysicalDevice() {
+        const auto devices = querySuitableDevices(m_instance, *m_queues);
+        if (devices.empty()) {
+            throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+        }
+        std::cout << "Available devices: (" << devices.size() << ")" << std::endl;
+        for (const auto &[info, physicalDevice]: devices) {
+            std::cout << "[" << info.m_index << "] " << info.m_name << " (" << info.m_uuid << ")" << std::endl;
+        }
+
+        const std::pair<DeviceInfo, VkPhysicalDevice> *selected = nullptr;
+        switch (m_deviceSelection.m_policy) {
+            case DeviceSelection::Policy::BEST:
+                selected = &*std::max_element(devices.begin(), devices.end(), [](const auto &a, const auto &b) { return a.first.m_score < b.first.m_score; });
+                break;
+            case DeviceSelection::Policy::INDEX:
+                for (const auto &device: devices) {
+                    if (device.first.m_index == m_deviceSelection.m_index) {
+                        selected = &device;
+                    }
+                }
+                break;
+            case DeviceSelection::Policy::UUID: {
+                std::string uuid = m_deviceSelection.m_uuid;
+                uuid.erase(std::remove(uuid.begin(), uuid.end(), '-'), uuid.end());
+                std::transform(uuid.begin(), uuid.end(), uuid.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                for (const auto &device: devices) {
+                    if (device.first.m_uuid == uuid) {
+                        selected = &device;
+                    }
+                }
+                break;
+            }
+            case DeviceSelection::Policy::NAME: {
+                const std::regex name(m_deviceSelection.m_nameRegex, std::regex::ECMAScript | std::regex::icase);
+                for (const auto &device: devices) {
+                    if (selected == nullptr && std::regex_search(device.first.m_name, name)) {
+                        selected = &device;
+                    }
+                }
+                break;
+            }
         }
-        if (m_physicalDevice == VK_NULL_HANDLE) {
+        if (selected == nullptr) {
             throw std::runtime_error("Failed to find a suitable GPU!");
         }
+        m_physicalDevice = selected->second;
+        m_deviceInfo = selected->first;
+        std::cout << "Selected device [" << m_deviceInfo.m_index << "] " << m_deviceInfo.m_name << "." << std::endl;
+    }
+
+    void GPUContext::detectMemoryHeaps() {
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memoryProperties);
 
-        VkPhysicalDeviceVulkan12Features v12Features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
-        VkPhysicalDeviceFeatures2 deviceFeatures{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &v12Features};
-        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &deviceFeatures);
+        const VkMemoryPropertyFlags mappedDeviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VkDeviceSize deviceLocalHeapSize = 0;
+        m_hostVisibleDeviceLocalHeapSize = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+            if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                deviceLocalHeapSize = std::max(deviceLocalHeapSize, memoryProperties.memoryHeaps[i].size);
+            }
+        }
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            const auto &memoryType = memoryProperties.memoryTypes[i];
+            if ((memoryType.propertyFlags & mappedDeviceLocal) == mappedDeviceLocal) {
+                m_hostVisibleDeviceLocalHeapSize = std::max(m_hostVisibleDeviceLocalHeapSize, memoryProperties.memoryHeaps[memoryType.heapIndex].size);
+            }
+        }
+        // integrated gpus, cpu implementations and discrete gpus with resizable BAR: the whole device local heap can be mapped
+        m_unifiedMemory = m_hostVisibleDeviceLocalHeapSize > 0 && m_hostVisibleDeviceLocalHeapSize == deviceLocalHeapSize;
     }
 
     void GPUContext::createLogicalDevice() {
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        float queuePriority = 1.0f;
-        m_queues->generateQueueCreateInfos(m_physicalDevice, &queueCreateInfos, &queuePriority);
+        std::array<float, Queues::MAX_COMPUTE_QUEUES> queuePriorities; // the first queue of a family (COMPUTE) has the highest priority
+        queuePriorities.fill(0.5f);
+        queuePriorities[0] = 1.0f;
+        m_queues->generateQueueCreateInfos(m_physicalDevice, &queueCreateInfos, queuePriorities.data());
 
         std::vector<const char *> deviceExtensions = getDeviceExtensions();
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+        for (const char *extension: getOptionalDeviceExtensions()) {
+            for (const auto &extensionProperties: availableExtensions) {
+                if (strcmp(extension, extensionProperties.extensionName) == 0) {
+                    deviceExtensions.push_back(extension);
+                    break;
+                }
+            }
+        }
+        m_enabledDeviceExtensions = std::set<std::string>(deviceExtensions.begin(), deviceExtensions.end());
 
         VkPhysicalDeviceFeatures2 features2{
                 VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
@@ -238,6 +392,74 @@ namespace engine {
         return {};
     }
 
+    std::vector<const char *> GPUContext::getOptionalDeviceExtensions() {
+        return {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME, VK_NV_SHADER_SM_BUILTINS_EXTENSION_NAME, VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME};
+    }
+
+    uint32_t GPUContext::getSubgroupSize() const {
+        VkPhysicalDeviceSubgroupProperties subgroupProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+        VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &subgroupProperties};
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+        return subgroupProperties.subgroupSize;
+    }
+
+    uint32_t GPUContext::getComputeUnitCount() const {
+        if (isDeviceExtensionEnabled(VK_NV_SHADER_SM_BUILTINS_EXTENSION_NAME)) {
+            VkPhysicalDeviceShaderSMBuiltinsPropertiesNV smBuiltinsProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SM_BUILTINS_PROPERTIES_NV};
+            VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &smBuiltinsProperties};
+            vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+            return smBuiltinsProperties.shaderSMCount;
+        }
+        if (isDeviceExtensionEnabled(VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME)) {
+            VkPhysicalDeviceShaderCorePropertiesAMD shaderCoreProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD};
+            VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &shaderCoreProperties};
+            vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+            return shaderCoreProperties.shaderEngineCount * shaderCoreProperties.shaderArraysPerEngineCount * shaderCoreProperties.computeUnitsPerShaderArray;
+        }
+        return 0;
+    }
+
+    bool GPUContext::supportsLargeBuffers() const {
+        VkPhysicalDeviceVulkan12Features features12{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+        VkPhysicalDeviceFeatures2 features2{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &features12};
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+        return features2.features.shaderInt64 && features12.shaderSubgroupExtendedTypes && features12.bufferDeviceAddress;
+    }
+
+    VkDeviceSize GPUContext::getMinImportedHostPointerAlignment() const {
+        if (!isDeviceExtensionEnabled(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) {
+            return 0;
+        }
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT externalMemoryHostProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT};
+        VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &externalMemoryHostProperties};
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+        return externalMemoryHostProperties.minImportedHostPointerAlignment;
+    }
+
+    VkDeviceSize GPUContext::getDeviceLocalMemoryBudget() const {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT};
+        VkPhysicalDeviceMemoryProperties2 memoryProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2};
+        const bool budgetSupported = isDeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (budgetSupported) {
+            memoryProperties.pNext = &budgetProperties;
+        }
+        vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memoryProperties);
+
+        VkDeviceSize budget = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; i++) {
+            const auto &heap = memoryProperties.memoryProperties.memoryHeaps[i];
+            if (!(heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) {
+                continue;
+            }
+            VkDeviceSize available = heap.size;
+            if (budgetSupported) {
+                available = budgetProperties.heapBudget[i] > budgetProperties.heapUsage[i] ? budgetProperties.heapBudget[i] - budgetProperties.heapUsage[i] : 0;
+            }
+            budget = std::max(budget, available);
+        }
+        return budget;
+    }
+
     void GPUContext::createCommandPool() {
         Queues::QueueFamilyIndices queueFamilyIndices = m_queues->findQueueFamilies(m_physicalDevice);
 
@@ -249,6 +471,170 @@ namespace engine {
         if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create command pool!");
         }
+
+        m_threadCommandPools = std::make_shared<ThreadCommandPools>();
+        m_threadCommandPools->m_device = m_device;
+    }
+
+    VkCommandPool GPUContext::getThreadCommandPool() {
+        // pools of the calling thread per context, destroyed with the thread unless the context was released before
+        struct ThreadOwner {
+            std::map<ThreadCommandPools *, std::pair<std::shared_ptr<ThreadCommandPools>, VkCommandPool>> m_pools;
+
+            ~ThreadOwner() {
+                for (const auto &[key, pool]: m_pools) {
+                    destroy(*pool.first, pool.second);
+                }
+            }
+
+            static void destroy(ThreadCommandPools &pools, VkCommandPool commandPool) {
+                std::lock_guard<std::mutex> lock(pools.m_mutex);
+                if (pools.m_device != VK_NULL_HANDLE) {
+                    vkDestroyCommandPool(pools.m_device, commandPool, nullptr);
+                    pools.m_commandPools.erase(commandPool);
+                }
+            }
+        };
+        thread_local ThreadOwner owner;
+
+        auto it = owner.m_pools.find(m_threadCommandPools.get());
+        if (it != owner.m_pools.end()) {
+            return it->second.second;
+        }
+
+        // forget the pools of released contexts, they were destroyed by release
+        std::erase_if(owner.m_pools, [](const auto &entry) {
+            std::lock_guard<std::mutex> lock(entry.second.first->m_mutex);
+            return entry.second.first->m_device == VK_NULL_HANDLE;
+        });
+
+        // executeCommands submits to the transfer queue
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = m_queues->findQueueFamilies(m_physicalDevice).transferFamily.value();
+
+        VkCommandPool commandPool;
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create command pool!");
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_threadCommandPools->m_mutex);
+            m_threadCommandPools->m_commandPools.insert(commandPool);
+        }
+        owner.m_pools[m_threadCommandPools.get()] = {m_threadCommandPools, commandPool};
+        return commandPool;
+    }
+
+    GPUContext::PipelineCacheFileHeader GPUContext::getPipelineCacheFileHeader() const {
+        VkPhysicalDeviceIDProperties idProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+        VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &idProperties};
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+        const VkPhysicalDeviceProperties &deviceProperties = properties.properties;
+        PipelineCacheFileHeader header{.m_magic = PIPELINE_CACHE_MAGIC, .m_vendorID = deviceProperties.vendorID, .m_deviceID = deviceProperties.deviceID, .m_driverVersion = deviceProperties.driverVersion};
+        std::memcpy(header.m_deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+        std::memcpy(header.m_pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+        return header;
+    }
+
+    uint64_t GPUContext::hashPipelineCacheData(const std::vector<char> &data) {
+        uint64_t hash = 0xCBF29CE484222325ULL; // FNV-1a
+        for (const char c: data) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    void GPUContext::createPipelineCache() {
+        const PipelineCacheFileHeader expectedHeader = getPipelineCacheFileHeader();
+        if (m_pipelineCachePath.empty()) {
+            if (const char *path = std::getenv("ENGINE_PIPELINE_CACHE_PATH")) {
+                m_pipelineCachePath = path;
+            } else {
+                // one file per physical device (identical GPUs differ in the device UUID) and driver (pipeline cache UUID),
+                // contexts of other devices never reject and overwrite the cache of this one
+                std::stringstream fileName;
+                fileName << "vkradixsort_pipeline_cache_" << std::hex << std::setfill('0');
+                for (const uint8_t byte: expectedHeader.m_deviceUUID) {
+                    fileName << std::setw(2) << static_cast<uint32_t>(byte);
+                }
+                fileName << "_";
+                for (const uint8_t byte: expectedHeader.m_pipelineCacheUUID) {
+                    fileName << std::setw(2) << static_cast<uint32_t>(byte);
+                }
+                fileName << ".bin";
+                std::error_code error;
+                const auto directory = std::filesystem::temp_directory_path(error);
+                m_pipelineCachePath = error ? "" : (directory / fileName.str()).string();
+            }
+        }
+
+        // a missing, foreign (other device or driver) or damaged file starts an empty cache
+        std::vector<char> data;
+        std::ifstream file(m_pipelineCachePath, std::ios::binary);
+        PipelineCacheFileHeader header{};
+        if (!m_pipelineCachePath.empty() && file.is_open() && file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+            if (header.m_magic == expectedHeader.m_magic && header.m_vendorID == expectedHeader.m_vendorID && header.m_deviceID == expectedHeader.m_deviceID && header.m_driverVersion == expectedHeader.m_driverVersion &&
+                std::memcmp(header.m_deviceUUID, expectedHeader.m_deviceUUID, VK_UUID_SIZE) == 0 && std::memcmp(header.m_pipelineCacheUUID, expectedHeader.m_pipelineCacheUUID, VK_UUID_SIZE) == 0) {
+                // the size read from the file is only trusted if the file holds that much data after the header
+                std::error_code error;
+                const uintmax_t fileSize = std::filesystem::file_size(m_pipelineCachePath, error);
+                const bool sizeFits = !error && fileSize >= sizeof(header) && header.m_dataSize <= fileSize - sizeof(header);
+                if (sizeFits) {
+                    data.resize(header.m_dataSize);
+                }
+                if (!sizeFits || !file.read(data.data(), static_cast<std::streamsize>(data.size())) || hashPipelineCacheData(data) != header.m_dataHash) {
+                    std::cerr << "Pipeline cache " << m_pipelineCachePath << " is damaged, starting with an empty cache." << std::endl;
+                    data.clear();
+                }
+            } else {
+                std::cout << "Pipeline cache " << m_pipelineCachePath << " belongs to another device or driver, starting with an empty cache." << std::endl;
+            }
+        }
+
+        VkPipelineCacheCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, .initialDataSize = data.size(), .pInitialData = data.empty() ? nullptr : data.data()};
+        if (vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+        if (!data.empty()) {
+            std::cout << "Loaded pipeline cache " << m_pipelineCachePath << " (" << data.size() << " bytes)." << std::endl;
+        }
+    }
+
+    void GPUContext::savePipelineCache() {
+        if (m_pipelineCache == VK_NULL_HANDLE || m_pipelineCachePath.empty()) {
+            return;
+        }
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+            return;
+        }
+        std::vector<char> data(dataSize);
+        if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+            return;
+        }
+        data.resize(dataSize);
+        PipelineCacheFileHeader header = getPipelineCacheFileHeader();
+        header.m_dataSize = data.size();
+        header.m_dataHash = hashPipelineCacheData(data);
+
+        // written to a file of this process and context and renamed, concurrent processes and contexts never read a partial file
+        std::stringstream temporaryPathStream;
+        temporaryPathStream << m_pipelineCachePath << "." << getpid() << "." << std::hex << reinterpret_cast<uintptr_t>(this) << ".tmp";
+        const std::string temporaryPath = temporaryPathStream.str();
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open() || !file.write(reinterpret_cast<const char *>(&header), sizeof(header)) || !file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+                std::cerr << "Failed to write the pipeline cache " << temporaryPath << "." << std::endl;
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, m_pipelineCachePath, error);
+        if (error) {
+            std::cerr << "Failed to write the pipeline cache " << m_pipelineCachePath << ": " << error.message() << std::endl;
+            std::filesystem::remove(temporaryPath, error);
+        }
     }
 
     void GPUContext::createCommandBuffers() {
@@ -1,5 +1,7 @@
 #include "engine/core/Queues.h"
 
+#include <algorithm>
+
 namespace engine {
     Queues::QueueFamilyIndices Queues::findQueueFamilies(VkPhysicalDevice physicalDevice) const {
         QueueFamilyIndices familyIndices;
@@ -20,11 +22,28 @@ namespace engine {
             if (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) { // require queue for transfer commands
                 familyIndices.transferFamily = i;
             }
-            if (familyIndices.isComplete(m_requiredQueueFamilies)) {
+            if (familyIndices.isComplete(m_requiredQueueFamilies & ~ASYNC_TRANSFER_FAMILY)) {
                 break;
             }
         }
 
+        if (isFamilyRequired(ASYNC_TRANSFER_FAMILY)) {
+            for (int i = 0; i < queueFamilyCount; i++) {
+                const auto &queueFamily = queueFamilies[i];
+                if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) { // dedicated transfer family (DMA engine)
+                    familyIndices.asyncTransferFamily = i;
+                    break;
+                }
+            }
+            if (!familyIndices.asyncTransferFamily.has_value()) { // no dedicated transfer family, share the compute family (no queue family ownership transfers required)
+                familyIndices.asyncTransferFamily = familyIndices.computeFamily.has_value() ? familyIndices.computeFamily : familyIndices.transferFamily;
+            }
+        }
+
+        if (familyIndices.computeFamily.has_value()) { // all queues of the compute family, independent passes are spread over them
+            familyIndices.computeQueueCount = std::clamp(queueFamilies[familyIndices.computeFamily.value()].queueCount, 1U, MAX_COMPUTE_QUEUES);
+        }
+
         return familyIndices;
     }
 
@@ -37,13 +56,78 @@ namespace engine {
         QueueFamilyIndices familyIndices = findQueueFamilies(physicalDevice);
         if (isFamilyRequired(GRAPHICS_FAMILY)) {
             vkGetDeviceQueue(device, familyIndices.graphicsFamily.value(), 0, &m_queues[GRAPHICS]);
+            m_queueFamilyIndices[GRAPHICS] = familyIndices.graphicsFamily.value();
         }
         if (isFamilyRequired(COMPUTE_FAMILY)) {
             vkGetDeviceQueue(device, familyIndices.computeFamily.value(), 0, &m_queues[COMPUTE]);
+            m_queueFamilyIndices[COMPUTE] = familyIndices.computeFamily.value();
         }
         if (isFamilyRequired(TRANSFER_FAMILY)) {
             vkGetDeviceQueue(device, familyIndices.transferFamily.value(), 0, &m_queues[TRANSFER]);
+            m_queueFamilyIndices[TRANSFER] = familyIndices.transferFamily.value();
+        }
+        if (isFamilyRequired(ASYNC_TRANSFER_FAMILY)) {
+            vkGetDeviceQueue(device, familyIndices.asyncTransferFamily.value(), 0, &m_queues[ASYNC_TRANSFER]);
+            m_queueFamilyIndices[ASYNC_TRANSFER] = familyIndices.asyncTransferFamily.value();
+        }
+        for (uint32_t i = 0; i < m_queues.size(); i++) {
+            m_queueMutexes[i] = nullptr;
+            for (uint32_t j = 0; j < i && !m_queueMutexes[i]; j++) {
+                if (m_queues[j] == m_queues[i]) {
+                    m_queueMutexes[i] = m_queueMutexes[j];
+                }
+            }
+            if (!m_queueMutexes[i]) {
+                m_queueMutexes[i] = std::make_shared<std::mutex>();
+            }
+        }
+
+        m_computeQueues.clear();
+        m_computeQueueMutexes.clear();
+        if (isFamilyRequired(COMPUTE_FAMILY)) {
+            m_computeQueues.resize(familyIndices.computeQueueCount);
+            m_computeQueueMutexes.resize(familyIndices.computeQueueCount);
+            for (uint32_t i = 0; i < familyIndices.computeQueueCount; i++) {
+                vkGetDeviceQueue(device, familyIndices.computeFamily.value(), i, &m_computeQueues[i]);
+                for (uint32_t j = 0; j < m_queues.size() && !m_computeQueueMutexes[i]; j++) {
+                    if (m_queues[j] == m_computeQueues[i]) { // queue 0 is shared with COMPUTE (and the queues of the same family)
+                        m_computeQueueMutexes[i] = m_queueMutexes[j];
+                    }
+                }
+                if (!m_computeQueueMutexes[i]) {
+                    m_computeQueueMutexes[i] = std::make_shared<std::mutex>();
+                }
+            }
         }
+        m_nextComputeQueue = 0;
+    }
+
+    VkResult Queues::submit(Queues::Queue queue, uint32_t submitCount, const VkSubmitInfo *submits, VkFence fence) {
+        std::lock_guard<std::mutex> lock(*m_queueMutexes[queue]);
+        return vkQueueSubmit(m_queues[queue], submitCount, submits, fence);
+    }
+
+    VkResult Queues::waitIdle(Queues::Queue queue) {
+        std::lock_guard<std::mutex> lock(*m_queueMutexes[queue]);
+        return vkQueueWaitIdle(m_queues[queue]);
+    }
+
+    uint32_t Queues::acquireComputeQueue(Queues::Priority priority) {
+        const uint32_t count = getComputeQueueCount();
+        if (priority == PRIORITY_HIGH || count <= 1) {
+            return 0;
+        }
+        return 1 + m_nextComputeQueue++ % (count - 1); // queue 0 stays free for high priority work
+    }
+
+    VkResult Queues::submitCompute(uint32_t computeQueueIndex, uint32_t submitCount, const VkSubmitInfo *submits, VkFence fence) {
+        std::lock_guard<std::mutex> lock(*m_computeQueueMutexes[computeQueueIndex]);
+        return vkQueueSubmit(m_computeQueues[computeQueueIndex], submitCount, submits, fence);
+    }
+
+    VkResult Queues::waitIdleCompute(uint32_t computeQueueIndex) {
+        std::lock_guard<std::mutex> lock(*m_computeQueueMutexes[computeQueueIndex]);
+        return vkQueueWaitIdle(m_computeQueues[computeQueueIndex]);
     }
 
     VkQueue Queues::getQueue(Queues::Queue queue) {
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MultiRadixSort.h"
+#include "engine/util/ThreadPool.h"
+
+namespace engine {
+    /**
+     * Multi-threaded LSD radix sort on the host with the digits of the GPU sort (8 bits per pass).
+     * Every pass counts the digits of a contiguous block of the input per thread (SIMD digit extraction with AVX2 / AVX-512 if the
+     * cpu supports it), derives the scatter offsets of every thread and digit from the per-thread histograms and scatters the block
+     * through per-digit software write-combining buffers, so the stores to the 256 destinations are whole cache lines.
+     * Passes in which all keys have the same digit are skipped. The sort is stable, equal keys keep their values in input order.
+     * Used without a Vulkan device (MultiRadixSort::sortInPlace without a GPUContext) and as the CPU baseline of the benchmark.
+     */
+    class CpuRadixSort {
+    public:
+        explicit CpuRadixSort(uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency()));
+
+        // the same interface as MultiRadixSort::sortInPlace
+        void sortInPlace(std::span<SORT_TYPE> elements);
+
+        // key value sort, values[i] belongs to keys[i]
+        void sortInPlace(std::span<SORT_TYPE> keys, std::span<VALUE_TYPE> values);
+
+        // instantiated for uint32_t and uint64_t keys, values may be nullptr
+        template<typename Key>
+        void sort(Key *keys, VALUE_TYPE *values, uint64_t numElements);
+
+        [[nodiscard]] uint32_t getNumThreads() const {
+            return m_threadPool.getNumThreads();
+        }
+
+        // shared with other parallel steps around the sort (e.g. merging)
+        ThreadPool &getThreadPool() {
+            return m_threadPool;
+        }
+
+        // "avx512", "avx2" or "scalar", selected at runtime from the cpu features
+        static const char *getHistogramKernelName();
+
+    private:
+        ThreadPool m_threadPool;
+
+        static const uint32_t RADIX_SORT_BINS = 256;
+        static const uint64_t MIN_ELEMENTS_PER_THREAD = 1 << 16;
+    };
+} // namespace engine
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "MultiRadixSortCountingPass.h"
+#include "MultiRadixSortGatherPass.h"
 #include "MultiRadixSortPass.h"
+#include "MultiRadixSortVerifyPass.h"
+#include "engine/util/KeyGenerator.h"
 
 #include <random>
+#include <span>
 #include <utility>
 
 namespace engine {
@@ -16,40 +21,87 @@ namespace engine {
 #else
 #define SORT_TYPE uint64_t
 #endif
+        // values of the key value sort (see KEY_VALUE in multi_radixsort.comp)
+#define VALUE_TYPE uint32_t
 
     public:
-        void execute(GPUContext *gpuContext);
+        static const uint32_t NUM_ITERATIONS = sizeof(SORT_TYPE); // 8 bits per iteration
+
+        static const uint32_t NUM_BLOCKS_PER_WORKGROUP = 32;
+
+        // profilingJsonPath: writes the timestamp query timings of the dispatches as json (if not empty)
+        void execute(GPUContext *gpuContext, const std::string &profilingJsonPath = "");
+
+        // distribution of the generated keys (uniform by default)
+        void setDistribution(KeyGenerator::Distribution distribution) {
+            m_distribution = distribution;
+        }
+
+        // sorts the elements in place, the host memory is imported (VK_EXT_external_memory_host) instead of copied if possible:
+        // on UMA devices the imported memory is sorted directly, otherwise it is the source and destination of the transfers
+        // more than 2^32 elements or maxStorageBufferRange bytes are sorted with 64-bit indices (MultiRadixSortPass large element count)
+        // persistent: a fixed number of workgroups sized to the compute units of the device (always used for large element counts)
+        // without a GPUContext (no Vulkan device) the elements are sorted by the CpuRadixSort
+        // keys in a range of at most MultiRadixSortCountingPass::AUTO_MAX_BINS (found on the host) are sorted by the counting sort in one round
+        // pass: created keys only pass (of the large element count variant if required) reused instead of creating one per radix sort
+        // countingPass: created keys only counting pass reused instead of creating one per counting sort, also selects the counting sort for
+        // ranges of up to MultiRadixSortCountingPass::MAX_BINS keys
+        static void sortInPlace(GPUContext *gpuContext, std::span<SORT_TYPE> elements, bool persistent = false, MultiRadixSortPass *pass = nullptr, MultiRadixSortCountingPass *countingPass = nullptr);
+
+        // stable argsort: permutation[i] is the index of the i-th smallest key, equal keys keep their order (key value sort of the keys and their indices)
+        // sortedKeys (optional) receives the sorted keys, apply the permutation to further columns with MultiRadixSortGatherPass
+        // keys in a range of at most MultiRadixSortCountingPass::AUTO_MAX_BINS are sorted by the counting sort in one round
+        // pass: created key value pass (of the large element count variant if required) reused instead of creating one per radix sort
+        // countingPass: created key value counting pass reused instead of creating one per counting sort, also selects the counting sort for
+        // ranges of up to MultiRadixSortCountingPass::MAX_BINS keys
+        static void argsort(GPUContext *gpuContext, std::span<const SORT_TYPE> keys, std::span<VALUE_TYPE> permutation, std::span<SORT_TYPE> sortedKeys = {}, MultiRadixSortPass *pass = nullptr, MultiRadixSortCountingPass *countingPass = nullptr);
+
+        // mapped device local memory for the keys on unified memory, nothing otherwise
+        static VkMemoryPropertyFlags getPreferredKeyMemoryProperties(GPUContext *gpuContext) {
+            return gpuContext->isUnifiedMemory() ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0;
+        }
 
     private:
         GPUContext *m_gpuContext;
 
+        // small key ranges, any supported range with a counting pass of the caller
+        static bool useCountingSort(SORT_TYPE minKey, SORT_TYPE maxKey, const MultiRadixSortCountingPass *countingPass);
+
+        // stable counting sort of keys in [minKey, maxKey] into sortedKeys (may be the keys), values (optional) are permuted in place
+        // pass: reused if not null, persistent: workgroups sized to the compute units
+        static void countingSort(GPUContext *gpuContext, MultiRadixSortCountingPass *pass, std::span<const SORT_TYPE> keys, std::span<SORT_TYPE> sortedKeys, std::span<VALUE_TYPE> values, SORT_TYPE minKey, SORT_TYPE maxKey, bool persistent);
+
         std::shared_ptr<MultiRadixSortPass> m_pass;
 
         const uint32_t RADIX_SORT_BINS = 256;
         const uint32_t NUM_ELEMENTS = 1000000;
 
-        const uint32_t NUM_ELEMENTS_BYTES = NUM_ELEMENTS * sizeof(SORT_TYPE);
+        static const uint64_t SEED = 42; // of the generated keys
+
+        const uint64_t NUM_ELEMENTS_BYTES = NUM_ELEMENTS * sizeof(SORT_TYPE);
 
-        std::vector<std::shared_ptr<Buffer>> m_buffers = std::vector<std::shared_ptr<Buffer>>(3);
+        std::vector<std::shared_ptr<Buffer>> m_buffers = std::vector<std::shared_ptr<Buffer>>(4); // ping pong, histograms, copy of the input (verification)
 
         std::vector<SORT_TYPE> m_elementsIn;
 
+        KeyGenerator::Distribution m_distribution = KeyGenerator::Distribution::UNIFORM;
+
         static inline const char *PRINT_PREFIX = "[MultiRadixSort] ";
 
         void prepareBuffers();
 
-        void verify(std::vector<SORT_TYPE> &reference);
+        // on the gpu against the copy of the input, only the counters are read back
+        void verify();
 
         static void printBuffer(const std::string &label, std::vector<SORT_TYPE> &buffer, uint32_t numElements);
 
         void releaseBuffers();
 
-        static void generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements);
+        // keys with 4 (32-bit) or 20 (64-bit) leading zero bits, deterministic for the seed
+        static void generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements, KeyGenerator::Distribution distribution = KeyGenerator::Distribution::UNIFORM);
 
         static void generateZeros(std::vector<SORT_TYPE> &buffer, uint32_t numElements);
 
         static double sort(std::vector<SORT_TYPE> &buffer);
-
-        static bool testSort(std::vector<SORT_TYPE> &reference, std::vector<SORT_TYPE> &outBuffer);
     };
 } // namespace engine
\ No newline at end of file
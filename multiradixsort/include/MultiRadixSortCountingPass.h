@@ -0,0 +1,98 @@
+#pragma once
+
+#include "engine/util/Paths.h"
+#include "engine/passes/ComputePass.h"
+
+namespace engine {
+    /**
+     * Stable counting sort of keys in a small range (multi_radixsort_counting.comp): one histogram per workgroup over all bins of the range,
+     * one scan (reduce, scan of the chunk sums, scan add) and one scatter instead of four histogram and scatter iterations of MultiRadixSortPass
+     * (e.g. material or bucket ids, cell indices).
+     * MultiRadixSort::sortInPlace and argsort use it automatically for keys in a range of at most AUTO_MAX_BINS, up to MAX_BINS with a counting pass of the caller.
+     */
+    class MultiRadixSortCountingPass : public ComputePass {
+    public:
+        // keyValue: the scatter moves a uint32_t value with every key (KEY_VALUE variant)
+        explicit MultiRadixSortCountingPass(GPUContext *gpuContext, bool keyValue = false) : ComputePass(gpuContext), m_keyValue(keyValue) {
+        }
+
+        enum ComputeStage {
+            COUNTING_HISTOGRAM = 0,
+            COUNTING_REDUCE = 1,
+            COUNTING_SCAN = 2,
+            COUNTING_SCAN_ADD = 3,
+            COUNTING_SCATTER = 4,
+        };
+
+        struct PushConstants {
+            uint32_t g_num_elements;
+            uint32_t g_min_key;
+            uint32_t g_num_bins;
+            uint32_t g_num_workgroups;
+            uint32_t g_num_blocks_per_workgroup;
+        };
+
+        PushConstants m_pushConstants{};
+
+        static const uint32_t WORKGROUP_SIZE = 256; // elements per block
+        static const uint32_t NUM_BLOCKS_PER_WORKGROUP = 16;
+        static const uint32_t MAX_BINS = 1 << 16; // keys of at most 16 bits
+        // automatic choice of MultiRadixSort: up to the bins of one radix sort digit the histogram and scan are as small as those of one
+        // of the four radix sort iterations, larger ranges pay for a scan over all bins of all workgroups
+        static const uint32_t AUTO_MAX_BINS = 256;
+        // counters of all bins and workgroups, fewer (larger) workgroups for large ranges bound the counters buffer and the scan
+        static const uint32_t MAX_COUNTERS = 1 << 22;
+        static const uint32_t SCAN_CHUNK = WORKGROUP_SIZE * 16; // counters per workgroup of the reduce and scan add (SCAN_CHUNK of the shader)
+
+        // keys in [minKey, maxKey], the number of workgroups follows from numElements, numBlocksPerWorkgroup and the number of bins
+        // (e.g. getPersistentBlocksPerWorkgroup for workgroups sized to the compute units), at most MAX_COUNTERS / number of bins
+        void setNumElements(uint32_t numElements, uint32_t minKey, uint32_t maxKey, uint32_t numBlocksPerWorkgroup = NUM_BLOCKS_PER_WORKGROUP);
+
+        // blocks per workgroup of a fixed number of workgroups sized to the compute units of the device, fewer for ranges whose
+        // counters of that many workgroups exceed MAX_COUNTERS
+        static uint32_t getPersistentBlocksPerWorkgroup(GPUContext *gpuContext, uint32_t numElements, uint32_t minKey, uint32_t maxKey);
+
+        [[nodiscard]] static bool isKeyRangeSupported(uint32_t minKey, uint32_t maxKey) {
+            return maxKey >= minKey && maxKey - minKey < MAX_BINS;
+        }
+
+        [[nodiscard]] static bool isKeyRangeAutoSelected(uint32_t minKey, uint32_t maxKey) {
+            return maxKey >= minKey && maxKey - minKey < AUTO_MAX_BINS;
+        }
+
+        // size of the counters buffer (one per bin and workgroup of setNumElements, followed by the sums of their chunks)
+        [[nodiscard]] VkDeviceSize getCountersSizeBytes() const {
+            const VkDeviceSize numCounters = static_cast<VkDeviceSize>(m_pushConstants.g_num_bins) * m_pushConstants.g_num_workgroups;
+            return (numCounters + (numCounters + SCAN_CHUNK - 1) / SCAN_CHUNK) * sizeof(uint32_t);
+        }
+
+        // counters are cleared by the pass (VK_BUFFER_USAGE_TRANSFER_DST_BIT) and hold at least getCountersSizeBytes() of the last setNumElements,
+        // valuesIn and valuesOut: key value pass only
+        void setBuffers(Buffer *keysIn, Buffer *keysOut, Buffer *counters, Buffer *valuesIn = nullptr, Buffer *valuesOut = nullptr);
+
+        [[nodiscard]] bool isKeyValue() const {
+            return m_keyValue;
+        }
+
+        // executes the five stages and waits, the sorted keys (and values) are in keysOut (and valuesOut)
+        // releaseBarriers are recorded after the scatter (e.g. Buffer::getHostReadBarrier of mapped outputs)
+        void sort(const std::vector<VkBufferMemoryBarrier> &releaseBarriers = {});
+
+    protected:
+        std::vector<std::shared_ptr<Shader>> createShaders() override;
+
+        [[nodiscard]] std::string getStageName(uint32_t stageIndex) const override;
+
+        void recordCommands(VkCommandBuffer commandBuffer) override;
+
+        void createPipelineLayouts() override;
+
+    private:
+        bool m_keyValue;
+
+        // cleared before the histogram
+        Buffer *m_counters = nullptr;
+
+        std::vector<VkBufferMemoryBarrier> m_releaseBarriers; // of the current sort
+    };
+} // namespace engine
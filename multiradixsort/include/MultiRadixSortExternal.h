@@ -0,0 +1,48 @@
+#pragma once
+
+#include "MultiRadixSortPipeline.h"
+
+#include <thread>
+
+namespace engine {
+    /**
+     * Out-of-core sort for inputs larger than the device memory.
+     * The input is split into chunks that fit into the device memory budget (VK_EXT_memory_budget), each chunk is sorted
+     * with the MultiRadixSortPipeline (uploads and downloads overlap with the sort) and the sorted runs are combined with a
+     * multi-threaded k-way merge on the host.
+     * The GPUContext has to be created with Queues::ASYNC_TRANSFER_FAMILY.
+     */
+    class MultiRadixSortExternal {
+    public:
+        explicit MultiRadixSortExternal(GPUContext *gpuContext, uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency()));
+
+        // sorts numElements elements into output, elements and output must not overlap
+        // elements holds the sorted runs of the chunks afterwards (no further copy of the input is allocated)
+        void sort(SORT_TYPE *elements, SORT_TYPE *output, uint64_t numElements);
+
+        // limits the chunk size (e.g. to leave device memory to the application), 0 chooses the chunk size from the memory budget only
+        void setMaxChunkElements(uint32_t maxChunkElements) {
+            m_maxChunkElements = maxChunkElements;
+        }
+
+        // number of elements per chunk such that all chunks in flight fit into the device memory budget
+        [[nodiscard]] uint32_t getChunkElements(uint64_t numElements, bool keyValue = false) const;
+
+        // merges the sorted runs runs[runOffsets[i], runOffsets[i+1]) into output using numThreads threads
+        // if runValues is given, the values are merged along with their keys into outputValues
+        static void mergeRuns(const SORT_TYPE *runs, const std::vector<uint64_t> &runOffsets, SORT_TYPE *output, uint32_t numThreads, const VALUE_TYPE *runValues = nullptr, VALUE_TYPE *outputValues = nullptr);
+
+    private:
+        GPUContext *m_gpuContext;
+
+        uint32_t m_numThreads;
+        uint32_t m_maxChunkElements = 0;
+
+        // fraction of the device memory budget used for the chunks
+        static constexpr double MEMORY_BUDGET_FRACTION = 0.5;
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortExternal] ";
+
+        static void mergeRange(const SORT_TYPE *runs, const VALUE_TYPE *runValues, const std::vector<uint64_t> &runBegins, const std::vector<uint64_t> &runEnds, SORT_TYPE *output, VALUE_TYPE *outputValues);
+    };
+} // namespace engine
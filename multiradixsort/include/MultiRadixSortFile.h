@@ -0,0 +1,50 @@
+#pragma once
+
+#include "MultiRadixSortExternal.h"
+#include "engine/util/MappedFile.h"
+
+namespace engine {
+    /**
+     * Sorts a binary file of fixed-width records by their SORT_TYPE key (native byte order).
+     * A record is a key optionally followed by payloadSizeBytes bytes of payload.
+     * The input file is memory mapped and the keys are streamed from the mapped pages straight into the staging memory of
+     * the MultiRadixSortPipeline, the result is written through a memory mapped output file.
+     * Without payload the keys are sorted directly. With payload the keys are sorted together with their record index and
+     * the records are gathered into the output afterwards.
+     * Files larger than one chunk are sorted as runs (stored in an unlinked temporary file next to the output) and merged.
+     * The GPUContext has to be created with Queues::ASYNC_TRANSFER_FAMILY, without a GPUContext the file is sorted by the CpuRadixSort.
+     */
+    class MultiRadixSortFile {
+    public:
+        explicit MultiRadixSortFile(GPUContext *gpuContext, uint32_t payloadSizeBytes = 0, uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency()));
+
+        void sort(const std::string &inputPath, const std::string &outputPath);
+
+        void setMaxChunkElements(uint32_t maxChunkElements) {
+            m_external.setMaxChunkElements(maxChunkElements);
+        }
+
+        [[nodiscard]] uint32_t getRecordSizeBytes() const {
+            return sizeof(SORT_TYPE) + m_payloadSizeBytes;
+        }
+
+    private:
+        GPUContext *m_gpuContext;
+
+        uint32_t m_payloadSizeBytes;
+        uint32_t m_numThreads;
+
+        MultiRadixSortExternal m_external; // chunk size and merge of the runs
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortFile] ";
+
+        // chunks sorted by the MultiRadixSortPipeline and merged on the host
+        void sortOnDevice(MappedFile &input, MappedFile &output, uint64_t numRecords, const std::string &outputPath);
+
+        // the whole file sorted by the CpuRadixSort (no GPUContext)
+        void sortOnHost(MappedFile &input, MappedFile &output, uint64_t numRecords);
+
+        // output[i] = input[indices[i]] for whole records
+        void gather(const uint8_t *input, const VALUE_TYPE *indices, uint8_t *output, uint64_t numRecords) const;
+    };
+} // namespace engine
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "engine/util/Paths.h"
+#include "engine/passes/ComputePass.h"
+
+namespace engine {
+    /**
+     * Applies the permutation of an argsort to any number of payload columns in one dispatch (multi_radixsort_gather.comp).
+     * An argsort is the key value sort (MultiRadixSortPass with keyValue) of the keys with the indices as values (IOTA stage),
+     * the sorted values are the permutation. Gathering all columns with it is cheaper than a key value sort per column.
+     * The columns are accessed through their buffer device addresses: create them with COLUMN_BUFFER_USAGES and COLUMN_MEMORY_ALLOCATE_FLAGS.
+     */
+    class MultiRadixSortGatherPass : public ComputePass {
+    public:
+        explicit MultiRadixSortGatherPass(GPUContext *gpuContext) : ComputePass(gpuContext) {
+        }
+
+        enum ComputeStage {
+            IOTA = 0,
+            GATHER = 1,
+        };
+
+        struct PushConstants {
+            uint32_t g_num_elements;
+            uint32_t g_num_columns;
+        };
+
+        PushConstants m_pushConstants{};
+
+        // dst[i] = src[permutation[i]] for elements of widthBytes bytes (a multiple of 4)
+        struct Column {
+            Buffer *m_src;
+            Buffer *m_dst;
+            uint32_t m_widthBytes;
+        };
+
+        static const uint32_t WORKGROUP_SIZE = 256;
+        static const uint32_t ELEMENTS_PER_INVOCATION = 16; // grid stride loop
+
+        static constexpr VkBufferUsageFlags COLUMN_BUFFER_USAGES = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        static constexpr VkMemoryAllocateFlagBits COLUMN_MEMORY_ALLOCATE_FLAGS = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+        void create() override;
+
+        void release() override;
+
+        // target of the IOTA stage (the values of the argsort)
+        void setIndices(Buffer *indices);
+
+        // the permutation and the columns of the GATHER stage, the columns may only change while the pass is idle
+        void setColumns(Buffer *permutation, const std::vector<Column> &columns);
+
+        // selects the stage recorded by the next execute (or record) for numElements elements
+        void prepareIndices(uint32_t numElements);
+
+        void prepareGather(uint32_t numElements);
+
+        // prepare, execute and wait
+        void writeIndices(uint32_t numElements);
+
+        void gather(uint32_t numElements);
+
+    protected:
+        std::vector<std::shared_ptr<Shader>> createShaders() override;
+
+        void recordCommands(VkCommandBuffer commandBuffer) override;
+
+        void createPipelineLayouts() override;
+
+    private:
+        // layout of Column in multi_radixsort_gather.comp
+        struct ColumnDescriptor {
+            VkDeviceAddress m_src;
+            VkDeviceAddress m_dst;
+            uint32_t m_widthWords;
+            uint32_t m_pad[3];
+        };
+
+        ComputeStage m_stage = GATHER;
+        uint32_t m_numColumns = 0;
+
+        std::shared_ptr<Buffer> m_columnsBuffer; // host visible column descriptors, grown on demand
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortGatherPass] ";
+
+        void setInvocationCount(ComputeStage stage, uint64_t numInvocations);
+    };
+} // namespace engine
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CpuRadixSort.h"
+
+namespace engine {
+    /**
+     * Co-sort on the GPU and the CPU: the input is split into a GPU part (MultiRadixSort::sortInPlace, run from a separate thread)
+     * and a CPU part (CpuRadixSort) which are sorted at the same time, the two sorted parts are combined with a parallel merge-path merge.
+     * The GPU share follows the measured throughput (keys per ms including the transfers) of both sides, smoothed over the previous runs,
+     * so that both sides finish at about the same time.
+     */
+    class MultiRadixSortHybrid {
+    public:
+        // timings of the last sortInPlace
+        struct Timings {
+            uint64_t m_gpuElements = 0;
+            uint64_t m_cpuElements = 0;
+            double m_gpuMs = 0.0;
+            double m_cpuMs = 0.0;
+            double m_mergeMs = 0.0;
+            double m_totalMs = 0.0;
+        };
+
+        explicit MultiRadixSortHybrid(GPUContext *gpuContext, uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency()));
+
+        void sortInPlace(std::span<SORT_TYPE> elements);
+
+        void release();
+
+        // fraction of the elements sorted on the gpu in the next run
+        [[nodiscard]] double getGpuFraction() const {
+            return m_gpuFraction;
+        }
+
+        void setGpuFraction(double gpuFraction) {
+            m_gpuFraction = std::clamp(gpuFraction, MIN_FRACTION, 1.0 - MIN_FRACTION);
+        }
+
+        [[nodiscard]] const Timings &getTimings() const {
+            return m_timings;
+        }
+
+        // merges the sorted ranges a and b into output (no overlap), the output is split into one range per thread whose inputs are
+        // found by a binary search along the merge path, the ranges are merged in parallel
+        static void mergePath(const SORT_TYPE *a, uint64_t sizeA, const SORT_TYPE *b, uint64_t sizeB, SORT_TYPE *output, ThreadPool &threadPool);
+
+    private:
+        GPUContext *m_gpuContext;
+
+        CpuRadixSort m_cpuRadixSort; // its thread pool also merges
+
+        // created on first use for each variant
+        std::shared_ptr<MultiRadixSortPass> m_pass;
+        std::shared_ptr<MultiRadixSortPass> m_passLarge;
+
+        double m_gpuFraction = 0.5; // no measurements yet
+        Timings m_timings;
+
+        // inputs below are sorted by the cpu only (the gpu launch and transfers do not pay off)
+        static const uint64_t MIN_HYBRID_ELEMENTS = 1 << 20;
+        // the smaller side keeps at least this share to remain measured
+        static constexpr double MIN_FRACTION = 0.02;
+        // weight of the latest measurement in the gpu fraction
+        static constexpr double ADAPTATION_RATE = 0.5;
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortHybrid] ";
+
+        MultiRadixSortPass *getPass(uint64_t numElements);
+    };
+} // namespace engine
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MultiRadixSortPass.h"
+#include "engine/util/Paths.h"
+#include "engine/passes/ComputePass.h"
+
+namespace engine {
+    /**
+     * Fused morton code generation and sort for LBVH / PLOC builds: the first iteration (MORTON_CODES variants of the histogram and scatter
+     * shaders) computes the 30-bit morton codes of the centroids of the AABBs on the fly and scatters the (code, primitive index) pairs
+     * by the lowest digit, a key value MultiRadixSortPass sorts the remaining digits. The codes and indices are never written unsorted.
+     */
+    class MultiRadixSortMortonPass : public ComputePass {
+    public:
+        explicit MultiRadixSortMortonPass(GPUContext *gpuContext) : ComputePass(gpuContext) {
+        }
+
+        enum ComputeStage {
+            MORTON_HISTOGRAMS = 0,
+            MORTON_SCATTER = 1,
+        };
+
+        // both stages, g_shift is always 0
+        struct PushConstants {
+            uint32_t g_num_elements;
+            uint32_t g_shift;
+            uint32_t g_num_workgroups;
+            uint32_t g_num_blocks_per_workgroup;
+        };
+
+        PushConstants m_pushConstants{};
+
+        static const uint32_t MORTON_CODE_BITS = 30;
+        static const uint32_t NUM_ITERATIONS = 4; // digits of a morton code, the first one is sorted by this pass
+
+        // bytes of the AABB of a primitive in the aabbs buffer (min x, y, z, max x, y, z as floats)
+        static const uint32_t AABB_SIZE_BYTES = 6 * sizeof(float);
+
+        // same workgroups as MultiRadixSortPass::setNumElements, the histograms buffer is shared with the sort pass
+        void setNumElements(uint32_t numPrimitives, uint32_t numBlocksPerWorkgroup);
+
+        // aabbs: one AABB per primitive, sceneBounds: 6 floats (min x, y, z, max x, y, z) containing all centroids, e.g. written by a reduction on the GPU
+        // sortPass: created key value pass (not the large element count variant) with the same number of elements, sorts the remaining digits
+        // the sorted morton codes end in keys0 and the primitive indices in values0, keys1 and values1 are the ping pong buffers
+        void setBuffers(MultiRadixSortPass *sortPass, Buffer *aabbs, Buffer *sceneBounds, Buffer *keys0, Buffer *keys1, Buffer *histograms, Buffer *values0, Buffer *values1);
+
+        // records all iterations into a command buffer recorded by the caller (e.g. a PassGraph, before the BVH build)
+        void recordSort(VkCommandBuffer commandBuffer);
+
+        // records all iterations into one command buffer and submits it, the handle completes with the sort
+        SubmitHandle submitSort(const std::vector<SubmitHandle> &waitHandles = {});
+
+        // submitSort and wait
+        void sort();
+
+    protected:
+        std::vector<std::shared_ptr<Shader>> createShaders() override;
+
+        [[nodiscard]] std::string getStageName(uint32_t stageIndex) const override;
+
+        void recordCommands(VkCommandBuffer commandBuffer) override;
+
+        void createPipelineLayouts() override;
+
+    private:
+        MultiRadixSortPass *m_sortPass = nullptr;
+    };
+} // namespace engine
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CpuRadixSort.h"
+
+namespace engine {
+    /**
+     * Sort on several devices, one GPUContext (VkDevice) per device: splitters drawn from a sample of the keys partition the input on the
+     * host so that every device owns a contiguous key range, the ranges are sorted at the same time by MultiRadixSort::sortInPlace (one
+     * host thread per device, host staging) and are already in order when written back. The share of every device follows its measured
+     * throughput like MultiRadixSortHybrid. Several contexts may be created on the same physical device (e.g. lavapipe).
+     */
+    class MultiRadixSortMultiDevice {
+    public:
+        struct DeviceTimings {
+            uint64_t m_elements = 0;
+            double m_sortMs = 0.0; // upload, sort and download
+        };
+
+        // timings of the last sortInPlace
+        struct Timings {
+            std::vector<DeviceTimings> m_devices;
+            double m_partitionMs = 0.0; // sampling and scattering into the key ranges
+            double m_copyMs = 0.0;      // of the sorted ranges back into the input
+            double m_totalMs = 0.0;
+        };
+
+        explicit MultiRadixSortMultiDevice(std::vector<GPUContext *> gpuContexts, uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency()));
+
+        void sortInPlace(std::span<SORT_TYPE> elements);
+
+        void release();
+
+        [[nodiscard]] const Timings &getTimings() const {
+            return m_timings;
+        }
+
+        // share of the elements of every device in the next run (normalized)
+        [[nodiscard]] const std::vector<double> &getWeights() const {
+            return m_weights;
+        }
+
+        void setWeights(const std::vector<double> &weights);
+
+        // scatters input into output grouped by the key ranges of the splitters (bucket i: splitters[i - 1] <= key < splitters[i]),
+        // returns the first index of every bucket in output and the end
+        static std::vector<uint64_t> partition(std::span<const SORT_TYPE> input, SORT_TYPE *output, const std::vector<SORT_TYPE> &splitters, ThreadPool &threadPool);
+
+        // numBuckets - 1 splitters from a sample of the input, bucket i receives about weights[i] of the elements
+        static std::vector<SORT_TYPE> selectSplitters(std::span<const SORT_TYPE> input, const std::vector<double> &weights);
+
+    private:
+        std::vector<GPUContext *> m_gpuContexts;
+
+        CpuRadixSort m_cpuRadixSort; // sorts the sample, its thread pool partitions and copies
+
+        // created on first use for each device and variant
+        std::vector<std::shared_ptr<MultiRadixSortPass>> m_passes;
+        std::vector<std::shared_ptr<MultiRadixSortPass>> m_passesLarge;
+
+        std::vector<double> m_weights;
+        Timings m_timings;
+
+        // inputs below are sorted by the first device only
+        static const uint64_t MIN_MULTI_DEVICE_ELEMENTS = 1 << 20;
+        static const uint32_t NUM_SAMPLES_PER_BUCKET = 1024;
+        // every device keeps at least this share to remain measured
+        static constexpr double MIN_WEIGHT = 0.02;
+        // weight of the latest measurement in the shares
+        static constexpr double ADAPTATION_RATE = 0.5;
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortMultiDevice] ";
+
+        MultiRadixSortPass *getPass(uint32_t device, uint64_t numElements);
+    };
+} // namespace engine
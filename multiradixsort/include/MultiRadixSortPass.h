@@ -3,10 +3,15 @@
 #include "engine/util/Paths.h"
 #include "engine/passes/ComputePass.h"
 
+#include <array>
+
 namespace engine {
     class MultiRadixSortPass : public ComputePass {
     public:
-        explicit MultiRadixSortPass(GPUContext *gpuContext) : ComputePass(gpuContext) {
+        // keyValue: the scatter shader moves a uint32_t value with every key (KEY_VALUE variant)
+        // largeElementCount: 64-bit indices and buffers bound by their device address instead of descriptors (LARGE_ELEMENT_COUNT variant),
+        // required for more than 2^32 elements or buffers larger than maxStorageBufferRange
+        explicit MultiRadixSortPass(GPUContext *gpuContext, bool keyValue = false, bool largeElementCount = false) : ComputePass(gpuContext), m_keyValue(keyValue), m_largeElementCount(largeElementCount) {
         }
 
         enum ComputeStage {
@@ -32,11 +37,101 @@ namespace engine {
 
         PushConstants m_pushConstants{};
 
+        // both stages of the LARGE_ELEMENT_COUNT variant
+        struct PushConstantsLarge {
+            uint64_t g_num_elements;
+            VkDeviceAddress g_elements_in;
+            VkDeviceAddress g_elements_out;
+            VkDeviceAddress g_values_in;
+            VkDeviceAddress g_values_out;
+            uint32_t g_shift;
+            uint32_t g_num_workgroups;
+            uint32_t g_num_blocks_per_workgroup;
+        };
+
+        PushConstantsLarge m_pushConstantsLarge{};
+
+        static const uint32_t RADIX_SORT_BINS = 256;
+        static const uint32_t WORKGROUP_SIZE = 256; // elements per block
+
+        // persistent workgroups per compute unit and the workgroup count if the number of compute units is unknown
+        static const uint32_t PERSISTENT_WORKGROUPS_PER_COMPUTE_UNIT = 4;
+        static const uint32_t PERSISTENT_WORKGROUPS_FALLBACK = 256;
+
+        // sets the workgroup counts and the push constants (except the shift) for sorting numElements elements
+        void setNumElements(uint64_t numElements, uint32_t numBlocksPerWorkgroup);
+
+        // blocks per workgroup such that a fixed number of workgroups (a few per compute unit) covers all elements,
+        // each workgroup loops over its contiguous range of blocks instead of launching workgroups proportional to numElements
+        static uint32_t getPersistentBlocksPerWorkgroup(GPUContext *gpuContext, uint64_t numElements);
+
+        // numElements 32-bit keys cannot be bound as a single storage buffer or indexed with 32 bits
+        static bool requiresLargeElementCount(GPUContext *gpuContext, uint64_t numElements);
+
+        // usages and allocation flags of key and value buffers in the LARGE_ELEMENT_COUNT variant
+        static constexpr VkBufferUsageFlags LARGE_ELEMENT_COUNT_BUFFER_USAGES = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        static constexpr VkMemoryAllocateFlagBits LARGE_ELEMENT_COUNT_MEMORY_ALLOCATE_FLAGS = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+        // binds the ping pong buffers and the histogram buffer for the iterations starting at the currently active index
+        // values0 and values1 are the ping pong buffers of the values (key value pass only)
+        void setBuffers(Buffer *buffer0, Buffer *buffer1, Buffer *histograms, Buffer *values0 = nullptr, Buffer *values1 = nullptr);
+
+        [[nodiscard]] bool isKeyValue() const {
+            return m_keyValue;
+        }
+
+        [[nodiscard]] bool isLargeElementCount() const {
+            return m_largeElementCount;
+        }
+
+        // digit sorted by the first iteration (0 by default), 1 while MultiRadixSortMortonPass records the remaining digits
+        void setFirstDigit(uint32_t firstDigit) {
+            m_firstDigit = firstDigit;
+        }
+
+        // executes the pass numIterations times (8 bits per iteration), the result is in buffer0 for an even number of iterations
+        // if profiling is enabled, the dispatches of iteration i are labeled "digit i"
+        // acquireBarriers are recorded before the first iteration, releaseBarriers after the last iteration (queue family ownership transfers, host reads)
+        VkSemaphore sort(VkSemaphore awaitBeforeExecution, uint32_t numIterations, const std::vector<VkBufferMemoryBarrier> &acquireBarriers = {}, const std::vector<VkBufferMemoryBarrier> &releaseBarriers = {});
+
+        // sort without blocking the host: all iterations are recorded into one command buffer and submitted at once,
+        // the returned handle (timeline semaphore) completes with the sort, the sort starts on the GPU after waitHandles
+        // the buffers of setBuffers must not be rebound until the handle has completed, the host keeps preparing the next batch meanwhile
+        SubmitHandle submitSort(uint32_t numIterations, const std::vector<SubmitHandle> &waitHandles = {}, const std::vector<VkBufferMemoryBarrier> &acquireBarriers = {}, const std::vector<VkBufferMemoryBarrier> &releaseBarriers = {});
+
+        // records numIterations iterations into a command buffer recorded by the caller (e.g. a PassGraph) without submitting it
+        void recordSort(VkCommandBuffer commandBuffer, uint32_t numIterations, const std::vector<VkBufferMemoryBarrier> &acquireBarriers = {}, const std::vector<VkBufferMemoryBarrier> &releaseBarriers = {});
+
+        static uint32_t getHistogramsSizeBytes(uint32_t numWorkgroups) {
+            return numWorkgroups * RADIX_SORT_BINS * sizeof(uint32_t);
+        }
+
     protected:
         std::vector<std::shared_ptr<Shader>> createShaders() override;
 
+        [[nodiscard]] std::string getStageName(uint32_t stageIndex) const override;
+
+        [[nodiscard]] uint64_t getStageBytes(uint32_t stageIndex) const override;
+
         void recordCommands(VkCommandBuffer commandBuffer) override;
 
         void createPipelineLayouts() override;
+
+    private:
+        bool m_keyValue;
+        bool m_largeElementCount;
+
+        uint64_t m_numElements = 0;
+        uint32_t m_firstDigit = 0;
+
+        // LARGE_ELEMENT_COUNT: device addresses of {buffer0, buffer1, values0, values1} and the active index of setBuffers
+        std::array<VkDeviceAddress, 4> m_bufferAddresses{};
+        uint32_t m_bufferActiveIndex = 0;
+
+        std::vector<VkBufferMemoryBarrier> m_acquireBarriers;
+        std::vector<VkBufferMemoryBarrier> m_releaseBarriers;
+
+        // push constants and barriers of iteration i (the buffers follow the active index)
+        void prepareIteration(uint32_t i, uint32_t numIterations, const std::vector<VkBufferMemoryBarrier> &acquireBarriers, const std::vector<VkBufferMemoryBarrier> &releaseBarriers);
     };
-}
\ No newline at end of file
+}
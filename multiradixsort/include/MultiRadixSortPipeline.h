@@ -0,0 +1,113 @@
+#pragma once
+
+#include "MultiRadixSort.h"
+
+#include <functional>
+
+namespace engine {
+    /**
+     * Sorts a stream of independent batches. The upload of batch k+1 and the download of batch k-1 run on the
+     * ASYNC_TRANSFER queue while batch k is sorted on the COMPUTE queue, i.e. the copies are hidden behind the sort.
+     * The GPUContext has to be created with Queues::ASYNC_TRANSFER_FAMILY.
+     * On unified memory (GPUContext::isUnifiedMemory) the batches are written to and read from mapped device local memory
+     * directly, there are no staging buffers and no transfers at all.
+     */
+    class MultiRadixSortPipeline {
+    public:
+        // writes the numElements keys (and values, nullptr if not keyValue) of batch batchIndex to the (mapped) staging memory
+        using FillFunction = std::function<void(uint32_t batchIndex, SORT_TYPE *elements, VALUE_TYPE *values, uint32_t numElements)>;
+        // consumes the numElements sorted keys (and values, nullptr if not keyValue) of batch batchIndex from the (mapped) staging memory
+        using DrainFunction = std::function<void(uint32_t batchIndex, const SORT_TYPE *elements, const VALUE_TYPE *values, uint32_t numElements)>;
+
+        // keyValue: every key carries a VALUE_TYPE value that is sorted along
+        MultiRadixSortPipeline(GPUContext *gpuContext, uint32_t maxElementsPerBatch, bool keyValue = false, uint32_t numBlocksPerWorkgroup = MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+
+        void create();
+
+        void release();
+
+        // sorts batchSizes.size() batches, fill and drain are called from the calling thread in batch order
+        void run(const std::vector<uint32_t> &batchSizes, const FillFunction &fill, const DrainFunction &drain);
+
+        [[nodiscard]] uint32_t getMaxElementsPerBatch() const {
+            return m_maxElementsPerBatch;
+        }
+
+        // one slot per pipeline stage (upload, sort, download)
+        static const uint32_t NUM_SLOTS = 3;
+
+        [[nodiscard]] bool isKeyValue() const {
+            return m_keyValue;
+        }
+
+        // the batches are sorted in mapped device local memory (set in create)
+        [[nodiscard]] bool isMapped() const {
+            return m_mapped;
+        }
+
+        // device local memory required per element of maxElementsPerBatch (ping pong buffers of all slots, without histograms)
+        static constexpr uint32_t getDeviceBytesPerElement(bool keyValue = false) {
+            return NUM_SLOTS * 2 * (sizeof(SORT_TYPE) + (keyValue ? sizeof(VALUE_TYPE) : 0));
+        }
+
+    private:
+        struct Slot {
+            std::shared_ptr<MultiRadixSortPass> m_pass;
+
+            std::shared_ptr<Buffer> m_stagingIn; // keys followed by the values
+            std::shared_ptr<Buffer> m_stagingOut;
+            std::vector<std::shared_ptr<Buffer>> m_buffers; // ping pong buffers, histograms and ping pong value buffers
+
+            SORT_TYPE *m_stagingInMemory = nullptr;
+            SORT_TYPE *m_stagingOutMemory = nullptr;
+            VALUE_TYPE *m_stagingInValues = nullptr;
+            VALUE_TYPE *m_stagingOutValues = nullptr;
+
+            VkCommandBuffer m_uploadCommandBuffer{};
+            VkCommandBuffer m_downloadCommandBuffer{};
+            VkSemaphore m_uploadSemaphore{};
+            VkSemaphore m_sortSemaphore = VK_NULL_HANDLE; // owned by the pass
+            VkFence m_downloadFence{};
+
+            int64_t m_batchIndex = -1; // batch waiting to be drained
+            uint32_t m_numElements = 0;
+        };
+
+        GPUContext *m_gpuContext;
+
+        uint32_t m_maxElementsPerBatch;
+        bool m_keyValue;
+        uint32_t m_numBlocksPerWorkgroup;
+        bool m_mapped = false;
+
+        uint32_t m_computeFamily{};
+        uint32_t m_transferFamily{};
+
+        VkCommandPool m_transferCommandPool = VK_NULL_HANDLE;
+
+        std::array<Slot, NUM_SLOTS> m_slots;
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortPipeline] ";
+
+        [[nodiscard]] bool requiresOwnershipTransfer() const {
+            return !m_mapped && m_computeFamily != m_transferFamily;
+        }
+
+        VkBufferMemoryBarrier bufferMemoryBarrier(Buffer *buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t srcQueueFamily, uint32_t dstQueueFamily) const;
+
+        void createStagingBuffers(Slot &slot, VkDeviceSize maxElementsBytes, VkDeviceSize maxValuesBytes);
+
+        // buffers that are moved between the queue families (buffer0 and values0)
+        [[nodiscard]] std::vector<Buffer *> getTransferredBuffers(const Slot &slot) const;
+
+        void upload(Slot &slot);
+
+        void sort(Slot &slot);
+
+        void download(Slot &slot);
+
+        void drain(Slot &slot, const DrainFunction &drain);
+
+        void submitTransfer(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkSemaphore signalSemaphore, VkFence fence);
+    };
+} // namespace engine
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "engine/util/Paths.h"
+#include "engine/passes/ComputePass.h"
+
+namespace engine {
+    /**
+     * Runs of equal keys in sorted keys (multi_radixsort_runs.comp): the unique keys, the length of every run (run length encoding)
+     * and, with reduceByKey, the sum of the values of every run. Heads of runs are counted per workgroup, scanned by a single
+     * workgroup and compacted, the number of runs is written to a device buffer, so the pass is recorded right after the sort
+     * (e.g. in one command buffer of a PassGraph) without reading anything back in between.
+     */
+    class MultiRadixSortRunsPass : public ComputePass {
+    public:
+        explicit MultiRadixSortRunsPass(GPUContext *gpuContext, bool reduceByKey = false) : ComputePass(gpuContext), m_reduceByKey(reduceByKey) {
+        }
+
+        enum ComputeStage {
+            RUNS_HEADS = 0,
+            RUNS_SCAN = 1,
+            RUNS_COMPACT = 2,
+        };
+
+        struct PushConstants {
+            uint32_t g_num_elements;
+            uint32_t g_num_workgroups;
+            uint32_t g_num_blocks_per_workgroup;
+        };
+
+        PushConstants m_pushConstants{};
+
+        static const uint32_t WORKGROUP_SIZE = 256; // elements per block
+        static const uint32_t NUM_BLOCKS_PER_WORKGROUP = 16;
+
+        // sets the workgroup counts and the push constants for numElements sorted keys
+        void setNumElements(uint32_t numElements, uint32_t numBlocksPerWorkgroup = NUM_BLOCKS_PER_WORKGROUP);
+
+        // size of the workgroupRuns buffer (one counter per workgroup of setNumElements)
+        [[nodiscard]] VkDeviceSize getWorkgroupRunsSizeBytes() const {
+            return static_cast<VkDeviceSize>(m_pushConstants.g_num_workgroups) * sizeof(uint32_t);
+        }
+
+        // keys: sorted, numRuns: one uint32_t written on the device
+        // uniqueKeys, runLengths (and runSums) receive one element per run, at most one per key
+        // runLengths and runSums are cleared by the pass (VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+        // values and runSums: reduce by key pass only
+        void setBuffers(Buffer *keys, Buffer *workgroupRuns, Buffer *numRuns, Buffer *uniqueKeys, Buffer *runLengths, Buffer *values = nullptr, Buffer *runSums = nullptr);
+
+        // executes the three stages and waits, the results stay on the device
+        void findRuns();
+
+        // the run lengths and sums are accumulated with atomics on cleared buffers, cleared by the pass itself by default
+        // clearOutputs false: the caller records recordClear in a transfer pass of its own (e.g. a separate PassGraph pass before the runs)
+        void setClearOutputs(bool clearOutputs) {
+            m_clearOutputs = clearOutputs;
+        }
+
+        // fills the run lengths (and sums) with zeros
+        void recordClear(VkCommandBuffer commandBuffer) const;
+
+        [[nodiscard]] bool isReduceByKey() const {
+            return m_reduceByKey;
+        }
+
+    protected:
+        std::vector<std::shared_ptr<Shader>> createShaders() override;
+
+        void recordCommands(VkCommandBuffer commandBuffer) override;
+
+        void createPipelineLayouts() override;
+
+    private:
+        bool m_reduceByKey;
+        bool m_clearOutputs = true;
+
+        // cleared before the compaction
+        Buffer *m_runLengths = nullptr;
+        Buffer *m_runSums = nullptr;
+    };
+} // namespace engine
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "engine/util/Paths.h"
+#include "engine/passes/ComputePass.h"
+
+namespace engine {
+    /**
+     * Checks a sort on the GPU (multi_radixsort_verify.comp): the output keys are non-decreasing and a permutation of the input
+     * (order independent hash sums and counts of the most significant digit), in the key value variant the pairs are compared and
+     * optionally the stability. Only the counters are read back, so the check is cheap enough to stay enabled.
+     */
+    class MultiRadixSortVerifyPass : public ComputePass {
+    public:
+        explicit MultiRadixSortVerifyPass(GPUContext *gpuContext, bool keyValue = false) : ComputePass(gpuContext), m_keyValue(keyValue) {
+        }
+
+        enum ComputeStage {
+            VERIFY = 0,
+        };
+
+        struct PushConstants {
+            uint32_t g_num_elements;
+            uint32_t g_check_stability;
+        };
+
+        PushConstants m_pushConstants{};
+
+        struct Result {
+            uint32_t m_unsortedPairs = 0; // adjacent output keys in decreasing order
+            uint32_t m_unstablePairs = 0; // adjacent equal output keys with decreasing values (stability check only)
+            bool m_hashesMatch = false;
+            bool m_countsMatch = false;   // of the most significant digit
+
+            [[nodiscard]] bool isValid() const {
+                return m_unsortedPairs == 0 && m_unstablePairs == 0 && m_hashesMatch && m_countsMatch;
+            }
+        };
+
+        static const uint32_t WORKGROUP_SIZE = 256;
+        static const uint32_t RADIX_SORT_BINS = 256;
+        static const uint32_t ELEMENTS_PER_INVOCATION = 16; // grid stride loop
+        static const uint32_t RESULT_SIZE = 8 + 2 * RADIX_SORT_BINS; // see RESULT_* in multi_radixsort_verify.comp
+
+        void create() override;
+
+        void release() override;
+
+        // input: keys before the sort, output: sorted keys (and values of the key value pass)
+        void setBuffers(Buffer *input, Buffer *output, Buffer *valuesIn = nullptr, Buffer *valuesOut = nullptr);
+
+        // verifies the first numElements elements and waits for the result
+        // checkStability: the input values are their indices (key value pass only)
+        Result verify(uint32_t numElements, bool checkStability = false);
+
+    protected:
+        std::vector<std::shared_ptr<Shader>> createShaders() override;
+
+        void recordCommands(VkCommandBuffer commandBuffer) override;
+
+        void createPipelineLayouts() override;
+
+    private:
+        bool m_keyValue;
+
+        std::shared_ptr<Buffer> m_resultBuffer; // host visible counters
+
+        static inline const char *PRINT_PREFIX = "[MultiRadixSortVerifyPass] ";
+    };
+} // namespace engine
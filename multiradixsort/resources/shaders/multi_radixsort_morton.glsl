@@ -0,0 +1,23 @@
+/**
+* 30-bit morton codes of the centroids of axis aligned bounding boxes (MultiRadixSortMortonPass), used by
+* multi_radixsort_histograms.comp and multi_radixsort.comp with MORTON_CODES.
+* Requires the buffers g_aabbs (min x, y, z, max x, y, z per primitive) and g_scene_bounds (min x, y, z, max x, y, z containing all centroids).
+*/
+
+// spreads the lower 10 bits of v to every third bit
+uint expandBits(uint v) {
+    v = (v * 0x00010001U) & 0xFF0000FFU;
+    v = (v * 0x00000101U) & 0x0F00F00FU;
+    v = (v * 0x00000011U) & 0xC30C30C3U;
+    v = (v * 0x00000005U) & 0x49249249U;
+    return v;
+}
+
+uint mortonCode(uint primitive) {
+    const vec3 scene_min = vec3(g_scene_bounds[0], g_scene_bounds[1], g_scene_bounds[2]);
+    const vec3 scene_extent = vec3(g_scene_bounds[3], g_scene_bounds[4], g_scene_bounds[5]) - scene_min;
+    const uint a = 6U * primitive;
+    const vec3 centroid = 0.5 * (vec3(g_aabbs[a], g_aabbs[a + 1U], g_aabbs[a + 2U]) + vec3(g_aabbs[a + 3U], g_aabbs[a + 4U], g_aabbs[a + 5U]));
+    const vec3 p = clamp(mix(vec3(0.0), (centroid - scene_min) / scene_extent, greaterThan(scene_extent, vec3(0.0))) * 1024.0, vec3(0.0), vec3(1023.0));
+    return expandBits(uint(p.x)) * 4U + expandBits(uint(p.y)) * 2U + expandBits(uint(p.z));
+}
@@ -0,0 +1,39 @@
+/**
+* Exclusive scan over the invocations of a workgroup: subgroup scans and a scan of the subgroup sums.
+* Used by multi_radixsort.comp (global offsets), multi_radixsort_runs.comp and multi_radixsort_counting.comp.
+* Requires WORKGROUP_SIZE, SUBGROUP_SIZE and the subgroup arithmetic and ballot extensions, SCAN_TYPE is the type of the values (uint by default).
+*/
+#ifndef SCAN_TYPE
+#define SCAN_TYPE uint
+#endif
+
+shared SCAN_TYPE[WORKGROUP_SIZE / SUBGROUP_SIZE] sums; // subgroup reductions
+shared SCAN_TYPE block_total;
+
+// exclusive scan of x over the workgroup, block_total receives the sum, called by all invocations (contains barriers)
+SCAN_TYPE workgroupExclusiveAdd(SCAN_TYPE x) {
+    const uint sID = gl_SubgroupID;
+    const uint lsID = gl_SubgroupInvocationID;
+    const SCAN_TYPE sum = subgroupAdd(x);
+    const SCAN_TYPE prefix_sum = subgroupExclusiveAdd(x);
+    if (subgroupElect()) {
+        // one thread inside the warp/subgroup enters this section
+        sums[sID] = sum;
+    }
+    barrier();
+
+#if SUBGROUP_SIZE * SUBGROUP_SIZE >= WORKGROUP_SIZE
+    const SCAN_TYPE sums_prefix_sum = subgroupBroadcast(subgroupExclusiveAdd(lsID < WORKGROUP_SIZE / SUBGROUP_SIZE ? sums[lsID] : SCAN_TYPE(0)), sID);
+#else
+    // more subgroups than invocations in a subgroup (e.g. 8 wide subgroups of lavapipe)
+    SCAN_TYPE sums_prefix_sum = SCAN_TYPE(0);
+    for (uint i = 0; i < sID; i++) {
+        sums_prefix_sum += sums[i];
+    }
+#endif
+    if (gl_LocalInvocationID.x == WORKGROUP_SIZE - 1) {
+        block_total = sums_prefix_sum + prefix_sum + x;
+    }
+    barrier();
+    return sums_prefix_sum + prefix_sum;
+}
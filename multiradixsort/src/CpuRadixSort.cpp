@@ -0,0 +1,270 @@
+#include "CpuRadixSort.h"
+
+#include <array>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_RADIX_SORT_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace engine {
+
+    namespace {
+        const uint32_t BINS = 256;
+        const uint32_t HISTOGRAM_BANKS = 4; // interleaved counters, consecutive equal digits do not wait for each other's increment
+        const uint32_t WRITE_COMBINING_BYTES = 64; // one cache line per digit
+
+        enum class HistogramKernel {
+            SCALAR,
+            AVX2,
+            AVX512,
+        };
+
+        HistogramKernel detectHistogramKernel() {
+#ifdef CPU_RADIX_SORT_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return HistogramKernel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return HistogramKernel::AVX2;
+            }
+#endif
+            return HistogramKernel::SCALAR;
+        }
+
+        HistogramKernel getHistogramKernel() {
+            static const HistogramKernel kernel = detectHistogramKernel();
+            return kernel;
+        }
+
+        void sumBanks(const uint64_t (&banks)[HISTOGRAM_BANKS][BINS], uint64_t *histogram) {
+            for (uint32_t bank = 0; bank < HISTOGRAM_BANKS; bank++) {
+                for (uint32_t digit = 0; digit < BINS; digit++) {
+                    histogram[digit] += banks[bank][digit];
+                }
+            }
+        }
+
+        template<typename Key>
+        void countDigitsScalar(const Key *keys, uint64_t count, uint32_t shift, uint64_t (&banks)[HISTOGRAM_BANKS][BINS]) {
+            uint64_t i = 0;
+            for (; i + HISTOGRAM_BANKS <= count; i += HISTOGRAM_BANKS) {
+                for (uint32_t bank = 0; bank < HISTOGRAM_BANKS; bank++) {
+                    banks[bank][(keys[i + bank] >> shift) & 0xFF]++;
+                }
+            }
+            for (; i < count; i++) {
+                banks[0][(keys[i] >> shift) & 0xFF]++;
+            }
+        }
+
+#ifdef CPU_RADIX_SORT_X86_SIMD
+        // shifts and masks 8 (32-bit) or 4 (64-bit) keys per instruction
+        template<typename Key>
+        __attribute__((target("avx2"))) void countDigitsAvx2(const Key *keys, uint64_t count, uint32_t shift, uint64_t (&banks)[HISTOGRAM_BANKS][BINS]) {
+            constexpr uint32_t KEYS_PER_VECTOR = 32 / sizeof(Key);
+            const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+            const __m256i mask = sizeof(Key) == 4 ? _mm256_set1_epi32(0xFF) : _mm256_set1_epi64x(0xFF);
+            alignas(32) Key digits[KEYS_PER_VECTOR];
+            uint64_t i = 0;
+            for (; i + KEYS_PER_VECTOR <= count; i += KEYS_PER_VECTOR) {
+                const __m256i vector = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+                const __m256i shifted = sizeof(Key) == 4 ? _mm256_srl_epi32(vector, shiftCount) : _mm256_srl_epi64(vector, shiftCount);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(digits), _mm256_and_si256(shifted, mask));
+                for (uint32_t lane = 0; lane < KEYS_PER_VECTOR; lane++) {
+                    banks[lane % HISTOGRAM_BANKS][digits[lane]]++;
+                }
+            }
+            countDigitsScalar(keys + i, count - i, shift, banks);
+        }
+
+        // shifts 16 (32-bit) or 8 (64-bit) keys per instruction and narrows them to bytes
+        template<typename Key>
+        __attribute__((target("avx512f"))) void countDigitsAvx512(const Key *keys, uint64_t count, uint32_t shift, uint64_t (&banks)[HISTOGRAM_BANKS][BINS]) {
+            constexpr uint32_t KEYS_PER_VECTOR = 64 / sizeof(Key);
+            const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+            alignas(16) uint8_t digits[16];
+            uint64_t i = 0;
+            for (; i + KEYS_PER_VECTOR <= count; i += KEYS_PER_VECTOR) {
+                const __m512i vector = _mm512_loadu_si512(keys + i);
+                if constexpr (sizeof(Key) == 4) {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(digits), _mm512_cvtepi32_epi8(_mm512_srl_epi32(vector, shiftCount))); // truncation keeps the digit
+                } else {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(digits), _mm512_cvtepi64_epi8(_mm512_srl_epi64(vector, shiftCount)));
+                }
+                for (uint32_t lane = 0; lane < KEYS_PER_VECTOR; lane++) {
+                    banks[lane % HISTOGRAM_BANKS][digits[lane]]++;
+                }
+            }
+            countDigitsScalar(keys + i, count - i, shift, banks);
+        }
+#endif
+
+        // adds the digit counts of keys[0, count) to histogram
+        template<typename Key>
+        void countDigits(const Key *keys, uint64_t count, uint32_t shift, uint64_t *histogram) {
+            uint64_t banks[HISTOGRAM_BANKS][BINS] = {};
+            switch (getHistogramKernel()) {
+#ifdef CPU_RADIX_SORT_X86_SIMD
+                case HistogramKernel::AVX512:
+                    countDigitsAvx512(keys, count, shift, banks);
+                    break;
+                case HistogramKernel::AVX2:
+                    countDigitsAvx2(keys, count, shift, banks);
+                    break;
+#endif
+                default:
+                    countDigitsScalar(keys, count, shift, banks);
+                    break;
+            }
+            sumBanks(banks, histogram);
+        }
+
+        // scatters keysIn[first, last) (and the values) to the offsets of their digits, offsets are advanced
+        // the elements of a digit are collected in a cache line sized buffer and written out when it is full
+        template<typename Key, bool KEY_VALUE>
+        void scatter(const Key *keysIn, const VALUE_TYPE *valuesIn, Key *keysOut, VALUE_TYPE *valuesOut, uint64_t first, uint64_t last, uint32_t shift, uint64_t *offsets) {
+            constexpr uint32_t ELEMENTS_PER_LINE = WRITE_COMBINING_BYTES / sizeof(Key);
+            struct WriteCombiningBuffers {
+                alignas(WRITE_COMBINING_BYTES) Key m_keys[BINS][ELEMENTS_PER_LINE];
+                alignas(WRITE_COMBINING_BYTES) VALUE_TYPE m_values[KEY_VALUE ? BINS : 1][ELEMENTS_PER_LINE];
+                uint32_t m_counts[BINS];
+            };
+            auto buffers = std::make_unique<WriteCombiningBuffers>();
+
+            for (uint64_t i = first; i < last; i++) {
+                const Key key = keysIn[i];
+                const uint32_t digit = (key >> shift) & 0xFF;
+                const uint32_t count = buffers->m_counts[digit];
+                buffers->m_keys[digit][count] = key;
+                if constexpr (KEY_VALUE) {
+                    buffers->m_values[digit][count] = valuesIn[i];
+                }
+                if (count + 1 < ELEMENTS_PER_LINE) {
+                    buffers->m_counts[digit] = count + 1;
+                    continue;
+                }
+                memcpy(keysOut + offsets[digit], buffers->m_keys[digit], sizeof(buffers->m_keys[digit]));
+                if constexpr (KEY_VALUE) {
+                    memcpy(valuesOut + offsets[digit], buffers->m_values[digit], sizeof(buffers->m_values[digit]));
+                }
+                offsets[digit] += ELEMENTS_PER_LINE;
+                buffers->m_counts[digit] = 0;
+            }
+
+            // partially filled lines
+            for (uint32_t digit = 0; digit < BINS; digit++) {
+                const uint32_t count = buffers->m_counts[digit];
+                memcpy(keysOut + offsets[digit], buffers->m_keys[digit], count * sizeof(Key));
+                if constexpr (KEY_VALUE) {
+                    memcpy(valuesOut + offsets[digit], buffers->m_values[digit], count * sizeof(VALUE_TYPE));
+                }
+                offsets[digit] += count;
+            }
+        }
+    } // namespace
+
+    CpuRadixSort::CpuRadixSort(uint32_t numThreads) : m_threadPool(numThreads) {
+    }
+
+    void CpuRadixSort::sortInPlace(std::span<SORT_TYPE> elements) {
+        sort<SORT_TYPE>(elements.data(), nullptr, elements.size());
+    }
+
+    void CpuRadixSort::sortInPlace(std::span<SORT_TYPE> keys, std::span<VALUE_TYPE> values) {
+        if (keys.size() != values.size()) {
+            throw std::runtime_error("Failed to sort, the number of keys and values differ!");
+        }
+        sort<SORT_TYPE>(keys.data(), values.data(), keys.size());
+    }
+
+    template<typename Key>
+    void CpuRadixSort::sort(Key *keys, VALUE_TYPE *values, uint64_t numElements) {
+        if (numElements < 2) {
+            return;
+        }
+        // one contiguous block per thread, small inputs are sorted by the calling thread only
+        const uint32_t numBlocks = static_cast<uint32_t>(std::clamp<uint64_t>(numElements / MIN_ELEMENTS_PER_THREAD, 1, m_threadPool.getNumThreads()));
+        const uint64_t blockSize = (numElements + numBlocks - 1) / numBlocks;
+        const auto getBlockRange = [&](uint32_t block) {
+            return std::make_pair(std::min(numElements, block * blockSize), std::min(numElements, (block + 1) * blockSize));
+        };
+
+        std::unique_ptr<Key[]> keysScratch(new Key[numElements]);
+        std::unique_ptr<VALUE_TYPE[]> valuesScratch(values != nullptr ? new VALUE_TYPE[numElements] : nullptr);
+        std::vector<std::array<uint64_t, RADIX_SORT_BINS>> histograms(numBlocks);
+
+        Key *keysIn = keys;
+        Key *keysOut = keysScratch.get();
+        VALUE_TYPE *valuesIn = values;
+        VALUE_TYPE *valuesOut = valuesScratch.get();
+        for (uint32_t shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+            m_threadPool.parallelFor(numBlocks, [&](uint32_t block) {
+                const auto [first, last] = getBlockRange(block);
+                histograms[block].fill(0);
+                countDigits(keysIn + first, last - first, shift, histograms[block].data());
+            });
+
+            // all keys share the digit: the pass would not move anything
+            bool trivialPass = false;
+            for (uint32_t digit = 0; digit < RADIX_SORT_BINS && !trivialPass; digit++) {
+                uint64_t total = 0;
+                for (const auto &histogram: histograms) {
+                    total += histogram[digit];
+                }
+                trivialPass = total == numElements;
+            }
+            if (trivialPass) {
+                continue;
+            }
+
+            // offsets: digits in ascending order, blocks in input order within a digit (stable)
+            uint64_t sum = 0;
+            for (uint32_t digit = 0; digit < RADIX_SORT_BINS; digit++) {
+                for (auto &histogram: histograms) {
+                    const uint64_t count = histogram[digit];
+                    histogram[digit] = sum;
+                    sum += count;
+                }
+            }
+
+            m_threadPool.parallelFor(numBlocks, [&](uint32_t block) {
+                const auto [first, last] = getBlockRange(block);
+                if (values != nullptr) {
+                    scatter<Key, true>(keysIn, valuesIn, keysOut, valuesOut, first, last, shift, histograms[block].data());
+                } else {
+                    scatter<Key, false>(keysIn, valuesIn, keysOut, valuesOut, first, last, shift, histograms[block].data());
+                }
+            });
+            std::swap(keysIn, keysOut);
+            std::swap(valuesIn, valuesOut);
+        }
+
+        // an odd number of passes leaves the result in the scratch buffers
+        if (keysIn != keys) {
+            m_threadPool.parallelFor(numBlocks, [&](uint32_t block) {
+                const auto [first, last] = getBlockRange(block);
+                memcpy(keys + first, keysIn + first, (last - first) * sizeof(Key));
+                if (values != nullptr) {
+                    memcpy(values + first, valuesIn + first, (last - first) * sizeof(VALUE_TYPE));
+                }
+            });
+        }
+    }
+
+    template void CpuRadixSort::sort<uint32_t>(uint32_t *keys, VALUE_TYPE *values, uint64_t numElements);
+
+    template void CpuRadixSort::sort<uint64_t>(uint64_t *keys, VALUE_TYPE *values, uint64_t numElements);
+
+    const char *CpuRadixSort::getHistogramKernelName() {
+        switch (getHistogramKernel()) {
+            case HistogramKernel::AVX512:
+                return "avx512";
+            case HistogramKernel::AVX2:
+                return "avx2";
+            default:
+                return "scalar";
+        }
+    }
+} // namespace engine
@@ -1,75 +1,68 @@
 #include "MultiRadixSort.h"
+#include "CpuRadixSort.h"
+
+#include <algorithm>
+#include <numeric>
 
 namespace engine {
 
-    void MultiRadixSort::execute(GPUContext *gpuContext) {
+    // one thread pool for all host sorts of the process instead of one per call
+    static CpuRadixSort &getCpuRadixSort() {
+        static CpuRadixSort cpuRadixSort;
+        return cpuRadixSort;
+    }
+
+    void MultiRadixSort::execute(GPUContext *gpuContext, const std::string &profilingJsonPath) {
         // gpu context
         m_gpuContext = gpuContext;
 
         // compute pass
         m_pass = std::make_shared<MultiRadixSortPass>(gpuContext);
         m_pass->create();
-        const uint NUM_BLOCKS_PER_WORKGROUP = 32;
-        uint32_t globalInvocationSize = NUM_ELEMENTS / NUM_BLOCKS_PER_WORKGROUP;
-        uint32_t remainder = NUM_ELEMENTS % NUM_BLOCKS_PER_WORKGROUP;
-        globalInvocationSize += remainder > 0 ? 1 : 0;
-        m_pass->setGlobalInvocationSize(MultiRadixSortPass::RADIX_SORT_HISTOGRAMS, globalInvocationSize, 1, 1);
-        m_pass->setGlobalInvocationSize(MultiRadixSortPass::RADIX_SORT, globalInvocationSize, 1, 1);
-
-        // push constants
-        const uint NUM_WORKGROUPS = m_pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width;
-        assert(NUM_WORKGROUPS == m_pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT).width);
-        m_pass->m_pushConstantsHistogram.g_num_elements = NUM_ELEMENTS;
-        m_pass->m_pushConstantsHistogram.g_num_workgroups = NUM_WORKGROUPS;
-        m_pass->m_pushConstantsHistogram.g_num_blocks_per_workgroup = NUM_BLOCKS_PER_WORKGROUP;
-        m_pass->m_pushConstants.g_num_elements = NUM_ELEMENTS;
-        m_pass->m_pushConstants.g_num_workgroups = NUM_WORKGROUPS;
-        m_pass->m_pushConstants.g_num_blocks_per_workgroup = NUM_BLOCKS_PER_WORKGROUP;
+        if (!profilingJsonPath.empty()) {
+            m_pass->enableProfiling(); // timestamp queries only when the timings are written
+        }
+        m_pass->setNumElements(NUM_ELEMENTS, NUM_BLOCKS_PER_WORKGROUP);
 
         // buffers
         prepareBuffers();
-        std::cout << PRINT_PREFIX << "Sorting " << NUM_ELEMENTS << " " << (sizeof(m_elementsIn[0]) * 8) << "bit numbers." << std::endl;
+        std::cout << PRINT_PREFIX << "Sorting " << NUM_ELEMENTS << " " << (sizeof(m_elementsIn[0]) * 8) << "bit numbers (" << KeyGenerator::getDistributionName(m_distribution) << ")." << std::endl;
 
         // set storage buffers
-        uint32_t activeIndex = m_gpuContext->getActiveIndex();
-
-        // m_buffer0
-        m_pass->setStorageBuffer(activeIndex, MultiRadixSortPass::RADIX_SORT_HISTOGRAMS, 0, m_buffers[0].get()); // iteration 0 and 2 (0,0)
-        m_pass->setStorageBuffer(activeIndex, MultiRadixSortPass::RADIX_SORT, 0, m_buffers[0].get());            // iteration 0 and 2 (1,0)
-        m_pass->setStorageBuffer((activeIndex + 1) % 2, MultiRadixSortPass::RADIX_SORT, 1, m_buffers[0].get());  // iteration 1 and 3 (1,1)
-
-        m_pass->setStorageBuffer((activeIndex + 1) % 2, MultiRadixSortPass::RADIX_SORT_HISTOGRAMS, 0, m_buffers[1].get()); // iteration 1 and 3 (0,0)
-        m_pass->setStorageBuffer(activeIndex, MultiRadixSortPass::RADIX_SORT, 1, m_buffers[1].get());                      // iteration 0 and 2 (1,1)
-        m_pass->setStorageBuffer((activeIndex + 1) % 2, MultiRadixSortPass::RADIX_SORT, 0, m_buffers[1].get());            // iteration 1 and 3 (1,0)
-
-        m_pass->setStorageBuffer(MultiRadixSortPass::RADIX_SORT_HISTOGRAMS, 1, m_buffers[2].get());
-        m_pass->setStorageBuffer(MultiRadixSortPass::RADIX_SORT, 2, m_buffers[2].get());
+        m_pass->setBuffers(m_buffers[0].get(), m_buffers[1].get(), m_buffers[2].get());
 
         // execute pass
         std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-        VkSemaphore awaitBeforeExecution = VK_NULL_HANDLE;
-#ifdef SORT_32BIT
-        const uint32_t NUM_ITERATIONS = 4;
-#else
-        const uint32_t NUM_ITERATIONS = 8;
-#endif
-        for (uint32_t i = 0; i < NUM_ITERATIONS; i++) {
-            m_pass->m_pushConstantsHistogram.g_shift = 8 * i;
-            m_pass->m_pushConstants.g_shift = 8 * i;
-            awaitBeforeExecution = m_pass->execute(awaitBeforeExecution);
-            m_gpuContext->incrementActiveIndex();
-        }
-        vkQueueWaitIdle(m_gpuContext->m_queues->getQueue(Queues::COMPUTE));
+        m_pass->sort(VK_NULL_HANDLE, NUM_ITERATIONS);
+        m_pass->wait();
         std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
         double gpuSortTime = (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3));
         std::cout << PRINT_PREFIX << "GPU sort finished in " << gpuSortTime << "[ms]." << std::endl;
+        if (m_pass->isProfiling()) {
+            double gpuTime = 0.0;
+            for (const auto &timing: m_pass->getProfilingResults()) {
+                gpuTime += timing.m_milliseconds;
+            }
+            std::cout << PRINT_PREFIX << "GPU time of the dispatches " << gpuTime << "[ms]:" << std::endl;
+            m_pass->printProfilingResults(std::cout);
+            m_pass->writeProfilingJson(profilingJsonPath);
+        }
 
-        // cpu sorting
+        // cpu sorting (timing comparison only), std::sort is the reference of the CPU radix sort
+        std::vector<SORT_TYPE> cpuRadixSorted = m_elementsIn;
+        CpuRadixSort &cpuRadixSort = getCpuRadixSort(); // the thread creation is not measured
+        begin = std::chrono::steady_clock::now();
+        cpuRadixSort.sortInPlace(cpuRadixSorted);
+        end = std::chrono::steady_clock::now();
+        std::cout << PRINT_PREFIX << "CPU radix sort (" << CpuRadixSort::getHistogramKernelName() << ") finished in " << (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3)) << "[ms]." << std::endl;
         double cpuSortTime = sort(m_elementsIn);
         std::cout << PRINT_PREFIX << "CPU sort finished in " << cpuSortTime << "[ms]." << std::endl;
+        if (cpuRadixSorted != m_elementsIn) {
+            throw std::runtime_error("TEST FAILED (CPU radix sort).");
+        }
 
         // verify result
-        verify(m_elementsIn);
+        verify();
 
         // clean up
         releaseBuffers();
@@ -80,11 +73,246 @@ namespace engine {
         //        myfile << NUM_ELEMENTS << " " << NUM_BLOCKS_PER_WORKGROUP << " " << std::to_string(gpuSortTime) << " " << std::to_string(cpuSortTime) << std::endl;
     }
 
+    void MultiRadixSort::sortInPlace(GPUContext *gpuContext, std::span<SORT_TYPE> elements, bool persistent, MultiRadixSortPass *pass, MultiRadixSortCountingPass *countingPass) {
+        if (elements.empty()) {
+            return;
+        }
+        if (gpuContext == nullptr) {
+            getCpuRadixSort().sortInPlace(elements);
+            return;
+        }
+        const uint64_t numElements = elements.size();
+        const VkDeviceSize numElementsBytes = elements.size_bytes();
+
+        // more than 2^32 elements or maxStorageBufferRange bytes: 64-bit indices and keys addressed by their buffer device address
+        const bool largeElementCount = MultiRadixSortPass::requiresLargeElementCount(gpuContext, numElements);
+        if (largeElementCount && !gpuContext->supportsLargeBuffers()) {
+            throw std::runtime_error("Failed to sort, the device does not support 64-bit indices and buffer device addresses!");
+        }
+        if (pass != nullptr && (pass->isKeyValue() || pass->isLargeElementCount() != largeElementCount)) {
+            throw std::runtime_error("Failed to sort, the pass does not match the element count!");
+        }
+        if (countingPass != nullptr && countingPass->isKeyValue()) {
+            throw std::runtime_error("Failed to sort, the counting pass is a key value pass!");
+        }
+        if (!largeElementCount) {
+            const auto [minKey, maxKey] = std::minmax_element(elements.begin(), elements.end());
+            if (useCountingSort(*minKey, *maxKey, countingPass)) {
+                std::cout << PRINT_PREFIX << "Sorting " << numElements << " elements in a range of " << (*maxKey - *minKey + 1) << " keys with the counting sort." << std::endl;
+                countingSort(gpuContext, countingPass, elements, elements, {}, *minKey, *maxKey, persistent);
+                return;
+            }
+        }
+        VkBufferUsageFlags keyUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        std::optional<VkMemoryAllocateFlagBits> keyAllocateFlags{};
+        if (largeElementCount) {
+            keyUsages |= MultiRadixSortPass::LARGE_ELEMENT_COUNT_BUFFER_USAGES;
+            keyAllocateFlags = MultiRadixSortPass::LARGE_ELEMENT_COUNT_MEMORY_ALLOCATE_FLAGS;
+        }
+
+        std::shared_ptr<MultiRadixSortPass> ownedPass;
+        if (pass == nullptr) {
+            ownedPass = std::make_shared<MultiRadixSortPass>(gpuContext, false, largeElementCount);
+            ownedPass->create();
+            pass = ownedPass.get();
+        }
+        // persistent workgroups (sized to the compute units) if requested or the element count needs more workgroups than can be dispatched
+        const uint32_t numBlocksPerWorkgroup = persistent || largeElementCount ? MultiRadixSortPass::getPersistentBlocksPerWorkgroup(gpuContext, numElements) : NUM_BLOCKS_PER_WORKGROUP;
+        pass->setNumElements(numElements, numBlocksPerWorkgroup);
+
+        // on unified memory the keys are written and read in place (no staging copies)
+        auto settings0 = Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | keyUsages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_preferredMemoryProperties = getPreferredKeyMemoryProperties(gpuContext), .m_memoryAllocateFlagBits = keyAllocateFlags, .m_name = "radixSort.elementBuffer0"};
+        auto settingsImport = settings0;
+        settingsImport.m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        std::shared_ptr<Buffer> buffer0 = Buffer::importHostMemory(gpuContext, settingsImport, elements.data());
+        const bool sortsHostMemory = buffer0 != nullptr;
+        if (!sortsHostMemory) {
+            buffer0 = Buffer::fillDeviceWithStagingBuffer(gpuContext, settings0, elements.data());
+        }
+        auto settings1 = Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = keyUsages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = keyAllocateFlags, .m_name = "radixSort.elementBuffer1"};
+        auto settings2 = Buffer::BufferSettings{.m_sizeBytes = MultiRadixSortPass::getHistogramsSizeBytes(pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.histogramsBuffer"};
+        auto buffer1 = std::make_shared<Buffer>(gpuContext, settings1);
+        auto histograms = std::make_shared<Buffer>(gpuContext, settings2);
+        std::cout << PRINT_PREFIX << "Sorting " << numElements << " elements " << (sortsHostMemory ? "in imported host memory" : "in device memory") << " with " << pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT).width << " workgroups" << (largeElementCount ? " (64-bit indices)." : ".") << std::endl;
+
+        // the host reads the imported or mapped memory in place after the wait
+        std::vector<VkBufferMemoryBarrier> releaseBarriers;
+        if (sortsHostMemory || buffer0->isHostMappable()) {
+            releaseBarriers.push_back(buffer0->getHostReadBarrier());
+        }
+        pass->setBuffers(buffer0.get(), buffer1.get(), histograms.get());
+        pass->sort(VK_NULL_HANDLE, NUM_ITERATIONS, {}, releaseBarriers);
+        pass->wait(); // other threads may sort on the same queue with their own passes
+
+        if (!sortsHostMemory) {
+            buffer0->downloadWithStagingBuffer(elements.data());
+        }
+
+        buffer0->release();
+        buffer1->release();
+        histograms->release();
+        if (ownedPass) {
+            ownedPass->release();
+        }
+    }
+
+    void MultiRadixSort::argsort(GPUContext *gpuContext, std::span<const SORT_TYPE> keys, std::span<VALUE_TYPE> permutation, std::span<SORT_TYPE> sortedKeys, MultiRadixSortPass *pass, MultiRadixSortCountingPass *countingPass) {
+        if (permutation.size() != keys.size() || (!sortedKeys.empty() && sortedKeys.size() != keys.size())) {
+            throw std::runtime_error("Failed to argsort, the permutation and the sorted keys need one element per key!");
+        }
+        if (keys.size() > UINT32_MAX) {
+            throw std::runtime_error("Failed to argsort, the permutation is limited to 2^32 elements!");
+        }
+        std::iota(permutation.begin(), permutation.end(), 0); // the values of the key value sort
+        if (keys.empty()) {
+            return;
+        }
+        if (gpuContext == nullptr) {
+            std::stable_sort(permutation.begin(), permutation.end(), [&keys](VALUE_TYPE a, VALUE_TYPE b) { return keys[a] < keys[b]; });
+            for (size_t i = 0; i < sortedKeys.size(); i++) {
+                sortedKeys[i] = keys[permutation[i]];
+            }
+            return;
+        }
+        const uint64_t numElements = keys.size();
+
+        const bool largeElementCount = MultiRadixSortPass::requiresLargeElementCount(gpuContext, numElements);
+        if (largeElementCount && !gpuContext->supportsLargeBuffers()) {
+            throw std::runtime_error("Failed to argsort, the device does not support 64-bit indices and buffer device addresses!");
+        }
+        if (pass != nullptr && (!pass->isKeyValue() || pass->isLargeElementCount() != largeElementCount)) {
+            throw std::runtime_error("Failed to argsort, the pass is not a key value pass matching the element count!");
+        }
+        if (countingPass != nullptr && !countingPass->isKeyValue()) {
+            throw std::runtime_error("Failed to argsort, the counting pass is not a key value pass!");
+        }
+        if (!largeElementCount) {
+            const auto [minKey, maxKey] = std::minmax_element(keys.begin(), keys.end());
+            if (useCountingSort(*minKey, *maxKey, countingPass)) {
+                countingSort(gpuContext, countingPass, keys, sortedKeys, permutation, *minKey, *maxKey, false);
+                return;
+            }
+        }
+        VkBufferUsageFlags usages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        std::optional<VkMemoryAllocateFlagBits> allocateFlags{};
+        if (largeElementCount) {
+            usages |= MultiRadixSortPass::LARGE_ELEMENT_COUNT_BUFFER_USAGES;
+            allocateFlags = MultiRadixSortPass::LARGE_ELEMENT_COUNT_MEMORY_ALLOCATE_FLAGS;
+        }
+
+        std::shared_ptr<MultiRadixSortPass> ownedPass;
+        if (pass == nullptr) {
+            ownedPass = std::make_shared<MultiRadixSortPass>(gpuContext, true, largeElementCount);
+            ownedPass->create();
+            pass = ownedPass.get();
+        }
+        const uint32_t numBlocksPerWorkgroup = largeElementCount ? MultiRadixSortPass::getPersistentBlocksPerWorkgroup(gpuContext, numElements) : NUM_BLOCKS_PER_WORKGROUP;
+        pass->setNumElements(numElements, numBlocksPerWorkgroup);
+
+        // keys and indices are uploaded, the permutation (and the sorted keys) downloaded
+        auto keySettings = Buffer::BufferSettings{.m_sizeBytes = keys.size_bytes(), .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usages, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_memoryAllocateFlagBits = allocateFlags, .m_name = "radixSort.elementBuffer0"};
+        auto valueSettings = keySettings;
+        valueSettings.m_sizeBytes = permutation.size_bytes();
+        valueSettings.m_name = "radixSort.valueBuffer0";
+        auto keys0 = Buffer::fillDeviceWithStagingBuffer(gpuContext, keySettings, keys.data());
+        auto values0 = Buffer::fillDeviceWithStagingBuffer(gpuContext, valueSettings, permutation.data());
+        keySettings.m_name = "radixSort.elementBuffer1";
+        valueSettings.m_name = "radixSort.valueBuffer1";
+        auto keys1 = std::make_shared<Buffer>(gpuContext, keySettings);
+        auto values1 = std::make_shared<Buffer>(gpuContext, valueSettings);
+        auto histograms = std::make_shared<Buffer>(gpuContext, Buffer::BufferSettings{.m_sizeBytes = MultiRadixSortPass::getHistogramsSizeBytes(pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.histogramsBuffer"});
+
+        pass->setBuffers(keys0.get(), keys1.get(), histograms.get(), values0.get(), values1.get());
+        pass->sort(VK_NULL_HANDLE, NUM_ITERATIONS);
+        pass->wait();
+
+        // even number of iterations, the result is in keys0 and values0
+        values0->downloadWithStagingBuffer(permutation.data());
+        if (!sortedKeys.empty()) {
+            keys0->downloadWithStagingBuffer(sortedKeys.data());
+        }
+
+        for (const auto &buffer: {keys0, keys1, values0, values1, histograms}) {
+            buffer->release();
+        }
+        if (ownedPass) {
+            ownedPass->release();
+        }
+    }
+
+    bool MultiRadixSort::useCountingSort(SORT_TYPE minKey, SORT_TYPE maxKey, const MultiRadixSortCountingPass *countingPass) {
+        return countingPass != nullptr ? MultiRadixSortCountingPass::isKeyRangeSupported(minKey, maxKey) : MultiRadixSortCountingPass::isKeyRangeAutoSelected(minKey, maxKey);
+    }
+
+    void MultiRadixSort::countingSort(GPUContext *gpuContext, MultiRadixSortCountingPass *pass, std::span<const SORT_TYPE> keys, std::span<SORT_TYPE> sortedKeys, std::span<VALUE_TYPE> values, SORT_TYPE minKey, SORT_TYPE maxKey, bool persistent) {
+        const bool keyValue = !values.empty();
+        std::shared_ptr<MultiRadixSortCountingPass> ownedPass;
+        if (pass == nullptr) {
+            ownedPass = std::make_shared<MultiRadixSortCountingPass>(gpuContext, keyValue);
+            ownedPass->create();
+            pass = ownedPass.get();
+        }
+        const uint32_t numBlocksPerWorkgroup = persistent ? MultiRadixSortCountingPass::getPersistentBlocksPerWorkgroup(gpuContext, static_cast<uint32_t>(keys.size()), minKey, maxKey) : MultiRadixSortCountingPass::NUM_BLOCKS_PER_WORKGROUP;
+        pass->setNumElements(static_cast<uint32_t>(keys.size()), minKey, maxKey, numBlocksPerWorkgroup);
+
+        // the keys of the caller are read only and uploaded (the host memory is at most imported as transfer source), the values are
+        // read from the imported host memory if possible (unified memory), otherwise uploaded, on unified memory the outputs are mapped and read in place
+        const auto upload = [gpuContext](const Buffer::BufferSettings &settings, void *data) {
+            auto settingsImport = settings;
+            settingsImport.m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            std::shared_ptr<Buffer> buffer = Buffer::importHostMemory(gpuContext, settingsImport, data);
+            return buffer ? buffer : Buffer::fillDeviceWithStagingBuffer(gpuContext, settings, data);
+        };
+        auto keySettings = Buffer::BufferSettings{.m_sizeBytes = keys.size_bytes(), .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_preferredMemoryProperties = getPreferredKeyMemoryProperties(gpuContext), .m_name = "countingSort.keysIn"};
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        buffers.push_back(Buffer::fillDeviceWithStagingBuffer(gpuContext, keySettings, keys.data()));
+        keySettings.m_name = "countingSort.keysOut";
+        buffers.push_back(std::make_shared<Buffer>(gpuContext, keySettings));
+        buffers.push_back(std::make_shared<Buffer>(gpuContext, Buffer::BufferSettings{.m_sizeBytes = pass->getCountersSizeBytes(), .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "countingSort.counters"}));
+        if (keyValue) {
+            auto valueSettings = keySettings;
+            valueSettings.m_sizeBytes = values.size_bytes();
+            valueSettings.m_name = "countingSort.valuesIn";
+            buffers.push_back(upload(valueSettings, values.data()));
+            valueSettings.m_name = "countingSort.valuesOut";
+            buffers.push_back(std::make_shared<Buffer>(gpuContext, valueSettings));
+            pass->setBuffers(buffers[0].get(), buffers[1].get(), buffers[2].get(), buffers[3].get(), buffers[4].get());
+        } else {
+            pass->setBuffers(buffers[0].get(), buffers[1].get(), buffers[2].get());
+        }
+
+        // the host reads the mapped outputs in place after the wait
+        std::vector<VkBufferMemoryBarrier> releaseBarriers;
+        if (!sortedKeys.empty() && buffers[1]->isHostMappable()) {
+            releaseBarriers.push_back(buffers[1]->getHostReadBarrier());
+        }
+        if (keyValue && buffers[4]->isHostMappable()) {
+            releaseBarriers.push_back(buffers[4]->getHostReadBarrier());
+        }
+        pass->sort(releaseBarriers);
+
+        if (!sortedKeys.empty()) {
+            buffers[1]->downloadWithStagingBuffer(sortedKeys.data());
+        }
+        if (keyValue) {
+            buffers[4]->downloadWithStagingBuffer(values.data());
+        }
+
+        for (const auto &buffer: buffers) {
+            buffer->release();
+        }
+        if (ownedPass) {
+            ownedPass->release();
+        }
+    }
+
     void MultiRadixSort::prepareBuffers() {
-        generateRandomNumbers(m_elementsIn, NUM_ELEMENTS);
+        generateRandomNumbers(m_elementsIn, NUM_ELEMENTS, m_distribution);
         //        printBuffer("elements_in", m_elementsIn, NUM_ELEMENTS);
-        auto settings0 = Buffer::BufferSettings{.m_sizeBytes = NUM_ELEMENTS_BYTES, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.elementBuffer0"};
+        auto settings0 = Buffer::BufferSettings{.m_sizeBytes = NUM_ELEMENTS_BYTES, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_preferredMemoryProperties = getPreferredKeyMemoryProperties(m_gpuContext), .m_name = "radixSort.elementBuffer0"};
         m_buffers[0] = Buffer::fillDeviceWithStagingBuffer(m_gpuContext, settings0, m_elementsIn.data());
+        auto settings3 = Buffer::BufferSettings{.m_sizeBytes = NUM_ELEMENTS_BYTES, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.inputCopy"};
+        m_buffers[3] = Buffer::fillDeviceWithStagingBuffer(m_gpuContext, settings3, m_elementsIn.data());
 
         std::vector<SORT_TYPE> zeros;
         generateZeros(zeros, NUM_ELEMENTS);
@@ -94,11 +322,18 @@ namespace engine {
         m_buffers[2] = Buffer::fillDeviceWithStagingBuffer(m_gpuContext, settings2, zeros.data());
     }
 
-    void MultiRadixSort::verify(std::vector<SORT_TYPE> &reference) {
-        std::vector<SORT_TYPE> data(NUM_ELEMENTS);
-        m_buffers[0]->downloadWithStagingBuffer(data.data());
-        //            printBuffer("elements_out", data, NUM_ELEMENTS);
-        testSort(reference, data);
+    void MultiRadixSort::verify() {
+        MultiRadixSortVerifyPass verifyPass(m_gpuContext);
+        verifyPass.create();
+        verifyPass.setBuffers(m_buffers[3].get(), m_buffers[0].get()); // even number of iterations, the result is in buffer 0
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const MultiRadixSortVerifyPass::Result result = verifyPass.verify(NUM_ELEMENTS);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        verifyPass.release();
+        if (!result.isValid()) {
+            throw std::runtime_error("TEST FAILED.");
+        }
+        std::cout << PRINT_PREFIX << "Test passed (GPU verification in " << (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3)) << "[ms])." << std::endl;
     }
 
     void MultiRadixSort::printBuffer(const std::string &label, std::vector<SORT_TYPE> &buffer, uint32_t numElements) {
@@ -118,18 +353,10 @@ namespace engine {
         }
     }
 
-    void MultiRadixSort::generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements) {
-        // https://en.cppreference.com/w/cpp/numeric/random/uniform_int_distribution
-        std::random_device rd;
-        std::mt19937 gen(rd());
-#ifdef SORT_32BIT
-        std::uniform_int_distribution<uint32_t> distrib(0, 0x0FFFFFFF);
-#else
-        std::uniform_int_distribution<uint64_t> distrib(0, 0x0FFFFFFFFFFF);
-#endif
-        for (int i = 0; i < numElements; i++) {
-            buffer.push_back(distrib(gen));
-        }
+    void MultiRadixSort::generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements, KeyGenerator::Distribution distribution) {
+        KeyGenerator generator({.m_distribution = distribution, .m_seed = SEED, .m_keyBits = sizeof(SORT_TYPE) == 4 ? 28U : 44U}, numElements);
+        buffer.resize(numElements);
+        generator.generate(std::span<SORT_TYPE>(buffer));
     }
 
     void MultiRadixSort::generateZeros(std::vector<SORT_TYPE> &buffer, uint32_t numElements) {
@@ -144,19 +371,4 @@ namespace engine {
         std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
         return (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3));
     }
-
-    bool MultiRadixSort::testSort(std::vector<SORT_TYPE> &reference, std::vector<SORT_TYPE> &outBuffer) {
-        if (reference.size() != outBuffer.size()) {
-            std::cerr << PRINT_PREFIX << "reference.size() != outBuffer.size()" << std::endl;
-            throw std::runtime_error("TEST FAILED.");
-        }
-        for (uint32_t i = 0; i < reference.size(); i++) {
-            if (reference[i] != outBuffer[i]) {
-                std::cerr << PRINT_PREFIX << reference[i] << " = reference[" << i << "] != outBuffer[" << i << "] = " << outBuffer[i] << std::endl;
-                throw std::runtime_error("TEST FAILED.");
-            }
-        }
-        std::cout << PRINT_PREFIX << "Test passed." << std::endl;
-        return true;
-    }
 } // namespace engine
\ No newline at end of file
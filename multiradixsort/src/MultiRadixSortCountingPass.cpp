@@ -0,0 +1,137 @@
+#include "MultiRadixSortCountingPass.h"
+#include "MultiRadixSortPass.h"
+#include "shaders/multi_radix_sort_shaders.h"
+
+namespace engine {
+
+    std::vector<std::shared_ptr<Shader>> MultiRadixSortCountingPass::createShaders() {
+        const std::string subgroupSize = "SUBGROUP_SIZE=" + std::to_string(m_gpuContext->getSubgroupSize());
+        std::vector<std::string> scatterDefines{"COUNTING_SCATTER"};
+        if (m_keyValue) {
+            scatterDefines.emplace_back("KEY_VALUE");
+        }
+        const std::string directory = Paths::m_resourceDirectoryPath + "/shaders";
+        return {std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_counting.comp", std::vector<std::string>{"COUNTING_HISTOGRAM"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_counting.comp", std::vector<std::string>{subgroupSize, "COUNTING_REDUCE"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_counting.comp", std::vector<std::string>{subgroupSize, "COUNTING_SCAN"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_counting.comp", std::vector<std::string>{subgroupSize, "COUNTING_SCAN_ADD"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_counting.comp", scatterDefines, MULTI_RADIX_SORT_SHADERS)};
+    }
+
+    void MultiRadixSortCountingPass::setNumElements(uint32_t numElements, uint32_t minKey, uint32_t maxKey, uint32_t numBlocksPerWorkgroup) {
+        if (!isKeyRangeSupported(minKey, maxKey)) {
+            throw std::runtime_error("Failed to set the number of elements, the key range of the counting sort is limited to 2^16 keys!");
+        }
+        const uint32_t numBins = maxKey - minKey + 1;
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        const uint64_t maxWorkgroups = std::min<uint64_t>(std::max(MAX_COUNTERS / numBins, 1U), deviceProperties.limits.maxComputeWorkGroupCount[0]);
+
+        const uint64_t numBlocks = std::max<uint64_t>((static_cast<uint64_t>(numElements) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1);
+        uint64_t numWorkgroups = std::clamp<uint64_t>((numBlocks + numBlocksPerWorkgroup - 1) / std::max(numBlocksPerWorkgroup, 1U), 1, maxWorkgroups);
+        const uint64_t blocksPerWorkgroup = (numBlocks + numWorkgroups - 1) / numWorkgroups;
+        numWorkgroups = (numBlocks + blocksPerWorkgroup - 1) / blocksPerWorkgroup;
+
+        m_pushConstants = {numElements, minKey, numBins, static_cast<uint32_t>(numWorkgroups), static_cast<uint32_t>(blocksPerWorkgroup)};
+        const uint64_t numChunks = (static_cast<uint64_t>(numBins) * numWorkgroups + SCAN_CHUNK - 1) / SCAN_CHUNK;
+        setWorkGroupCount(COUNTING_HISTOGRAM, static_cast<uint32_t>(numWorkgroups), 1, 1);
+        setWorkGroupCount(COUNTING_REDUCE, static_cast<uint32_t>(numChunks), 1, 1);
+        setWorkGroupCount(COUNTING_SCAN, 1, 1, 1);
+        setWorkGroupCount(COUNTING_SCAN_ADD, static_cast<uint32_t>(numChunks), 1, 1);
+        setWorkGroupCount(COUNTING_SCATTER, static_cast<uint32_t>(numWorkgroups), 1, 1);
+    }
+
+    uint32_t MultiRadixSortCountingPass::getPersistentBlocksPerWorkgroup(GPUContext *gpuContext, uint32_t numElements, uint32_t minKey, uint32_t maxKey) {
+        if (!isKeyRangeSupported(minKey, maxKey)) {
+            throw std::runtime_error("Failed to size the persistent workgroups, the key range of the counting sort is limited to 2^16 keys!");
+        }
+        const uint32_t computeUnits = gpuContext->getComputeUnitCount();
+        const uint64_t persistentWorkgroups = computeUnits > 0 ? static_cast<uint64_t>(computeUnits) * MultiRadixSortPass::PERSISTENT_WORKGROUPS_PER_COMPUTE_UNIT : MultiRadixSortPass::PERSISTENT_WORKGROUPS_FALLBACK;
+        const uint64_t numWorkgroups = std::clamp<uint64_t>(MAX_COUNTERS / (maxKey - minKey + 1), 1, persistentWorkgroups);
+        const uint64_t numBlocks = std::max<uint64_t>((static_cast<uint64_t>(numElements) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1);
+        return static_cast<uint32_t>((numBlocks + numWorkgroups - 1) / numWorkgroups);
+    }
+
+    void MultiRadixSortCountingPass::setBuffers(Buffer *keysIn, Buffer *keysOut, Buffer *counters, Buffer *valuesIn, Buffer *valuesOut) {
+        if (m_keyValue && (valuesIn == nullptr || valuesOut == nullptr)) {
+            throw std::runtime_error("Key value pass requires value buffers!");
+        }
+        if (counters->getSizeBytes() < getCountersSizeBytes()) {
+            throw std::runtime_error("Failed to set the buffers, the counters buffer is smaller than getCountersSizeBytes()!");
+        }
+        setStorageBuffer(COUNTING_HISTOGRAM, 0, keysIn);
+        setStorageBuffer(COUNTING_HISTOGRAM, 1, counters);
+        setStorageBuffer(COUNTING_REDUCE, 0, counters);
+        setStorageBuffer(COUNTING_SCAN, 0, counters);
+        setStorageBuffer(COUNTING_SCAN_ADD, 0, counters);
+        setStorageBuffer(COUNTING_SCATTER, 0, keysIn);
+        setStorageBuffer(COUNTING_SCATTER, 1, keysOut);
+        setStorageBuffer(COUNTING_SCATTER, 2, counters);
+        if (m_keyValue) {
+            setStorageBuffer(COUNTING_SCATTER, 3, valuesIn);
+            setStorageBuffer(COUNTING_SCATTER, 4, valuesOut);
+        }
+        m_counters = counters;
+    }
+
+    void MultiRadixSortCountingPass::sort(const std::vector<VkBufferMemoryBarrier> &releaseBarriers) {
+        m_releaseBarriers = releaseBarriers;
+        execute(VK_NULL_HANDLE);
+        m_releaseBarriers.clear();
+        wait();
+        incrementActiveIndex();
+    }
+
+    std::string MultiRadixSortCountingPass::getStageName(uint32_t stageIndex) const {
+        switch (stageIndex) {
+            case COUNTING_HISTOGRAM:
+                return "counting histogram";
+            case COUNTING_REDUCE:
+                return "counting reduce";
+            case COUNTING_SCAN:
+                return "counting scan";
+            case COUNTING_SCAN_ADD:
+                return "counting scan add";
+            default:
+                return "counting scatter";
+        }
+    }
+
+    void MultiRadixSortCountingPass::recordCommands(VkCommandBuffer commandBuffer) {
+        // the histogram of large ranges is accumulated with global atomics
+        vkCmdFillBuffer(commandBuffer, m_counters->getBuffer(), 0, getCountersSizeBytes(), 0);
+        VkMemoryBarrier clearBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+        VkMemoryBarrier memoryBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+        for (const auto stage: {COUNTING_HISTOGRAM, COUNTING_REDUCE, COUNTING_SCAN, COUNTING_SCAN_ADD, COUNTING_SCATTER}) {
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[stage], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+            recordCommandComputeShaderExecution(commandBuffer, stage);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+        }
+        if (!m_releaseBarriers.empty()) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT, {}, 0, nullptr, m_releaseBarriers.size(), m_releaseBarriers.data(), 0, nullptr);
+        }
+    }
+
+    void MultiRadixSortCountingPass::createPipelineLayouts() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = m_descriptorSetLayouts.size();
+        pipelineLayoutInfo.pSetLayouts = m_descriptorSetLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        for (const auto stage: {COUNTING_HISTOGRAM, COUNTING_REDUCE, COUNTING_SCAN, COUNTING_SCAN_ADD, COUNTING_SCATTER}) {
+            if (vkCreatePipelineLayout(m_gpuContext->m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[stage]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline layout!");
+            }
+        }
+    }
+} // namespace engine
@@ -0,0 +1,132 @@
+#include "MultiRadixSortExternal.h"
+
+#include <queue>
+
+namespace engine {
+
+    MultiRadixSortExternal::MultiRadixSortExternal(GPUContext *gpuContext, uint32_t numThreads) : m_gpuContext(gpuContext), m_numThreads(numThreads) {
+    }
+
+    uint32_t MultiRadixSortExternal::getChunkElements(uint64_t numElements, bool keyValue) const {
+        const VkDeviceSize budget = m_gpuContext->getDeviceLocalMemoryBudget();
+        uint64_t chunkElements = static_cast<uint64_t>(static_cast<double>(budget) * MEMORY_BUDGET_FRACTION) / MultiRadixSortPipeline::getDeviceBytesPerElement(keyValue);
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        chunkElements = std::min<uint64_t>(chunkElements, deviceProperties.limits.maxStorageBufferRange / sizeof(SORT_TYPE));
+        if (m_maxChunkElements > 0) {
+            chunkElements = std::min<uint64_t>(chunkElements, m_maxChunkElements);
+        }
+        chunkElements = std::min<uint64_t>(chunkElements, numElements);
+
+        if (chunkElements == 0) {
+            throw std::runtime_error("Not enough device memory for the out-of-core sort!");
+        }
+        return static_cast<uint32_t>(chunkElements);
+    }
+
+    void MultiRadixSortExternal::sort(SORT_TYPE *elements, SORT_TYPE *output, uint64_t numElements) {
+        if (numElements == 0) {
+            return;
+        }
+
+        // split the input into chunks
+        const uint32_t chunkElements = getChunkElements(numElements);
+        const uint64_t numChunks = (numElements + chunkElements - 1) / chunkElements;
+        std::vector<uint32_t> batchSizes(numChunks);
+        std::vector<uint64_t> runOffsets(numChunks + 1);
+        for (uint64_t i = 0; i < numChunks; i++) {
+            runOffsets[i] = i * chunkElements;
+            batchSizes[i] = static_cast<uint32_t>(std::min<uint64_t>(chunkElements, numElements - runOffsets[i]));
+        }
+        runOffsets[numChunks] = numElements;
+        std::cout << PRINT_PREFIX << "Sorting " << numElements << " elements in " << numChunks << " chunk(s) of at most " << chunkElements << " elements." << std::endl;
+
+        // sort the chunks on the gpu back into their place in elements (a chunk is downloaded after its upload), a single chunk is already the result
+        SORT_TYPE *runsTarget = numChunks > 1 ? elements : output;
+
+        MultiRadixSortPipeline pipeline(m_gpuContext, chunkElements);
+        pipeline.create();
+        pipeline.run(
+                batchSizes,
+                [&](uint32_t batchIndex, SORT_TYPE *staged, VALUE_TYPE *, uint32_t count) {
+                    memcpy(staged, elements + runOffsets[batchIndex], count * sizeof(SORT_TYPE));
+                },
+                [&](uint32_t batchIndex, const SORT_TYPE *sorted, const VALUE_TYPE *, uint32_t count) {
+                    memcpy(runsTarget + runOffsets[batchIndex], sorted, count * sizeof(SORT_TYPE));
+                });
+        pipeline.release();
+
+        // merge the sorted runs on the cpu
+        if (numChunks > 1) {
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            mergeRuns(elements, runOffsets, output, m_numThreads);
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            std::cout << PRINT_PREFIX << "Merged " << numChunks << " runs in " << (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3)) << "[ms]." << std::endl;
+        }
+    }
+
+    void MultiRadixSortExternal::mergeRuns(const SORT_TYPE *runs, const std::vector<uint64_t> &runOffsets, SORT_TYPE *output, uint32_t numThreads, const VALUE_TYPE *runValues, VALUE_TYPE *outputValues) {
+        const size_t numRuns = runOffsets.size() - 1;
+        numThreads = std::max(1U, numThreads);
+
+        // choose numThreads-1 splitters from a regular sample of all runs
+        const uint32_t samplesPerRun = 32 * numThreads;
+        std::vector<SORT_TYPE> sample;
+        for (size_t r = 0; r < numRuns; r++) {
+            const uint64_t runLength = runOffsets[r + 1] - runOffsets[r];
+            for (uint32_t j = 0; j < samplesPerRun && runLength > 0; j++) {
+                sample.push_back(runs[runOffsets[r] + runLength * j / samplesPerRun]);
+            }
+        }
+        std::sort(sample.begin(), sample.end());
+
+        // thread t merges the keys in [splitter_t, splitter_t+1) of every run
+        std::vector<std::vector<uint64_t>> bounds(numThreads + 1, std::vector<uint64_t>(numRuns));
+        for (size_t r = 0; r < numRuns; r++) {
+            bounds[0][r] = runOffsets[r];
+            bounds[numThreads][r] = runOffsets[r + 1];
+        }
+        for (uint32_t t = 1; t < numThreads; t++) {
+            const SORT_TYPE splitter = sample[t * sample.size() / numThreads];
+            for (size_t r = 0; r < numRuns; r++) {
+                bounds[t][r] = std::lower_bound(runs + runOffsets[r], runs + runOffsets[r + 1], splitter) - runs;
+            }
+        }
+
+        std::vector<std::thread> threads;
+        uint64_t outputOffset = 0;
+        for (uint32_t t = 0; t < numThreads; t++) {
+            threads.emplace_back(mergeRange, runs, runValues, std::cref(bounds[t]), std::cref(bounds[t + 1]), output + outputOffset, runValues ? outputValues + outputOffset : nullptr);
+            for (size_t r = 0; r < numRuns; r++) {
+                outputOffset += bounds[t + 1][r] - bounds[t][r];
+            }
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+    void MultiRadixSortExternal::mergeRange(const SORT_TYPE *runs, const VALUE_TYPE *runValues, const std::vector<uint64_t> &runBegins, const std::vector<uint64_t> &runEnds, SORT_TYPE *output, VALUE_TYPE *outputValues) {
+        // k-way merge with a min heap of the run heads, ties are resolved by the run index (stable)
+        using Head = std::pair<SORT_TYPE, size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<>> heads;
+        std::vector<uint64_t> positions = runBegins;
+        for (size_t r = 0; r < positions.size(); r++) {
+            if (positions[r] < runEnds[r]) {
+                heads.emplace(runs[positions[r]], r);
+            }
+        }
+        while (!heads.empty()) {
+            const auto [key, r] = heads.top();
+            heads.pop();
+            *output++ = key;
+            if (runValues) {
+                *outputValues++ = runValues[positions[r]];
+            }
+            if (++positions[r] < runEnds[r]) {
+                heads.emplace(runs[positions[r]], r);
+            }
+        }
+    }
+} // namespace engine
@@ -0,0 +1,173 @@
+#include "MultiRadixSortFile.h"
+#include "CpuRadixSort.h"
+
+#include <filesystem>
+#include <sys/stat.h>
+
+namespace engine {
+
+    MultiRadixSortFile::MultiRadixSortFile(GPUContext *gpuContext, uint32_t payloadSizeBytes, uint32_t numThreads) : m_gpuContext(gpuContext), m_payloadSizeBytes(payloadSizeBytes), m_numThreads(numThreads), m_external(gpuContext, numThreads) {
+    }
+
+    void MultiRadixSortFile::sort(const std::string &inputPath, const std::string &outputPath) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        // the output is truncated when it is created, sorting a file into itself would sort an empty input
+        struct stat inputStat{};
+        struct stat outputStat{};
+        if (stat(inputPath.c_str(), &inputStat) == 0 && stat(outputPath.c_str(), &outputStat) == 0 && inputStat.st_dev == outputStat.st_dev && inputStat.st_ino == outputStat.st_ino) {
+            throw std::runtime_error("Failed to sort, the input and the output are the same file!");
+        }
+
+        MappedFile input(inputPath);
+        const uint32_t recordSizeBytes = getRecordSizeBytes();
+        if (input.getSizeBytes() % recordSizeBytes != 0) {
+            throw std::runtime_error("Input file size is not a multiple of the record size!");
+        }
+        const uint64_t numRecords = input.getSizeBytes() / recordSizeBytes;
+        const bool keyValue = m_payloadSizeBytes > 0;
+        if (keyValue && numRecords > std::numeric_limits<VALUE_TYPE>::max()) {
+            throw std::runtime_error("Too many records for the record indices!");
+        }
+        MappedFile output(outputPath, input.getSizeBytes());
+        if (numRecords == 0) {
+            return;
+        }
+        input.advise(MADV_SEQUENTIAL);
+        if (m_gpuContext != nullptr) {
+            sortOnDevice(input, output, numRecords, outputPath);
+        } else {
+            sortOnHost(input, output, numRecords);
+        }
+
+        output.release();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        std::cout << PRINT_PREFIX << "Sorted " << inputPath << " into " << outputPath << " in " << (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3)) << "[ms]." << std::endl;
+    }
+
+    void MultiRadixSortFile::sortOnDevice(MappedFile &input, MappedFile &output, uint64_t numRecords, const std::string &outputPath) {
+        const uint32_t recordSizeBytes = getRecordSizeBytes();
+        const bool keyValue = m_payloadSizeBytes > 0;
+        const auto *inputBytes = static_cast<const uint8_t *>(input.getData());
+        auto *outputBytes = static_cast<uint8_t *>(output.getData());
+
+        // split the input into chunks
+        const uint32_t chunkElements = m_external.getChunkElements(numRecords, keyValue);
+        const uint64_t numChunks = (numRecords + chunkElements - 1) / chunkElements;
+        std::vector<uint32_t> batchSizes(numChunks);
+        std::vector<uint64_t> runOffsets(numChunks + 1);
+        for (uint64_t i = 0; i < numChunks; i++) {
+            runOffsets[i] = i * chunkElements;
+            batchSizes[i] = static_cast<uint32_t>(std::min<uint64_t>(chunkElements, numRecords - runOffsets[i]));
+        }
+        runOffsets[numChunks] = numRecords;
+        std::cout << PRINT_PREFIX << "Sorting " << numRecords << " records of " << recordSizeBytes << " bytes in " << numChunks << " chunk(s) of at most " << chunkElements << " records." << std::endl;
+
+        // runs of multiple chunks: [keys | merged keys | values | merged values], a single chunk is written to the output directly
+        const bool singleChunk = numChunks == 1;
+        std::unique_ptr<MappedFile> runsFile;
+        SORT_TYPE *runKeys = nullptr;
+        SORT_TYPE *mergedKeys = nullptr;
+        VALUE_TYPE *runValues = nullptr;
+        VALUE_TYPE *mergedValues = nullptr;
+        if (!singleChunk) {
+            const uint64_t runsSizeBytes = keyValue ? 2 * numRecords * (sizeof(SORT_TYPE) + sizeof(VALUE_TYPE)) : numRecords * sizeof(SORT_TYPE);
+            runsFile = std::make_unique<MappedFile>(outputPath + ".runs", runsSizeBytes);
+            std::filesystem::remove(runsFile->getPath()); // the mapping stays valid until it is released
+            runKeys = static_cast<SORT_TYPE *>(runsFile->getData());
+            if (keyValue) {
+                mergedKeys = runKeys + numRecords;
+                runValues = reinterpret_cast<VALUE_TYPE *>(mergedKeys + numRecords);
+                mergedValues = runValues + numRecords;
+            }
+        }
+
+        // sort the chunks on the gpu
+        MultiRadixSortPipeline pipeline(m_gpuContext, chunkElements, keyValue);
+        pipeline.create();
+        pipeline.run(
+                batchSizes,
+                [&](uint32_t batchIndex, SORT_TYPE *keys, VALUE_TYPE *values, uint32_t count) {
+                    const uint64_t first = runOffsets[batchIndex];
+                    if (!keyValue) {
+                        memcpy(keys, inputBytes + first * sizeof(SORT_TYPE), count * sizeof(SORT_TYPE));
+                        return;
+                    }
+                    for (uint32_t i = 0; i < count; i++) {
+                        memcpy(&keys[i], inputBytes + (first + i) * recordSizeBytes, sizeof(SORT_TYPE));
+                        values[i] = static_cast<VALUE_TYPE>(first + i);
+                    }
+                },
+                [&](uint32_t batchIndex, const SORT_TYPE *keys, const VALUE_TYPE *values, uint32_t count) {
+                    if (singleChunk) {
+                        if (keyValue) {
+                            input.advise(MADV_RANDOM);
+                            gather(inputBytes, values, outputBytes, count);
+                        } else {
+                            memcpy(outputBytes, keys, count * sizeof(SORT_TYPE));
+                        }
+                        return;
+                    }
+                    const uint64_t first = runOffsets[batchIndex];
+                    memcpy(runKeys + first, keys, count * sizeof(SORT_TYPE));
+                    if (keyValue) {
+                        memcpy(runValues + first, values, count * sizeof(VALUE_TYPE));
+                    }
+                });
+        pipeline.release();
+
+        // merge the sorted runs on the cpu
+        if (!singleChunk) {
+            if (keyValue) {
+                MultiRadixSortExternal::mergeRuns(runKeys, runOffsets, mergedKeys, m_numThreads, runValues, mergedValues);
+                input.advise(MADV_RANDOM);
+                gather(inputBytes, mergedValues, outputBytes, numRecords);
+            } else {
+                MultiRadixSortExternal::mergeRuns(runKeys, runOffsets, reinterpret_cast<SORT_TYPE *>(outputBytes), m_numThreads);
+            }
+            runsFile->release();
+        }
+    }
+
+    void MultiRadixSortFile::sortOnHost(MappedFile &input, MappedFile &output, uint64_t numRecords) {
+        const uint32_t recordSizeBytes = getRecordSizeBytes();
+        const auto *inputBytes = static_cast<const uint8_t *>(input.getData());
+        auto *outputBytes = static_cast<uint8_t *>(output.getData());
+        std::cout << PRINT_PREFIX << "Sorting " << numRecords << " records of " << recordSizeBytes << " bytes on the cpu." << std::endl;
+
+        CpuRadixSort cpuRadixSort(m_numThreads);
+        if (m_payloadSizeBytes == 0) {
+            // the keys are sorted in the mapped output file
+            memcpy(outputBytes, inputBytes, numRecords * sizeof(SORT_TYPE));
+            cpuRadixSort.sortInPlace(std::span<SORT_TYPE>(reinterpret_cast<SORT_TYPE *>(outputBytes), numRecords));
+            return;
+        }
+        std::vector<SORT_TYPE> keys(numRecords);
+        std::vector<VALUE_TYPE> indices(numRecords);
+        for (uint64_t i = 0; i < numRecords; i++) {
+            memcpy(&keys[i], inputBytes + i * recordSizeBytes, sizeof(SORT_TYPE));
+            indices[i] = static_cast<VALUE_TYPE>(i);
+        }
+        cpuRadixSort.sortInPlace(keys, indices);
+        input.advise(MADV_RANDOM);
+        gather(inputBytes, indices.data(), outputBytes, numRecords);
+    }
+
+    void MultiRadixSortFile::gather(const uint8_t *input, const VALUE_TYPE *indices, uint8_t *output, uint64_t numRecords) const {
+        const uint32_t recordSizeBytes = getRecordSizeBytes();
+        const uint64_t recordsPerThread = (numRecords + m_numThreads - 1) / m_numThreads;
+
+        std::vector<std::thread> threads;
+        for (uint64_t first = 0; first < numRecords; first += recordsPerThread) {
+            const uint64_t last = std::min(numRecords, first + recordsPerThread);
+            threads.emplace_back([=]() {
+                for (uint64_t i = first; i < last; i++) {
+                    memcpy(output + i * recordSizeBytes, input + static_cast<uint64_t>(indices[i]) * recordSizeBytes, recordSizeBytes);
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+} // namespace engine
@@ -0,0 +1,117 @@
+#include "MultiRadixSortGatherPass.h"
+#include "shaders/multi_radix_sort_shaders.h"
+
+namespace engine {
+
+    void MultiRadixSortGatherPass::create() {
+        if (!m_gpuContext->supportsLargeBuffers()) {
+            throw std::runtime_error("Failed to create gather pass, the device does not support 64-bit integers and buffer device addresses!");
+        }
+        ComputePass::create();
+    }
+
+    void MultiRadixSortGatherPass::release() {
+        if (m_columnsBuffer) {
+            m_columnsBuffer->release();
+            m_columnsBuffer = nullptr;
+        }
+        ComputePass::release();
+    }
+
+    std::vector<std::shared_ptr<Shader>> MultiRadixSortGatherPass::createShaders() {
+        return {std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort_gather.comp", std::vector<std::string>{"IOTA"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort_gather.comp", std::vector<std::string>{}, MULTI_RADIX_SORT_SHADERS)};
+    }
+
+    void MultiRadixSortGatherPass::setIndices(Buffer *indices) {
+        setStorageBuffer(IOTA, 0, indices);
+    }
+
+    void MultiRadixSortGatherPass::setColumns(Buffer *permutation, const std::vector<Column> &columns) {
+        if (columns.empty()) {
+            throw std::runtime_error("Failed to set the columns, at least one column is required!");
+        }
+        std::vector<ColumnDescriptor> descriptors;
+        for (const auto &column: columns) {
+            if (column.m_widthBytes == 0 || column.m_widthBytes % 4 != 0) {
+                throw std::runtime_error("Failed to set the columns, the width of a column has to be a multiple of 4 bytes!");
+            }
+            descriptors.push_back({column.m_src->getDeviceAddress(), column.m_dst->getDeviceAddress(), column.m_widthBytes / 4, {}});
+        }
+
+        const VkDeviceSize sizeBytes = descriptors.size() * sizeof(ColumnDescriptor);
+        if (!m_columnsBuffer || m_columnsBuffer->getSizeBytes() < sizeBytes) {
+            if (m_columnsBuffer) {
+                m_columnsBuffer->release();
+            }
+            m_columnsBuffer = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = sizeBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_name = "radixSortGather.columns"});
+        }
+        m_columnsBuffer->updateHostMemory(sizeBytes, descriptors.data());
+        m_numColumns = static_cast<uint32_t>(descriptors.size());
+
+        setStorageBuffer(GATHER, 0, permutation);
+        setStorageBuffer(GATHER, 1, m_columnsBuffer.get());
+    }
+
+    void MultiRadixSortGatherPass::prepareIndices(uint32_t numElements) {
+        m_stage = IOTA;
+        m_pushConstants = {numElements, 0};
+        setInvocationCount(IOTA, numElements);
+    }
+
+    void MultiRadixSortGatherPass::prepareGather(uint32_t numElements) {
+        if (m_numColumns == 0) {
+            throw std::runtime_error("Failed to gather, no columns set!");
+        }
+        m_stage = GATHER;
+        m_pushConstants = {numElements, m_numColumns};
+        setInvocationCount(GATHER, numElements); // the rows of the widest columns are covered by the grid stride loop
+    }
+
+    void MultiRadixSortGatherPass::writeIndices(uint32_t numElements) {
+        prepareIndices(numElements);
+        execute(VK_NULL_HANDLE);
+        wait();
+        incrementActiveIndex();
+    }
+
+    void MultiRadixSortGatherPass::gather(uint32_t numElements) {
+        prepareGather(numElements);
+        execute(VK_NULL_HANDLE);
+        wait();
+        incrementActiveIndex();
+    }
+
+    void MultiRadixSortGatherPass::setInvocationCount(ComputeStage stage, uint64_t numInvocations) {
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        const uint64_t elementsPerWorkgroup = static_cast<uint64_t>(WORKGROUP_SIZE) * ELEMENTS_PER_INVOCATION;
+        const uint64_t numWorkgroups = std::clamp<uint64_t>((numInvocations + elementsPerWorkgroup - 1) / elementsPerWorkgroup, 1, deviceProperties.limits.maxComputeWorkGroupCount[0]);
+        setWorkGroupCount(stage, static_cast<uint32_t>(numWorkgroups), 1, 1);
+    }
+
+    void MultiRadixSortGatherPass::recordCommands(VkCommandBuffer commandBuffer) {
+        vkCmdPushConstants(commandBuffer, m_pipelineLayouts[m_stage], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+        recordCommandComputeShaderExecution(commandBuffer, m_stage);
+    }
+
+    void MultiRadixSortGatherPass::createPipelineLayouts() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = m_descriptorSetLayouts.size();
+        pipelineLayoutInfo.pSetLayouts = m_descriptorSetLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        for (const auto stage: {IOTA, GATHER}) {
+            if (vkCreatePipelineLayout(m_gpuContext->m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[stage]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline layout!");
+            }
+        }
+    }
+} // namespace engine
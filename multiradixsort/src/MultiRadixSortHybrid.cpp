@@ -0,0 +1,120 @@
+#include "MultiRadixSortHybrid.h"
+
+namespace engine {
+
+    namespace {
+        double getElapsedMs(std::chrono::steady_clock::time_point begin) {
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * std::pow(10, -3);
+        }
+    } // namespace
+
+    MultiRadixSortHybrid::MultiRadixSortHybrid(GPUContext *gpuContext, uint32_t numThreads) : m_gpuContext(gpuContext), m_cpuRadixSort(numThreads) {
+    }
+
+    void MultiRadixSortHybrid::sortInPlace(std::span<SORT_TYPE> elements) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const uint64_t numElements = elements.size();
+        m_timings = {};
+
+        if (m_gpuContext == nullptr || numElements < MIN_HYBRID_ELEMENTS) {
+            m_cpuRadixSort.sortInPlace(elements);
+            m_timings.m_cpuElements = numElements;
+            m_timings.m_cpuMs = m_timings.m_totalMs = getElapsedMs(begin);
+            return;
+        }
+
+        const uint64_t gpuElements = static_cast<uint64_t>(static_cast<double>(numElements) * m_gpuFraction);
+        const std::span<SORT_TYPE> gpuPart = elements.first(gpuElements);
+        const std::span<SORT_TYPE> cpuPart = elements.subspan(gpuElements);
+        m_timings.m_gpuElements = gpuPart.size();
+        m_timings.m_cpuElements = cpuPart.size();
+        MultiRadixSortPass *pass = getPass(gpuElements); // the shaders are compiled outside of the measurement
+
+        // the gpu part is uploaded, sorted and downloaded by a separate thread while the thread pool sorts the cpu part
+        std::exception_ptr gpuException;
+        std::thread gpuThread([&]() {
+            std::chrono::steady_clock::time_point gpuBegin = std::chrono::steady_clock::now();
+            try {
+                MultiRadixSort::sortInPlace(m_gpuContext, gpuPart, false, pass);
+            } catch (...) {
+                gpuException = std::current_exception();
+            }
+            m_timings.m_gpuMs = getElapsedMs(gpuBegin);
+        });
+        std::chrono::steady_clock::time_point cpuBegin = std::chrono::steady_clock::now();
+        m_cpuRadixSort.sortInPlace(cpuPart);
+        m_timings.m_cpuMs = getElapsedMs(cpuBegin);
+        gpuThread.join();
+        if (gpuException) {
+            std::rethrow_exception(gpuException);
+        }
+
+        std::chrono::steady_clock::time_point mergeBegin = std::chrono::steady_clock::now();
+        ThreadPool &threadPool = m_cpuRadixSort.getThreadPool();
+        std::unique_ptr<SORT_TYPE[]> merged(new SORT_TYPE[numElements]);
+        mergePath(gpuPart.data(), gpuPart.size(), cpuPart.data(), cpuPart.size(), merged.get(), threadPool);
+        const uint32_t numThreads = threadPool.getNumThreads();
+        threadPool.parallelFor(numThreads, [&](uint32_t part) {
+            const uint64_t first = numElements * part / numThreads;
+            const uint64_t last = numElements * (part + 1) / numThreads;
+            memcpy(elements.data() + first, merged.get() + first, (last - first) * sizeof(SORT_TYPE));
+        });
+        m_timings.m_mergeMs = getElapsedMs(mergeBegin);
+        m_timings.m_totalMs = getElapsedMs(begin);
+
+        // share at which both sides would have finished at the same time, blended with the previous share
+        const double gpuRate = static_cast<double>(gpuPart.size()) / std::max(m_timings.m_gpuMs, 1e-3);
+        const double cpuRate = static_cast<double>(cpuPart.size()) / std::max(m_timings.m_cpuMs, 1e-3);
+        setGpuFraction((1.0 - ADAPTATION_RATE) * m_gpuFraction + ADAPTATION_RATE * gpuRate / (gpuRate + cpuRate));
+        std::cout << PRINT_PREFIX << "Sorted " << gpuPart.size() << " elements on the gpu in " << m_timings.m_gpuMs << "[ms] and " << cpuPart.size() << " on the cpu in " << m_timings.m_cpuMs << "[ms], merged in " << m_timings.m_mergeMs
+                  << "[ms], next gpu fraction " << m_gpuFraction << "." << std::endl;
+    }
+
+    void MultiRadixSortHybrid::release() {
+        for (auto &pass: {m_pass, m_passLarge}) {
+            if (pass) {
+                pass->release();
+            }
+        }
+        m_pass = nullptr;
+        m_passLarge = nullptr;
+    }
+
+    void MultiRadixSortHybrid::mergePath(const SORT_TYPE *a, uint64_t sizeA, const SORT_TYPE *b, uint64_t sizeB, SORT_TYPE *output, ThreadPool &threadPool) {
+        const uint64_t size = sizeA + sizeB;
+        const uint32_t numParts = threadPool.getNumThreads();
+
+        // number of elements of a among the first diagonal elements of the output (equal elements are taken from a first)
+        const auto splitA = [&](uint64_t diagonal) {
+            uint64_t low = diagonal > sizeB ? diagonal - sizeB : 0;
+            uint64_t high = std::min(diagonal, sizeA);
+            while (low < high) {
+                const uint64_t middle = low + (high - low) / 2;
+                if (a[middle] <= b[diagonal - middle - 1]) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return low;
+        };
+
+        threadPool.parallelFor(numParts, [&](uint32_t part) {
+            const uint64_t first = size * part / numParts;
+            const uint64_t last = size * (part + 1) / numParts;
+            const uint64_t firstA = splitA(first);
+            const uint64_t lastA = splitA(last);
+            std::merge(a + firstA, a + lastA, b + (first - firstA), b + (last - lastA), output + first);
+        });
+    }
+
+    MultiRadixSortPass *MultiRadixSortHybrid::getPass(uint64_t numElements) {
+        const bool largeElementCount = MultiRadixSortPass::requiresLargeElementCount(m_gpuContext, numElements);
+        auto &pass = largeElementCount ? m_passLarge : m_pass;
+        if (!pass) {
+            pass = std::make_shared<MultiRadixSortPass>(m_gpuContext, false, largeElementCount);
+            pass->create();
+        }
+        return pass.get();
+    }
+} // namespace engine
@@ -0,0 +1,89 @@
+#include "MultiRadixSortMortonPass.h"
+#include "shaders/multi_radix_sort_shaders.h"
+
+namespace engine {
+
+    std::vector<std::shared_ptr<Shader>> MultiRadixSortMortonPass::createShaders() {
+        const std::string directory = Paths::m_resourceDirectoryPath + "/shaders";
+        return {std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_histograms.comp", std::vector<std::string>{"MORTON_CODES"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort.comp", std::vector<std::string>{"SUBGROUP_SIZE=" + std::to_string(m_gpuContext->getSubgroupSize()), "KEY_VALUE", "MORTON_CODES"}, MULTI_RADIX_SORT_SHADERS)};
+    }
+
+    void MultiRadixSortMortonPass::setNumElements(uint32_t numPrimitives, uint32_t numBlocksPerWorkgroup) {
+        const uint64_t elementsPerWorkgroup = static_cast<uint64_t>(numBlocksPerWorkgroup) * MultiRadixSortPass::WORKGROUP_SIZE;
+        const uint32_t numWorkgroups = static_cast<uint32_t>((numPrimitives + elementsPerWorkgroup - 1) / elementsPerWorkgroup);
+        m_pushConstants = {numPrimitives, 0, numWorkgroups, numBlocksPerWorkgroup};
+        setWorkGroupCount(MORTON_HISTOGRAMS, numWorkgroups, 1, 1);
+        setWorkGroupCount(MORTON_SCATTER, numWorkgroups, 1, 1);
+    }
+
+    void MultiRadixSortMortonPass::setBuffers(MultiRadixSortPass *sortPass, Buffer *aabbs, Buffer *sceneBounds, Buffer *keys0, Buffer *keys1, Buffer *histograms, Buffer *values0, Buffer *values1) {
+        if (!sortPass->isKeyValue() || sortPass->isLargeElementCount()) {
+            throw std::runtime_error("Failed to set the buffers, the morton code sort requires a key value pass with 32-bit indices!");
+        }
+        m_sortPass = sortPass;
+
+        setStorageBuffer(MORTON_HISTOGRAMS, 0, aabbs);
+        setStorageBuffer(MORTON_HISTOGRAMS, 1, histograms);
+        setStorageBuffer(MORTON_HISTOGRAMS, 2, sceneBounds);
+        setStorageBuffer(MORTON_SCATTER, 0, aabbs);
+        setStorageBuffer(MORTON_SCATTER, 1, keys1);
+        setStorageBuffer(MORTON_SCATTER, 2, histograms);
+        setStorageBuffer(MORTON_SCATTER, 4, values1);
+        setStorageBuffer(MORTON_SCATTER, 5, sceneBounds);
+
+        // the remaining three iterations start in keys1 and values1 and end in keys0 and values0
+        m_sortPass->setBuffers(keys1, keys0, histograms, values1, values0);
+    }
+
+    void MultiRadixSortMortonPass::recordSort(VkCommandBuffer commandBuffer) {
+        record(commandBuffer);
+        m_sortPass->setFirstDigit(1);
+        m_sortPass->recordSort(commandBuffer, NUM_ITERATIONS - 1);
+        m_sortPass->setFirstDigit(0);
+        m_sortPass->incrementActiveIndex(); // odd number of iterations, back to the descriptor sets of setBuffers for the next sort
+    }
+
+    SubmitHandle MultiRadixSortMortonPass::submitSort(const std::vector<SubmitHandle> &waitHandles) {
+        return submitCommands([this](VkCommandBuffer commandBuffer) {
+            recordSort(commandBuffer);
+        }, waitHandles);
+    }
+
+    void MultiRadixSortMortonPass::sort() {
+        submitSort().wait();
+    }
+
+    std::string MultiRadixSortMortonPass::getStageName(uint32_t stageIndex) const {
+        return stageIndex == MORTON_HISTOGRAMS ? "morton histograms" : "morton scatter";
+    }
+
+    void MultiRadixSortMortonPass::recordCommands(VkCommandBuffer commandBuffer) {
+        VkMemoryBarrier memoryBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT};
+        for (const auto stage: {MORTON_HISTOGRAMS, MORTON_SCATTER}) {
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[stage], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+            recordCommandComputeShaderExecution(commandBuffer, stage);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+        }
+    }
+
+    void MultiRadixSortMortonPass::createPipelineLayouts() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = m_descriptorSetLayouts.size();
+        pipelineLayoutInfo.pSetLayouts = m_descriptorSetLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        for (const auto stage: {MORTON_HISTOGRAMS, MORTON_SCATTER}) {
+            if (vkCreatePipelineLayout(m_gpuContext->m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[stage]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline layout!");
+            }
+        }
+    }
+} // namespace engine
@@ -0,0 +1,217 @@
+#include "MultiRadixSortMultiDevice.h"
+
+namespace engine {
+
+    namespace {
+        double getElapsedMs(std::chrono::steady_clock::time_point begin) {
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * std::pow(10, -3);
+        }
+
+        // number of splitters <= key, the splitters are sorted and few
+        uint32_t findBucket(const std::vector<SORT_TYPE> &splitters, SORT_TYPE key) {
+            uint32_t bucket = 0;
+            for (const SORT_TYPE splitter: splitters) {
+                bucket += key >= splitter ? 1 : 0;
+            }
+            return bucket;
+        }
+    } // namespace
+
+    MultiRadixSortMultiDevice::MultiRadixSortMultiDevice(std::vector<GPUContext *> gpuContexts, uint32_t numThreads)
+        : m_gpuContexts(std::move(gpuContexts)), m_cpuRadixSort(numThreads), m_passes(m_gpuContexts.size()), m_passesLarge(m_gpuContexts.size()) {
+        if (m_gpuContexts.empty()) {
+            throw std::runtime_error("Failed to create the multi device sort, no devices!");
+        }
+        setWeights(std::vector<double>(m_gpuContexts.size(), 1.0));
+    }
+
+    void MultiRadixSortMultiDevice::setWeights(const std::vector<double> &weights) {
+        if (weights.size() != m_gpuContexts.size()) {
+            throw std::runtime_error("Failed to set the weights, one weight per device is required!");
+        }
+        m_weights.resize(weights.size());
+        double sum = 0.0;
+        for (uint32_t i = 0; i < weights.size(); i++) {
+            m_weights[i] = std::max(weights[i], 0.0);
+            sum += m_weights[i];
+        }
+        for (auto &weight: m_weights) {
+            weight = sum > 0.0 ? std::max(weight / sum, MIN_WEIGHT) : 1.0 / static_cast<double>(m_weights.size());
+        }
+        sum = std::accumulate(m_weights.begin(), m_weights.end(), 0.0);
+        for (auto &weight: m_weights) {
+            weight /= sum;
+        }
+    }
+
+    void MultiRadixSortMultiDevice::sortInPlace(std::span<SORT_TYPE> elements) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const uint64_t numElements = elements.size();
+        const auto numDevices = static_cast<uint32_t>(m_gpuContexts.size());
+        m_timings = {};
+        m_timings.m_devices.resize(numDevices);
+
+        if (numDevices == 1 || numElements < MIN_MULTI_DEVICE_ELEMENTS) {
+            MultiRadixSort::sortInPlace(m_gpuContexts[0], elements, false, getPass(0, numElements));
+            m_timings.m_devices[0] = {numElements, getElapsedMs(begin)};
+            m_timings.m_totalMs = getElapsedMs(begin);
+            return;
+        }
+        ThreadPool &threadPool = m_cpuRadixSort.getThreadPool();
+
+        // every device owns a key range, the ranges are contiguous in the partitioned copy
+        std::chrono::steady_clock::time_point partitionBegin = std::chrono::steady_clock::now();
+        const std::vector<SORT_TYPE> splitters = selectSplitters(elements, m_weights);
+        std::unique_ptr<SORT_TYPE[]> partitioned(new SORT_TYPE[numElements]);
+        const std::vector<uint64_t> bucketOffsets = partition(elements, partitioned.get(), splitters, threadPool);
+        m_timings.m_partitionMs = getElapsedMs(partitionBegin);
+
+        // one host thread per device uploads, sorts and downloads its range (host staging, the contexts are independent devices)
+        std::vector<MultiRadixSortPass *> passes(numDevices);
+        for (uint32_t device = 0; device < numDevices; device++) {
+            passes[device] = getPass(device, bucketOffsets[device + 1] - bucketOffsets[device]); // the shaders are compiled outside of the threads
+        }
+        std::vector<std::exception_ptr> exceptions(numDevices);
+        std::vector<std::thread> threads;
+        for (uint32_t device = 0; device < numDevices; device++) {
+            threads.emplace_back([&, device]() {
+                std::chrono::steady_clock::time_point deviceBegin = std::chrono::steady_clock::now();
+                const std::span<SORT_TYPE> range(partitioned.get() + bucketOffsets[device], bucketOffsets[device + 1] - bucketOffsets[device]);
+                try {
+                    MultiRadixSort::sortInPlace(m_gpuContexts[device], range, false, passes[device]);
+                } catch (...) {
+                    exceptions[device] = std::current_exception();
+                }
+                m_timings.m_devices[device] = {range.size(), getElapsedMs(deviceBegin)};
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        for (const auto &exception: exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // the sorted ranges are in key order
+        std::chrono::steady_clock::time_point copyBegin = std::chrono::steady_clock::now();
+        const uint32_t numThreads = threadPool.getNumThreads();
+        threadPool.parallelFor(numThreads, [&](uint32_t part) {
+            const uint64_t first = numElements * part / numThreads;
+            const uint64_t last = numElements * (part + 1) / numThreads;
+            memcpy(elements.data() + first, partitioned.get() + first, (last - first) * sizeof(SORT_TYPE));
+        });
+        m_timings.m_copyMs = getElapsedMs(copyBegin);
+        m_timings.m_totalMs = getElapsedMs(begin);
+
+        // shares at which all devices would have finished at the same time, blended with the previous shares
+        // (devices without elements in this run keep their share)
+        std::vector<double> rates(numDevices, 0.0);
+        double rateSum = 0.0;
+        double measuredWeightSum = 0.0;
+        for (uint32_t device = 0; device < numDevices; device++) {
+            const auto &timings = m_timings.m_devices[device];
+            if (timings.m_elements > 0) {
+                rates[device] = static_cast<double>(timings.m_elements) / std::max(timings.m_sortMs, 1e-3);
+                rateSum += rates[device];
+                measuredWeightSum += m_weights[device];
+            }
+        }
+        std::vector<double> weights = m_weights;
+        for (uint32_t device = 0; device < numDevices; device++) {
+            if (rates[device] > 0.0) {
+                weights[device] = (1.0 - ADAPTATION_RATE) * m_weights[device] + ADAPTATION_RATE * measuredWeightSum * rates[device] / rateSum;
+            }
+        }
+        setWeights(weights);
+
+        std::cout << PRINT_PREFIX << "Sorted " << numElements << " elements on " << numDevices << " devices in " << m_timings.m_totalMs << "[ms] (partition " << m_timings.m_partitionMs << "[ms], copy " << m_timings.m_copyMs << "[ms]):";
+        for (uint32_t device = 0; device < numDevices; device++) {
+            std::cout << " [" << device << "] " << m_timings.m_devices[device].m_elements << " in " << m_timings.m_devices[device].m_sortMs << "[ms]";
+        }
+        std::cout << "." << std::endl;
+    }
+
+    void MultiRadixSortMultiDevice::release() {
+        for (auto *passes: {&m_passes, &m_passesLarge}) {
+            for (auto &pass: *passes) {
+                if (pass) {
+                    pass->release();
+                }
+                pass = nullptr;
+            }
+        }
+    }
+
+    std::vector<SORT_TYPE> MultiRadixSortMultiDevice::selectSplitters(std::span<const SORT_TYPE> input, const std::vector<double> &weights) {
+        const auto numBuckets = static_cast<uint32_t>(weights.size());
+        if (numBuckets <= 1 || input.empty()) {
+            return {};
+        }
+        // evenly spread positions with a deterministic jitter, sorted inputs are not sampled at a fixed stride only
+        const uint64_t numSamples = std::min<uint64_t>(static_cast<uint64_t>(NUM_SAMPLES_PER_BUCKET) * numBuckets, input.size());
+        std::vector<SORT_TYPE> samples(numSamples);
+        const uint64_t stride = input.size() / numSamples;
+        const KeyGenerator jitterGenerator({}, numSamples);
+        for (uint64_t i = 0; i < numSamples; i++) {
+            const uint64_t jitter = stride > 1 ? jitterGenerator.random(i, 0) % stride : 0;
+            samples[i] = input[i * stride + jitter];
+        }
+        std::sort(samples.begin(), samples.end());
+
+        std::vector<SORT_TYPE> splitters(numBuckets - 1);
+        const double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+        double cumulativeWeight = 0.0;
+        for (uint32_t i = 0; i + 1 < numBuckets; i++) {
+            cumulativeWeight += weights[i] / weightSum;
+            splitters[i] = samples[std::min(numSamples - 1, static_cast<uint64_t>(cumulativeWeight * static_cast<double>(numSamples)))];
+        }
+        return splitters;
+    }
+
+    std::vector<uint64_t> MultiRadixSortMultiDevice::partition(std::span<const SORT_TYPE> input, SORT_TYPE *output, const std::vector<SORT_TYPE> &splitters, ThreadPool &threadPool) {
+        const uint64_t numElements = input.size();
+        const auto numBuckets = static_cast<uint32_t>(splitters.size() + 1);
+        const uint32_t numParts = threadPool.getNumThreads();
+
+        // counts of every part and bucket, then the offsets of every part within every bucket (stable)
+        std::vector<uint64_t> counts(static_cast<size_t>(numParts) * numBuckets, 0);
+        threadPool.parallelFor(numParts, [&](uint32_t part) {
+            uint64_t *partCounts = counts.data() + static_cast<size_t>(part) * numBuckets;
+            for (uint64_t i = numElements * part / numParts; i < numElements * (part + 1) / numParts; i++) {
+                partCounts[findBucket(splitters, input[i])]++;
+            }
+        });
+        std::vector<uint64_t> bucketOffsets(numBuckets + 1, 0);
+        uint64_t offset = 0;
+        for (uint32_t bucket = 0; bucket < numBuckets; bucket++) {
+            bucketOffsets[bucket] = offset;
+            for (uint32_t part = 0; part < numParts; part++) {
+                const uint64_t count = counts[static_cast<size_t>(part) * numBuckets + bucket];
+                counts[static_cast<size_t>(part) * numBuckets + bucket] = offset;
+                offset += count;
+            }
+        }
+        bucketOffsets[numBuckets] = offset;
+
+        threadPool.parallelFor(numParts, [&](uint32_t part) {
+            uint64_t *partOffsets = counts.data() + static_cast<size_t>(part) * numBuckets;
+            for (uint64_t i = numElements * part / numParts; i < numElements * (part + 1) / numParts; i++) {
+                const SORT_TYPE key = input[i];
+                output[partOffsets[findBucket(splitters, key)]++] = key;
+            }
+        });
+        return bucketOffsets;
+    }
+
+    MultiRadixSortPass *MultiRadixSortMultiDevice::getPass(uint32_t device, uint64_t numElements) {
+        const bool largeElementCount = MultiRadixSortPass::requiresLargeElementCount(m_gpuContexts[device], numElements);
+        auto &pass = largeElementCount ? m_passesLarge[device] : m_passes[device];
+        if (!pass) {
+            pass = std::make_shared<MultiRadixSortPass>(m_gpuContexts[device], false, largeElementCount);
+            pass->create();
+        }
+        return pass.get();
+    }
+} // namespace engine
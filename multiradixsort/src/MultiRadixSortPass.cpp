@@ -1,22 +1,190 @@
 #include "MultiRadixSortPass.h"
+#include "shaders/multi_radix_sort_shaders.h"
 
 namespace engine {
 
     std::vector<std::shared_ptr<Shader>> MultiRadixSortPass::createShaders() {
-        return {std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort_histograms.comp"),
-                std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort.comp")};
+        std::vector<std::string> histogramsDefines;
+        std::vector<std::string> sortDefines{"SUBGROUP_SIZE=" + std::to_string(m_gpuContext->getSubgroupSize())};
+        if (m_largeElementCount) {
+            histogramsDefines.emplace_back("LARGE_ELEMENT_COUNT");
+            sortDefines.emplace_back("LARGE_ELEMENT_COUNT");
+        }
+        if (m_keyValue) {
+            sortDefines.emplace_back("KEY_VALUE");
+        }
+        return {std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort_histograms.comp", histogramsDefines, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort.comp", sortDefines, MULTI_RADIX_SORT_SHADERS)};
+    }
+
+    void MultiRadixSortPass::setNumElements(uint64_t numElements, uint32_t numBlocksPerWorkgroup) {
+        if (!m_largeElementCount && numElements > UINT32_MAX) {
+            throw std::runtime_error("Failed to set the number of elements, more than 2^32 elements require the large element count pass!");
+        }
+        // the histogram of a workgroup counts up to numBlocksPerWorkgroup * WORKGROUP_SIZE elements in 32 bits
+        if (static_cast<uint64_t>(numBlocksPerWorkgroup) * WORKGROUP_SIZE > UINT32_MAX) {
+            throw std::runtime_error("Failed to set the number of elements, too many blocks per workgroup!");
+        }
+        m_numElements = numElements;
+        const uint64_t elementsPerWorkgroup = static_cast<uint64_t>(numBlocksPerWorkgroup) * WORKGROUP_SIZE;
+        const uint64_t numWorkgroups = (numElements + elementsPerWorkgroup - 1) / elementsPerWorkgroup;
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        if (numWorkgroups > deviceProperties.limits.maxComputeWorkGroupCount[0]) {
+            throw std::runtime_error("Failed to set the number of elements, too many workgroups (use more blocks per workgroup)!");
+        }
+        setWorkGroupCount(RADIX_SORT_HISTOGRAMS, static_cast<uint32_t>(numWorkgroups), 1, 1);
+        setWorkGroupCount(RADIX_SORT, static_cast<uint32_t>(numWorkgroups), 1, 1);
+
+        m_pushConstantsHistogram.g_num_elements = static_cast<uint32_t>(numElements);
+        m_pushConstantsHistogram.g_num_workgroups = static_cast<uint32_t>(numWorkgroups);
+        m_pushConstantsHistogram.g_num_blocks_per_workgroup = numBlocksPerWorkgroup;
+        m_pushConstants.g_num_elements = static_cast<uint32_t>(numElements);
+        m_pushConstants.g_num_workgroups = static_cast<uint32_t>(numWorkgroups);
+        m_pushConstants.g_num_blocks_per_workgroup = numBlocksPerWorkgroup;
+        m_pushConstantsLarge.g_num_elements = numElements;
+        m_pushConstantsLarge.g_num_workgroups = static_cast<uint32_t>(numWorkgroups);
+        m_pushConstantsLarge.g_num_blocks_per_workgroup = numBlocksPerWorkgroup;
+    }
+
+    uint32_t MultiRadixSortPass::getPersistentBlocksPerWorkgroup(GPUContext *gpuContext, uint64_t numElements) {
+        const uint32_t computeUnits = gpuContext->getComputeUnitCount();
+        const uint64_t numWorkgroups = computeUnits > 0 ? computeUnits * PERSISTENT_WORKGROUPS_PER_COMPUTE_UNIT : PERSISTENT_WORKGROUPS_FALLBACK;
+        const uint64_t numBlocks = (numElements + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+        const uint64_t numBlocksPerWorkgroup = (numBlocks + numWorkgroups - 1) / numWorkgroups;
+        return static_cast<uint32_t>(std::clamp<uint64_t>(numBlocksPerWorkgroup, 1, UINT32_MAX / WORKGROUP_SIZE));
+    }
+
+    bool MultiRadixSortPass::requiresLargeElementCount(GPUContext *gpuContext, uint64_t numElements) {
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(gpuContext->m_physicalDevice, &deviceProperties);
+        return numElements > UINT32_MAX || numElements * sizeof(uint32_t) > deviceProperties.limits.maxStorageBufferRange;
+    }
+
+    void MultiRadixSortPass::setBuffers(Buffer *buffer0, Buffer *buffer1, Buffer *histograms, Buffer *values0, Buffer *values1) {
+        uint32_t activeIndex = m_activeIndex;
+
+        if (m_keyValue && (values0 == nullptr || values1 == nullptr)) {
+            throw std::runtime_error("Key value pass requires value buffers!");
+        }
+
+        // histograms
+        setStorageBuffer(RADIX_SORT_HISTOGRAMS, 1, histograms);
+        setStorageBuffer(RADIX_SORT, 2, histograms);
+
+        // keys and values are passed as device addresses in the push constants, swapped by sort() for every iteration
+        if (m_largeElementCount) {
+            m_bufferAddresses = {buffer0->getDeviceAddress(), buffer1->getDeviceAddress(), m_keyValue ? values0->getDeviceAddress() : 0, m_keyValue ? values1->getDeviceAddress() : 0};
+            m_bufferActiveIndex = activeIndex;
+            return;
+        }
+
+        // buffer0
+        setStorageBuffer(activeIndex, RADIX_SORT_HISTOGRAMS, 0, buffer0); // iteration 0 and 2 (0,0)
+        setStorageBuffer(activeIndex, RADIX_SORT, 0, buffer0);            // iteration 0 and 2 (1,0)
+        setStorageBuffer((activeIndex + 1) % 2, RADIX_SORT, 1, buffer0);  // iteration 1 and 3 (1,1)
+
+        // buffer1
+        setStorageBuffer((activeIndex + 1) % 2, RADIX_SORT_HISTOGRAMS, 0, buffer1); // iteration 1 and 3 (0,0)
+        setStorageBuffer(activeIndex, RADIX_SORT, 1, buffer1);                      // iteration 0 and 2 (1,1)
+        setStorageBuffer((activeIndex + 1) % 2, RADIX_SORT, 0, buffer1);            // iteration 1 and 3 (1,0)
+
+        if (m_keyValue) {
+            setStorageBuffer(activeIndex, RADIX_SORT, 3, values0);           // iteration 0 and 2
+            setStorageBuffer(activeIndex, RADIX_SORT, 4, values1);
+            setStorageBuffer((activeIndex + 1) % 2, RADIX_SORT, 3, values1); // iteration 1 and 3
+            setStorageBuffer((activeIndex + 1) % 2, RADIX_SORT, 4, values0);
+        }
+    }
+
+    void MultiRadixSortPass::prepareIteration(uint32_t i, uint32_t numIterations, const std::vector<VkBufferMemoryBarrier> &acquireBarriers, const std::vector<VkBufferMemoryBarrier> &releaseBarriers) {
+        const uint32_t digit = m_firstDigit + i;
+        m_pushConstantsHistogram.g_shift = 8 * digit;
+        m_pushConstants.g_shift = 8 * digit;
+        m_pushConstantsLarge.g_shift = 8 * digit;
+        if (isProfiling()) {
+            setProfilingLabel("digit " + std::to_string(digit));
+        }
+        if (m_largeElementCount) {
+            // same ping pong as the descriptors: buffer0 is the input at the active index of setBuffers
+            const uint32_t swap = (m_activeIndex + 2 - m_bufferActiveIndex) % 2;
+            m_pushConstantsLarge.g_elements_in = m_bufferAddresses[swap];
+            m_pushConstantsLarge.g_elements_out = m_bufferAddresses[1 - swap];
+            m_pushConstantsLarge.g_values_in = m_bufferAddresses[2 + swap];
+            m_pushConstantsLarge.g_values_out = m_bufferAddresses[3 - swap];
+        }
+        m_acquireBarriers = i == 0 ? acquireBarriers : std::vector<VkBufferMemoryBarrier>{};
+        m_releaseBarriers = i == numIterations - 1 ? releaseBarriers : std::vector<VkBufferMemoryBarrier>{};
+    }
+
+    VkSemaphore MultiRadixSortPass::sort(VkSemaphore awaitBeforeExecution, uint32_t numIterations, const std::vector<VkBufferMemoryBarrier> &acquireBarriers, const std::vector<VkBufferMemoryBarrier> &releaseBarriers) {
+        for (uint32_t i = 0; i < numIterations; i++) {
+            prepareIteration(i, numIterations, acquireBarriers, releaseBarriers);
+            awaitBeforeExecution = execute(awaitBeforeExecution);
+            incrementActiveIndex();
+        }
+        m_acquireBarriers.clear();
+        m_releaseBarriers.clear();
+        return awaitBeforeExecution;
+    }
+
+    SubmitHandle MultiRadixSortPass::submitSort(uint32_t numIterations, const std::vector<SubmitHandle> &waitHandles, const std::vector<VkBufferMemoryBarrier> &acquireBarriers, const std::vector<VkBufferMemoryBarrier> &releaseBarriers) {
+        return submitCommands([&](VkCommandBuffer commandBuffer) {
+            recordSort(commandBuffer, numIterations, acquireBarriers, releaseBarriers);
+        }, waitHandles);
+    }
+
+    void MultiRadixSortPass::recordSort(VkCommandBuffer commandBuffer, uint32_t numIterations, const std::vector<VkBufferMemoryBarrier> &acquireBarriers, const std::vector<VkBufferMemoryBarrier> &releaseBarriers) {
+        // the descriptor sets and push constants of every iteration are recorded in order, the barriers of recordCommands separate the iterations
+        for (uint32_t i = 0; i < numIterations; i++) {
+            prepareIteration(i, numIterations, acquireBarriers, releaseBarriers);
+            record(commandBuffer);
+            incrementActiveIndex();
+        }
+        m_acquireBarriers.clear();
+        m_releaseBarriers.clear();
+    }
+
+    std::string MultiRadixSortPass::getStageName(uint32_t stageIndex) const {
+        return stageIndex == RADIX_SORT_HISTOGRAMS ? "histograms" : "scatter"; // the scan of the histograms is part of the scatter shader
+    }
+
+    uint64_t MultiRadixSortPass::getStageBytes(uint32_t stageIndex) const {
+        const uint64_t keyBytes = m_numElements * sizeof(uint32_t);
+        const uint64_t histogramsBytes = getHistogramsSizeBytes(m_pushConstants.g_num_workgroups);
+        if (stageIndex == RADIX_SORT_HISTOGRAMS) {
+            return keyBytes + histogramsBytes; // read keys, write histograms
+        }
+        return 2 * keyBytes * (m_keyValue ? 2 : 1) + histogramsBytes; // read histograms, read and write keys (and values)
     }
 
     void MultiRadixSortPass::recordCommands(VkCommandBuffer commandBuffer) {
-        vkCmdPushConstants(commandBuffer, m_pipelineLayouts[RADIX_SORT_HISTOGRAMS], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantsHistograms), &m_pushConstantsHistogram);
+        if (!m_acquireBarriers.empty()) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 0, nullptr, m_acquireBarriers.size(), m_acquireBarriers.data(), 0, nullptr);
+        }
+
+        if (m_largeElementCount) {
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[RADIX_SORT_HISTOGRAMS], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantsLarge), &m_pushConstantsLarge);
+        } else {
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[RADIX_SORT_HISTOGRAMS], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantsHistograms), &m_pushConstantsHistogram);
+        }
         recordCommandComputeShaderExecution(commandBuffer, RADIX_SORT_HISTOGRAMS);
         VkMemoryBarrier memoryBarrier0{.sType=VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask=VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask=VK_ACCESS_SHADER_READ_BIT};
         vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &memoryBarrier0, 0, nullptr, 0, nullptr);
 
-        vkCmdPushConstants(commandBuffer, m_pipelineLayouts[RADIX_SORT], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+        if (m_largeElementCount) {
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[RADIX_SORT], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantsLarge), &m_pushConstantsLarge);
+        } else {
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[RADIX_SORT], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+        }
         recordCommandComputeShaderExecution(commandBuffer, RADIX_SORT);
         VkMemoryBarrier memoryBarrier1{.sType=VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask=VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask=VK_ACCESS_SHADER_READ_BIT};
         vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &memoryBarrier1, 0, nullptr, 0, nullptr);
+
+        if (!m_releaseBarriers.empty()) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT, {}, 0, nullptr, m_releaseBarriers.size(), m_releaseBarriers.data(), 0, nullptr);
+        }
     }
 
     void MultiRadixSortPass::createPipelineLayouts() {
@@ -29,7 +197,7 @@ namespace engine {
         VkPushConstantRange pushConstantRange{};
         pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
         pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(PushConstantsHistograms);
+        pushConstantRange.size = m_largeElementCount ? sizeof(PushConstantsLarge) : sizeof(PushConstantsHistograms);
 
         pipelineLayoutInfo.pushConstantRangeCount = 1;
         pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
@@ -41,7 +209,7 @@ namespace engine {
         // RADIX_SORT
         pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
         pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(PushConstants);
+        pushConstantRange.size = m_largeElementCount ? sizeof(PushConstantsLarge) : sizeof(PushConstants);
 
         pipelineLayoutInfo.pushConstantRangeCount = 1;
         pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
@@ -50,4 +218,4 @@ namespace engine {
             throw std::runtime_error("Failed to create pipeline layout!");
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,323 @@
+#include "MultiRadixSortPipeline.h"
+
+namespace engine {
+
+    MultiRadixSortPipeline::MultiRadixSortPipeline(GPUContext *gpuContext, uint32_t maxElementsPerBatch, bool keyValue, uint32_t numBlocksPerWorkgroup) : m_gpuContext(gpuContext), m_maxElementsPerBatch(maxElementsPerBatch), m_keyValue(keyValue), m_numBlocksPerWorkgroup(numBlocksPerWorkgroup) {
+    }
+
+    void MultiRadixSortPipeline::create() {
+        m_mapped = m_gpuContext->isUnifiedMemory();
+        if (!m_mapped && m_gpuContext->m_queues->getQueue(Queues::ASYNC_TRANSFER) == VK_NULL_HANDLE) {
+            throw std::runtime_error("MultiRadixSortPipeline requires a GPUContext with Queues::ASYNC_TRANSFER_FAMILY!");
+        }
+
+        Queues::QueueFamilyIndices queueFamilyIndices = m_gpuContext->m_queues->findQueueFamilies(m_gpuContext->m_physicalDevice);
+        m_computeFamily = queueFamilyIndices.computeFamily.value();
+        if (m_mapped) {
+            std::cout << PRINT_PREFIX << "Unified memory, the batches are sorted in mapped device local memory." << std::endl;
+        } else {
+            m_transferFamily = queueFamilyIndices.asyncTransferFamily.value();
+            std::cout << PRINT_PREFIX << "Compute queue family " << m_computeFamily << ", transfer queue family " << m_transferFamily << (requiresOwnershipTransfer() ? " (dedicated)." : " (shared).") << std::endl;
+
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            poolInfo.queueFamilyIndex = m_transferFamily;
+            if (vkCreateCommandPool(m_gpuContext->m_device, &poolInfo, nullptr, &m_transferCommandPool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create command pool!");
+            }
+        }
+        const VkMemoryPropertyFlags mappedMemoryProperties = m_mapped ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0;
+
+        const VkDeviceSize maxElementsBytes = static_cast<VkDeviceSize>(m_maxElementsPerBatch) * sizeof(SORT_TYPE);
+        const VkDeviceSize maxValuesBytes = m_keyValue ? static_cast<VkDeviceSize>(m_maxElementsPerBatch) * sizeof(VALUE_TYPE) : 0;
+        for (auto &slot: m_slots) {
+            slot.m_pass = std::make_shared<MultiRadixSortPass>(m_gpuContext, m_keyValue);
+            slot.m_pass->create();
+            slot.m_pass->setNumElements(m_maxElementsPerBatch, m_numBlocksPerWorkgroup);
+            const uint32_t histogramsBytes = MultiRadixSortPass::getHistogramsSizeBytes(slot.m_pass->getWorkGroupCount(MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width);
+
+            auto settings0 = Buffer::BufferSettings{.m_sizeBytes = maxElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | mappedMemoryProperties, .m_name = "radixSortPipeline.elementBuffer0"};
+            auto settings1 = Buffer::BufferSettings{.m_sizeBytes = maxElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortPipeline.elementBuffer1"};
+            auto settings2 = Buffer::BufferSettings{.m_sizeBytes = histogramsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortPipeline.histogramsBuffer"};
+            slot.m_buffers = {std::make_shared<Buffer>(m_gpuContext, settings0), std::make_shared<Buffer>(m_gpuContext, settings1), std::make_shared<Buffer>(m_gpuContext, settings2)};
+            if (m_keyValue) {
+                auto settings3 = Buffer::BufferSettings{.m_sizeBytes = maxValuesBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | mappedMemoryProperties, .m_name = "radixSortPipeline.valueBuffer0"};
+                auto settings4 = Buffer::BufferSettings{.m_sizeBytes = maxValuesBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortPipeline.valueBuffer1"};
+                slot.m_buffers.push_back(std::make_shared<Buffer>(m_gpuContext, settings3));
+                slot.m_buffers.push_back(std::make_shared<Buffer>(m_gpuContext, settings4));
+            }
+
+            if (m_mapped) {
+                // fill and drain work on the sorted buffers themselves (the result of an even number of iterations is in buffer0)
+                slot.m_stagingInMemory = static_cast<SORT_TYPE *>(slot.m_buffers[0]->mapHostMemory()); // persistently mapped
+                slot.m_stagingOutMemory = slot.m_stagingInMemory;
+                if (m_keyValue) {
+                    slot.m_stagingInValues = static_cast<VALUE_TYPE *>(slot.m_buffers[3]->mapHostMemory());
+                    slot.m_stagingOutValues = slot.m_stagingInValues;
+                }
+            } else {
+                createStagingBuffers(slot, maxElementsBytes, maxValuesBytes);
+
+                VkCommandBufferAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                allocInfo.commandPool = m_transferCommandPool;
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocInfo.commandBufferCount = 2;
+                VkCommandBuffer commandBuffers[2];
+                if (vkAllocateCommandBuffers(m_gpuContext->m_device, &allocInfo, commandBuffers) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to allocate command buffers!");
+                }
+                slot.m_uploadCommandBuffer = commandBuffers[0];
+                slot.m_downloadCommandBuffer = commandBuffers[1];
+            }
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // nothing to wait for before the first upload into this slot
+            if (vkCreateSemaphore(m_gpuContext->m_device, &semaphoreInfo, nullptr, &slot.m_uploadSemaphore) != VK_SUCCESS ||
+                vkCreateFence(m_gpuContext->m_device, &fenceInfo, nullptr, &slot.m_downloadFence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create synchronization objects for a slot!");
+            }
+        }
+    }
+
+    void MultiRadixSortPipeline::createStagingBuffers(Slot &slot, VkDeviceSize maxElementsBytes, VkDeviceSize maxValuesBytes) {
+        auto settingsIn = Buffer::BufferSettings{.m_sizeBytes = maxElementsBytes + maxValuesBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_name = "radixSortPipeline.stagingIn"};
+        auto settingsOut = Buffer::BufferSettings{.m_sizeBytes = maxElementsBytes + maxValuesBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_DST_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_name = "radixSortPipeline.stagingOut"};
+        slot.m_stagingIn = std::make_shared<Buffer>(m_gpuContext, settingsIn);
+        slot.m_stagingOut = std::make_shared<Buffer>(m_gpuContext, settingsOut);
+        slot.m_stagingInMemory = static_cast<SORT_TYPE *>(slot.m_stagingIn->mapHostMemory()); // persistently mapped
+        slot.m_stagingOutMemory = static_cast<SORT_TYPE *>(slot.m_stagingOut->mapHostMemory());
+        if (m_keyValue) {
+            slot.m_stagingInValues = reinterpret_cast<VALUE_TYPE *>(slot.m_stagingInMemory + m_maxElementsPerBatch);
+            slot.m_stagingOutValues = reinterpret_cast<VALUE_TYPE *>(slot.m_stagingOutMemory + m_maxElementsPerBatch);
+        }
+    }
+
+    void MultiRadixSortPipeline::release() {
+        if (!m_mapped) {
+            m_gpuContext->m_queues->waitIdle(Queues::ASYNC_TRANSFER);
+        }
+        m_gpuContext->m_queues->waitIdle(Queues::COMPUTE);
+        for (auto &slot: m_slots) {
+            slot.m_pass->wait(); // the passes may submit to other compute queues
+        }
+
+        for (auto &slot: m_slots) {
+            vkDestroySemaphore(m_gpuContext->m_device, slot.m_uploadSemaphore, nullptr);
+            vkDestroyFence(m_gpuContext->m_device, slot.m_downloadFence, nullptr);
+            if (m_mapped) {
+                slot.m_buffers[0]->unmapHostMemory();
+                if (m_keyValue) {
+                    slot.m_buffers[3]->unmapHostMemory();
+                }
+            } else {
+                slot.m_stagingIn->unmapHostMemory();
+                slot.m_stagingOut->unmapHostMemory();
+                slot.m_stagingIn->release();
+                slot.m_stagingOut->release();
+            }
+            for (const auto &buffer: slot.m_buffers) {
+                buffer->release();
+            }
+            slot.m_pass->release();
+        }
+        vkDestroyCommandPool(m_gpuContext->m_device, m_transferCommandPool, nullptr);
+    }
+
+    void MultiRadixSortPipeline::run(const std::vector<uint32_t> &batchSizes, const FillFunction &fill, const DrainFunction &drain) {
+        const auto numBatches = static_cast<uint32_t>(batchSizes.size());
+
+        // step s: download batch s-2, upload batch s, sort batch s-1
+        // the downloads and uploads are submitted before the sort, so the transfer queue is busy while the compute queue sorts
+        for (uint32_t step = 0; step < numBatches + 2; step++) {
+            if (step >= 2 && step - 2 < numBatches) {
+                download(m_slots[(step - 2) % NUM_SLOTS]);
+            }
+            if (step < numBatches) {
+                Slot &slot = m_slots[step % NUM_SLOTS];
+                vkWaitForFences(m_gpuContext->m_device, 1, &slot.m_downloadFence, VK_TRUE, UINT64_MAX); // batch step-3 has left the slot
+                this->drain(slot, drain);
+
+                if (batchSizes[step] > m_maxElementsPerBatch) {
+                    throw std::runtime_error("Batch exceeds the maximum number of elements per batch!");
+                }
+                slot.m_batchIndex = step;
+                slot.m_numElements = batchSizes[step];
+                fill(step, slot.m_stagingInMemory, slot.m_stagingInValues, slot.m_numElements);
+                upload(slot);
+            }
+            if (step >= 1 && step - 1 < numBatches) {
+                sort(m_slots[(step - 1) % NUM_SLOTS]);
+            }
+        }
+
+        // drain the last batches in order
+        for (uint32_t batchIndex = numBatches > NUM_SLOTS ? numBatches - NUM_SLOTS : 0; batchIndex < numBatches; batchIndex++) {
+            Slot &slot = m_slots[batchIndex % NUM_SLOTS];
+            vkWaitForFences(m_gpuContext->m_device, 1, &slot.m_downloadFence, VK_TRUE, UINT64_MAX);
+            this->drain(slot, drain);
+        }
+    }
+
+    VkBufferMemoryBarrier MultiRadixSortPipeline::bufferMemoryBarrier(Buffer *buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t srcQueueFamily, uint32_t dstQueueFamily) const {
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.srcQueueFamilyIndex = srcQueueFamily;
+        barrier.dstQueueFamilyIndex = dstQueueFamily;
+        barrier.buffer = buffer->getBuffer();
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        return barrier;
+    }
+
+    std::vector<Buffer *> MultiRadixSortPipeline::getTransferredBuffers(const Slot &slot) const {
+        std::vector<Buffer *> buffers = {slot.m_buffers[0].get()};
+        if (m_keyValue) {
+            buffers.push_back(slot.m_buffers[3].get());
+        }
+        return buffers;
+    }
+
+    void MultiRadixSortPipeline::upload(Slot &slot) {
+        if (m_mapped) {
+            return; // host writes before the submission of the sort are visible to it
+        }
+
+        VkCommandBuffer commandBuffer = slot.m_uploadCommandBuffer;
+        vkResetCommandBuffer(commandBuffer, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        if (slot.m_numElements > 0) {
+            VkBufferCopy copyRegion{.srcOffset = 0, .dstOffset = 0, .size = slot.m_numElements * sizeof(SORT_TYPE)};
+            vkCmdCopyBuffer(commandBuffer, slot.m_stagingIn->getBuffer(), slot.m_buffers[0]->getBuffer(), 1, &copyRegion);
+            if (m_keyValue) {
+                VkBufferCopy valuesCopyRegion{.srcOffset = m_maxElementsPerBatch * sizeof(SORT_TYPE), .dstOffset = 0, .size = slot.m_numElements * sizeof(VALUE_TYPE)};
+                vkCmdCopyBuffer(commandBuffer, slot.m_stagingIn->getBuffer(), slot.m_buffers[3]->getBuffer(), 1, &valuesCopyRegion);
+            }
+        }
+        if (requiresOwnershipTransfer()) {
+            // release buffer0 (and values0) to the compute queue family
+            std::vector<VkBufferMemoryBarrier> barriers;
+            for (Buffer *buffer: getTransferredBuffers(slot)) {
+                barriers.push_back(bufferMemoryBarrier(buffer, VK_ACCESS_TRANSFER_WRITE_BIT, 0, m_transferFamily, m_computeFamily));
+            }
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, {}, 0, nullptr, barriers.size(), barriers.data(), 0, nullptr);
+        }
+
+        vkEndCommandBuffer(commandBuffer);
+        submitTransfer(commandBuffer, VK_NULL_HANDLE, slot.m_uploadSemaphore, VK_NULL_HANDLE);
+    }
+
+    void MultiRadixSortPipeline::sort(Slot &slot) {
+        slot.m_pass->setNumElements(slot.m_numElements, m_numBlocksPerWorkgroup);
+        if (m_keyValue) {
+            slot.m_pass->setBuffers(slot.m_buffers[0].get(), slot.m_buffers[1].get(), slot.m_buffers[2].get(), slot.m_buffers[3].get(), slot.m_buffers[4].get());
+        } else {
+            slot.m_pass->setBuffers(slot.m_buffers[0].get(), slot.m_buffers[1].get(), slot.m_buffers[2].get());
+        }
+
+        std::vector<VkBufferMemoryBarrier> acquireBarriers;
+        std::vector<VkBufferMemoryBarrier> releaseBarriers;
+        if (m_mapped) {
+            // make the result visible to the drain
+            for (Buffer *buffer: getTransferredBuffers(slot)) {
+                releaseBarriers.push_back(bufferMemoryBarrier(buffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED));
+            }
+        } else if (requiresOwnershipTransfer()) {
+            // acquire buffer0 (and values0) from the transfer queue family and release it back after the last iteration
+            for (Buffer *buffer: getTransferredBuffers(slot)) {
+                acquireBarriers.push_back(bufferMemoryBarrier(buffer, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, m_transferFamily, m_computeFamily));
+                releaseBarriers.push_back(bufferMemoryBarrier(buffer, VK_ACCESS_SHADER_WRITE_BIT, 0, m_computeFamily, m_transferFamily));
+            }
+        }
+        slot.m_sortSemaphore = slot.m_pass->sort(m_mapped ? VK_NULL_HANDLE : slot.m_uploadSemaphore, MultiRadixSort::NUM_ITERATIONS, acquireBarriers, releaseBarriers);
+    }
+
+    void MultiRadixSortPipeline::download(Slot &slot) {
+        vkResetFences(m_gpuContext->m_device, 1, &slot.m_downloadFence);
+
+        if (m_mapped) {
+            // nothing to copy, only signal the fence once the sort is done
+            VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &slot.m_sortSemaphore;
+            submitInfo.pWaitDstStageMask = &waitStage;
+            if (m_gpuContext->m_queues->submit(Queues::COMPUTE, 1, &submitInfo, slot.m_downloadFence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to submit to the compute queue!");
+            }
+            return;
+        }
+
+        VkCommandBuffer commandBuffer = slot.m_downloadCommandBuffer;
+        vkResetCommandBuffer(commandBuffer, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        if (requiresOwnershipTransfer()) {
+            // acquire buffer0 (and values0) from the compute queue family
+            std::vector<VkBufferMemoryBarrier> barriers;
+            for (Buffer *buffer: getTransferredBuffers(slot)) {
+                barriers.push_back(bufferMemoryBarrier(buffer, 0, VK_ACCESS_TRANSFER_READ_BIT, m_computeFamily, m_transferFamily));
+            }
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, {}, 0, nullptr, barriers.size(), barriers.data(), 0, nullptr);
+        }
+        if (slot.m_numElements > 0) {
+            VkBufferCopy copyRegion{.srcOffset = 0, .dstOffset = 0, .size = slot.m_numElements * sizeof(SORT_TYPE)};
+            vkCmdCopyBuffer(commandBuffer, slot.m_buffers[0]->getBuffer(), slot.m_stagingOut->getBuffer(), 1, &copyRegion);
+            if (m_keyValue) {
+                VkBufferCopy valuesCopyRegion{.srcOffset = 0, .dstOffset = m_maxElementsPerBatch * sizeof(SORT_TYPE), .size = slot.m_numElements * sizeof(VALUE_TYPE)};
+                vkCmdCopyBuffer(commandBuffer, slot.m_buffers[3]->getBuffer(), slot.m_stagingOut->getBuffer(), 1, &valuesCopyRegion);
+            }
+        }
+        VkBufferMemoryBarrier hostBarrier = bufferMemoryBarrier(slot.m_stagingOut.get(), VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, {}, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+        vkEndCommandBuffer(commandBuffer);
+        submitTransfer(commandBuffer, slot.m_sortSemaphore, VK_NULL_HANDLE, slot.m_downloadFence);
+    }
+
+    void MultiRadixSortPipeline::drain(Slot &slot, const DrainFunction &drain) {
+        if (slot.m_batchIndex < 0) {
+            return;
+        }
+        drain(static_cast<uint32_t>(slot.m_batchIndex), slot.m_stagingOutMemory, slot.m_stagingOutValues, slot.m_numElements);
+        slot.m_batchIndex = -1;
+    }
+
+    void MultiRadixSortPipeline::submitTransfer(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkSemaphore signalSemaphore, VkFence fence) {
+        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_TRANSFER_BIT};
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        if (waitSemaphore != VK_NULL_HANDLE) {
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &waitSemaphore;
+            submitInfo.pWaitDstStageMask = waitStages;
+        }
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        if (signalSemaphore != VK_NULL_HANDLE) {
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &signalSemaphore;
+        }
+
+        if (m_gpuContext->m_queues->submit(Queues::ASYNC_TRANSFER, 1, &submitInfo, fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit transfer command buffer!");
+        }
+    }
+} // namespace engine
@@ -0,0 +1,98 @@
+#include "MultiRadixSortRunsPass.h"
+#include "shaders/multi_radix_sort_shaders.h"
+
+namespace engine {
+
+    std::vector<std::shared_ptr<Shader>> MultiRadixSortRunsPass::createShaders() {
+        const std::string subgroupSize = "SUBGROUP_SIZE=" + std::to_string(m_gpuContext->getSubgroupSize());
+        std::vector<std::string> compactDefines{subgroupSize, "RUNS_COMPACT"};
+        if (m_reduceByKey) {
+            compactDefines.emplace_back("REDUCE_BY_KEY");
+        }
+        const std::string directory = Paths::m_resourceDirectoryPath + "/shaders";
+        return {std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_runs.comp", std::vector<std::string>{"RUNS_HEADS"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_runs.comp", std::vector<std::string>{subgroupSize, "RUNS_SCAN"}, MULTI_RADIX_SORT_SHADERS),
+                std::make_shared<Shader>(m_gpuContext, directory, "multi_radixsort_runs.comp", compactDefines, MULTI_RADIX_SORT_SHADERS)};
+    }
+
+    void MultiRadixSortRunsPass::setNumElements(uint32_t numElements, uint32_t numBlocksPerWorkgroup) {
+        const uint64_t elementsPerWorkgroup = static_cast<uint64_t>(numBlocksPerWorkgroup) * WORKGROUP_SIZE;
+        const uint32_t numWorkgroups = static_cast<uint32_t>(std::max<uint64_t>((numElements + elementsPerWorkgroup - 1) / elementsPerWorkgroup, 1));
+        m_pushConstants = {numElements, numWorkgroups, numBlocksPerWorkgroup};
+        setWorkGroupCount(RUNS_HEADS, numWorkgroups, 1, 1);
+        setWorkGroupCount(RUNS_SCAN, 1, 1, 1);
+        setWorkGroupCount(RUNS_COMPACT, numWorkgroups, 1, 1);
+    }
+
+    void MultiRadixSortRunsPass::setBuffers(Buffer *keys, Buffer *workgroupRuns, Buffer *numRuns, Buffer *uniqueKeys, Buffer *runLengths, Buffer *values, Buffer *runSums) {
+        if (m_reduceByKey && (values == nullptr || runSums == nullptr)) {
+            throw std::runtime_error("Reduce by key pass requires value and sum buffers!");
+        }
+        setStorageBuffer(RUNS_HEADS, 0, keys);
+        setStorageBuffer(RUNS_HEADS, 1, workgroupRuns);
+        setStorageBuffer(RUNS_SCAN, 0, workgroupRuns);
+        setStorageBuffer(RUNS_SCAN, 1, numRuns);
+        setStorageBuffer(RUNS_COMPACT, 0, keys);
+        setStorageBuffer(RUNS_COMPACT, 1, workgroupRuns);
+        setStorageBuffer(RUNS_COMPACT, 2, uniqueKeys);
+        setStorageBuffer(RUNS_COMPACT, 3, runLengths);
+        m_runLengths = runLengths;
+        if (m_reduceByKey) {
+            setStorageBuffer(RUNS_COMPACT, 4, values);
+            setStorageBuffer(RUNS_COMPACT, 5, runSums);
+            m_runSums = runSums;
+        }
+    }
+
+    void MultiRadixSortRunsPass::findRuns() {
+        execute(VK_NULL_HANDLE);
+        wait();
+        incrementActiveIndex();
+    }
+
+    void MultiRadixSortRunsPass::recordClear(VkCommandBuffer commandBuffer) const {
+        vkCmdFillBuffer(commandBuffer, m_runLengths->getBuffer(), 0, VK_WHOLE_SIZE, 0);
+        if (m_reduceByKey) {
+            vkCmdFillBuffer(commandBuffer, m_runSums->getBuffer(), 0, VK_WHOLE_SIZE, 0);
+        }
+    }
+
+    void MultiRadixSortRunsPass::recordCommands(VkCommandBuffer commandBuffer) {
+        if (m_clearOutputs) {
+            recordClear(commandBuffer);
+        }
+
+        VkMemoryBarrier memoryBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+        for (const auto stage: {RUNS_HEADS, RUNS_SCAN, RUNS_COMPACT}) {
+            if (stage == RUNS_COMPACT && m_clearOutputs) {
+                VkMemoryBarrier clearBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+            }
+            vkCmdPushConstants(commandBuffer, m_pipelineLayouts[stage], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+            recordCommandComputeShaderExecution(commandBuffer, stage);
+            if (stage != RUNS_COMPACT) {
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+            }
+        }
+    }
+
+    void MultiRadixSortRunsPass::createPipelineLayouts() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = m_descriptorSetLayouts.size();
+        pipelineLayoutInfo.pSetLayouts = m_descriptorSetLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        for (const auto stage: {RUNS_HEADS, RUNS_SCAN, RUNS_COMPACT}) {
+            if (vkCreatePipelineLayout(m_gpuContext->m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[stage]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline layout!");
+            }
+        }
+    }
+} // namespace engine
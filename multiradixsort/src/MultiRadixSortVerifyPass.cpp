@@ -0,0 +1,101 @@
+#include "MultiRadixSortVerifyPass.h"
+#include "shaders/multi_radix_sort_shaders.h"
+
+namespace engine {
+
+    void MultiRadixSortVerifyPass::create() {
+        ComputePass::create();
+        m_resultBuffer = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = RESULT_SIZE * sizeof(uint32_t), .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_name = "radixSort.verifyResult"});
+        setStorageBuffer(VERIFY, 2, m_resultBuffer.get());
+    }
+
+    void MultiRadixSortVerifyPass::release() {
+        if (m_resultBuffer) {
+            m_resultBuffer->release();
+            m_resultBuffer = nullptr;
+        }
+        ComputePass::release();
+    }
+
+    std::vector<std::shared_ptr<Shader>> MultiRadixSortVerifyPass::createShaders() {
+        std::vector<std::string> defines;
+        if (m_keyValue) {
+            defines.emplace_back("KEY_VALUE");
+        }
+        return {std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "multi_radixsort_verify.comp", defines, MULTI_RADIX_SORT_SHADERS)};
+    }
+
+    void MultiRadixSortVerifyPass::setBuffers(Buffer *input, Buffer *output, Buffer *valuesIn, Buffer *valuesOut) {
+        if (m_keyValue && (valuesIn == nullptr || valuesOut == nullptr)) {
+            throw std::runtime_error("Key value verification requires value buffers!");
+        }
+        setStorageBuffer(VERIFY, 0, input);
+        setStorageBuffer(VERIFY, 1, output);
+        if (m_keyValue) {
+            setStorageBuffer(VERIFY, 3, valuesIn);
+            setStorageBuffer(VERIFY, 4, valuesOut);
+        }
+    }
+
+    MultiRadixSortVerifyPass::Result MultiRadixSortVerifyPass::verify(uint32_t numElements, bool checkStability) {
+        if (checkStability && !m_keyValue) {
+            throw std::runtime_error("Stability can only be verified by the key value pass!");
+        }
+        m_pushConstants.g_num_elements = numElements;
+        m_pushConstants.g_check_stability = checkStability ? 1 : 0;
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        const uint64_t elementsPerWorkgroup = static_cast<uint64_t>(WORKGROUP_SIZE) * ELEMENTS_PER_INVOCATION;
+        const uint64_t numWorkgroups = std::clamp<uint64_t>((numElements + elementsPerWorkgroup - 1) / elementsPerWorkgroup, 1, deviceProperties.limits.maxComputeWorkGroupCount[0]);
+        setWorkGroupCount(VERIFY, static_cast<uint32_t>(numWorkgroups), 1, 1);
+
+        execute(VK_NULL_HANDLE);
+        wait();
+        incrementActiveIndex();
+
+        std::vector<uint32_t> counters(RESULT_SIZE);
+        m_resultBuffer->download(counters.data());
+        Result result;
+        result.m_unsortedPairs = counters[0];
+        result.m_unstablePairs = counters[1];
+        result.m_hashesMatch = counters[2] == counters[4] && counters[3] == counters[5];
+        result.m_countsMatch = std::equal(counters.begin() + 8, counters.begin() + 8 + RADIX_SORT_BINS, counters.begin() + 8 + RADIX_SORT_BINS);
+        if (!result.isValid()) {
+            std::cerr << PRINT_PREFIX << "Verification failed: " << result.m_unsortedPairs << " unsorted pairs, " << result.m_unstablePairs << " unstable pairs, hashes " << (result.m_hashesMatch ? "match" : "differ") << ", digit counts "
+                      << (result.m_countsMatch ? "match" : "differ") << "." << std::endl;
+        }
+        return result;
+    }
+
+    void MultiRadixSortVerifyPass::recordCommands(VkCommandBuffer commandBuffer) {
+        // the counters start at zero
+        vkCmdFillBuffer(commandBuffer, m_resultBuffer->getBuffer(), 0, VK_WHOLE_SIZE, 0);
+        VkMemoryBarrier clearBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+        vkCmdPushConstants(commandBuffer, m_pipelineLayouts[VERIFY], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pushConstants);
+        recordCommandComputeShaderExecution(commandBuffer, VERIFY);
+
+        VkMemoryBarrier hostBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_HOST_READ_BIT};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, {}, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void MultiRadixSortVerifyPass::createPipelineLayouts() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = m_descriptorSetLayouts.size();
+        pipelineLayoutInfo.pSetLayouts = m_descriptorSetLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(m_gpuContext->m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[VERIFY]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline layout!");
+        }
+    }
+} // namespace engine
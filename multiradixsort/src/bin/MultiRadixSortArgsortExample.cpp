@@ -0,0 +1,116 @@
+#include "MultiRadixSort.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+#include <numeric>
+#include <random>
+
+// usage: multiradixsortargsortexample [numElements]
+// a struct of arrays table with a key column and payload columns of 4, 8, 12 and 16 bytes stays on the GPU:
+// the indices are written by the gather pass (IOTA), the key value sort of keys and indices yields the permutation
+// and one gather dispatch permutes all payload columns, the result is compared with a stable sort on the host
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numElements = argc > 1 ? static_cast<uint32_t>(std::stod(argv[1])) : 1 << 22;
+    const std::vector<uint32_t> columnWidths = {4, 4, 8, 8, 12, 16}; // bytes
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        std::mt19937 random(42);
+        std::vector<SORT_TYPE> keys(numElements);
+        for (auto &key: keys) {
+            key = random() % (numElements / 4 + 1); // duplicates, the order of equal keys is checked as well
+        }
+        std::vector<std::vector<uint32_t>> columns(columnWidths.size());
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            columns[c].resize(static_cast<size_t>(numElements) * columnWidths[c] / 4);
+            for (auto &word: columns[c]) {
+                word = random();
+            }
+        }
+
+        const VkDeviceSize numElementsBytes = static_cast<VkDeviceSize>(numElements) * sizeof(SORT_TYPE);
+        auto keys0 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "argsort.keys0", keys.data());
+        auto keys1 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "argsort.keys1");
+        auto values0 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "argsort.values0");
+        auto values1 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "argsort.values1");
+        std::vector<std::shared_ptr<engine::Buffer>> columnsIn;
+        std::vector<std::shared_ptr<engine::Buffer>> columnsOut;
+        std::vector<engine::MultiRadixSortGatherPass::Column> gatherColumns;
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            const VkDeviceSize columnBytes = static_cast<VkDeviceSize>(numElements) * columnWidths[c];
+            columnsIn.push_back(engine::Buffer::createDeviceLocal(&gpu, columnBytes, engine::MultiRadixSortGatherPass::COLUMN_BUFFER_USAGES, "argsort.columnIn" + std::to_string(c), columns[c].data(), engine::MultiRadixSortGatherPass::COLUMN_MEMORY_ALLOCATE_FLAGS));
+            columnsOut.push_back(engine::Buffer::createDeviceLocal(&gpu, columnBytes, engine::MultiRadixSortGatherPass::COLUMN_BUFFER_USAGES, "argsort.columnOut" + std::to_string(c), nullptr, engine::MultiRadixSortGatherPass::COLUMN_MEMORY_ALLOCATE_FLAGS));
+            gatherColumns.push_back({columnsIn[c].get(), columnsOut[c].get(), columnWidths[c]});
+        }
+
+        auto sortPass = std::make_shared<engine::MultiRadixSortPass>(&gpu, true);
+        sortPass->create();
+        sortPass->setNumElements(numElements, engine::MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+        auto histograms = engine::Buffer::createDeviceLocal(&gpu, engine::MultiRadixSortPass::getHistogramsSizeBytes(sortPass->getWorkGroupCount(engine::MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "argsort.histograms");
+        auto gatherPass = std::make_shared<engine::MultiRadixSortGatherPass>(&gpu);
+        gatherPass->create();
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        gatherPass->setIndices(values0.get());
+        gatherPass->writeIndices(numElements);
+        sortPass->setBuffers(keys0.get(), keys1.get(), histograms.get(), values0.get(), values1.get());
+        sortPass->sort(VK_NULL_HANDLE, engine::MultiRadixSort::NUM_ITERATIONS);
+        sortPass->wait();
+        std::chrono::steady_clock::time_point sorted = std::chrono::steady_clock::now();
+        gatherPass->setColumns(values0.get(), gatherColumns); // the permutation is in values0 after an even number of iterations
+        gatherPass->gather(numElements);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        // reference: stable argsort on the host
+        std::vector<uint32_t> reference(numElements);
+        std::iota(reference.begin(), reference.end(), 0);
+        std::stable_sort(reference.begin(), reference.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+        uint32_t failures = 0;
+        std::vector<uint32_t> permutation(numElements);
+        values0->downloadWithStagingBuffer(permutation.data());
+        failures += permutation != reference ? 1 : 0;
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            const uint32_t widthWords = columnWidths[c] / 4;
+            std::vector<uint32_t> gathered(columns[c].size());
+            columnsOut[c]->downloadWithStagingBuffer(gathered.data());
+            for (uint32_t i = 0; i < numElements; i++) {
+                if (!std::equal(gathered.begin() + static_cast<std::ptrdiff_t>(i) * widthWords, gathered.begin() + static_cast<std::ptrdiff_t>(i + 1) * widthWords, columns[c].begin() + static_cast<std::ptrdiff_t>(reference[i]) * widthWords)) {
+                    std::cerr << "[MultiRadixSortArgsort] Column " << c << " differs in row " << i << "." << std::endl;
+                    failures++;
+                    break;
+                }
+            }
+        }
+
+        gatherPass->release();
+        sortPass->release();
+        for (const auto &buffer: {keys0, keys1, values0, values1, histograms}) {
+            buffer->release();
+        }
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            columnsIn[c]->release();
+            columnsOut[c]->release();
+        }
+        gpu.shutdown();
+
+        const auto toMs = [](auto duration) { return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) * 1e-3; };
+        std::cout << "[MultiRadixSortArgsort] Argsort of " << numElements << " keys in " << toMs(sorted - begin) << "[ms], gather of " << columns.size() << " columns in " << toMs(end - sorted) << "[ms]." << std::endl;
+        if (failures > 0) {
+            std::cout << "[MultiRadixSortArgsort] TEST FAILED (" << failures << " failures)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[MultiRadixSortArgsort] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+#include "MultiRadixSort.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+#include <random>
+
+// usage: multiradixsortasyncexample [numElements] [numBatches]
+// two slots sort batches alternately with submitSort: while the GPU sorts the batch of one slot, the host generates the keys of the next
+// batch in the other slot and checks the previous result of the slot only once its handle has completed
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numElements = argc > 1 ? static_cast<uint32_t>(std::stod(argv[1])) : 1 << 22;
+    const uint32_t numBatches = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 8;
+    const VkDeviceSize numElementsBytes = static_cast<VkDeviceSize>(numElements) * sizeof(SORT_TYPE);
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        struct Slot {
+            std::shared_ptr<engine::MultiRadixSortPass> m_pass;
+            std::shared_ptr<engine::Buffer> m_buffer0; // host visible, written and read by the host
+            std::shared_ptr<engine::Buffer> m_buffer1;
+            std::shared_ptr<engine::Buffer> m_histograms;
+            std::vector<SORT_TYPE> m_reference; // sorted on the host
+            engine::SubmitHandle m_handle;
+        };
+        std::array<Slot, 2> slots;
+        for (auto &slot: slots) {
+            slot.m_pass = std::make_shared<engine::MultiRadixSortPass>(&gpu);
+            slot.m_pass->create();
+            slot.m_pass->setNumElements(numElements, engine::MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+            slot.m_buffer0 = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_preferredMemoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.elementBuffer0"});
+            slot.m_buffer1 = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.elementBuffer1"});
+            slot.m_histograms = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = engine::MultiRadixSortPass::getHistogramsSizeBytes(slot.m_pass->getWorkGroupCount(engine::MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSort.histogramsBuffer"});
+        }
+
+        // the sorted keys are read by the host after the handle completed
+        auto hostReadBarrier = [](engine::Buffer *buffer) {
+            return VkBufferMemoryBarrier{.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_HOST_READ_BIT, .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .buffer = buffer->getBuffer(), .offset = 0, .size = VK_WHOLE_SIZE};
+        };
+
+        std::mt19937 random(42);
+        std::vector<SORT_TYPE> elements(numElements);
+        uint32_t failures = 0;
+        uint32_t pendingWhilePreparing = 0; // batches whose sort was still running while the host prepared the next one
+        auto checkSlot = [&](Slot &slot) {
+            slot.m_handle.wait();
+            slot.m_buffer0->download(elements.data());
+            failures += elements != slot.m_reference ? 1 : 0;
+        };
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (uint32_t batch = 0; batch < numBatches; batch++) {
+            Slot &slot = slots[batch % 2];
+            Slot &previousSlot = slots[(batch + 1) % 2];
+
+            // host work of the next batch, overlaps with the sort of the other slot
+            for (auto &key: elements) {
+                key = random();
+            }
+            slot.m_reference = elements;
+            std::sort(slot.m_reference.begin(), slot.m_reference.end());
+            pendingWhilePreparing += previousSlot.m_handle.isValid() && !previousSlot.m_handle.poll() ? 1 : 0;
+
+            // the buffers of the slot are free once its previous sort has been checked
+            if (slot.m_handle.isValid()) {
+                throw std::runtime_error("Slot is still in use!");
+            }
+            slot.m_buffer0->updateHostMemory(numElementsBytes, elements.data());
+            slot.m_pass->setBuffers(slot.m_buffer0.get(), slot.m_buffer1.get(), slot.m_histograms.get());
+            slot.m_handle = slot.m_pass->submitSort(engine::MultiRadixSort::NUM_ITERATIONS, {}, {}, {hostReadBarrier(slot.m_buffer0.get())});
+
+            if (previousSlot.m_handle.isValid()) {
+                checkSlot(previousSlot);
+                previousSlot.m_handle = {};
+            }
+        }
+        for (auto &slot: slots) {
+            if (slot.m_handle.isValid()) {
+                slot.m_handle.toFuture().wait(); // e.g. for code that waits on several kinds of work
+                checkSlot(slot);
+            }
+        }
+        const double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * 1e-3;
+
+        for (auto &slot: slots) {
+            slot.m_buffer0->release();
+            slot.m_buffer1->release();
+            slot.m_histograms->release();
+            slot.m_pass->release();
+        }
+        gpu.shutdown();
+
+        std::cout << "[MultiRadixSortAsync] " << numBatches << " batches of " << numElements << " elements in " << ms << "[ms], the GPU was still sorting during " << pendingWhilePreparing << " host preparations." << std::endl;
+        if (failures > 0) {
+            std::cout << "[MultiRadixSortAsync] TEST FAILED (" << failures << " failures)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[MultiRadixSortAsync] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
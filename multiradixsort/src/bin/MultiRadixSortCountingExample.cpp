@@ -0,0 +1,88 @@
+#include "MultiRadixSort.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+#include <numeric>
+#include <random>
+
+// usage: multiradixsortcountingexample [numElements] [numKeys]
+// keys in a small range (e.g. material ids) with their indices as values: the counting pass sorts them in one round,
+// compared with a stable sort on the host, then MultiRadixSort::argsort reuses the pass and MultiRadixSort::sortInPlace picks the counting sort
+// on its own for ranges of at most MultiRadixSortCountingPass::AUTO_MAX_BINS keys (the radix sort otherwise)
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numElements = argc > 1 ? static_cast<uint32_t>(std::stod(argv[1])) : 1 << 22;
+    const uint32_t numKeys = argc > 2 ? std::clamp(static_cast<uint32_t>(std::stod(argv[2])), 1U, engine::MultiRadixSortCountingPass::MAX_BINS) : 1 << 10;
+    const uint32_t minKey = 1000;
+    const VkDeviceSize numElementsBytes = static_cast<VkDeviceSize>(numElements) * sizeof(SORT_TYPE);
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        std::mt19937 random(42);
+        std::vector<SORT_TYPE> keys(numElements);
+        for (auto &key: keys) {
+            key = minKey + random() % numKeys;
+        }
+        std::vector<VALUE_TYPE> indices(numElements);
+        std::iota(indices.begin(), indices.end(), 0);
+
+        auto pass = std::make_shared<engine::MultiRadixSortCountingPass>(&gpu, true);
+        pass->create();
+        pass->setNumElements(numElements, minKey, minKey + numKeys - 1);
+
+        auto keysIn = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "counting.keysIn", keys.data());
+        auto keysOut = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "counting.keysOut");
+        auto valuesIn = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "counting.valuesIn", indices.data());
+        auto valuesOut = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "counting.valuesOut");
+        auto counters = engine::Buffer::createDeviceLocal(&gpu, pass->getCountersSizeBytes(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "counting.counters");
+        pass->setBuffers(keysIn.get(), keysOut.get(), counters.get(), valuesIn.get(), valuesOut.get());
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        pass->sort();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        // reference: stable argsort on the host
+        std::vector<uint32_t> reference(numElements);
+        std::iota(reference.begin(), reference.end(), 0);
+        std::stable_sort(reference.begin(), reference.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        std::vector<SORT_TYPE> sortedKeys(numElements);
+        std::vector<VALUE_TYPE> permutation(numElements);
+        keysOut->downloadWithStagingBuffer(sortedKeys.data());
+        valuesOut->downloadWithStagingBuffer(permutation.data());
+        uint32_t failures = permutation != reference ? 1 : 0;
+        for (uint32_t i = 0; failures == 0 && i < numElements; i++) {
+            failures += sortedKeys[i] != keys[reference[i]] ? 1 : 0;
+        }
+
+        // front end: the key range is found on the host, the pass of the caller selects the counting sort for all supported ranges
+        std::vector<VALUE_TYPE> argsortPermutation(numElements);
+        engine::MultiRadixSort::argsort(&gpu, keys, argsortPermutation, {}, nullptr, pass.get());
+        failures += argsortPermutation != reference ? 1 : 0;
+        std::vector<SORT_TYPE> elements = keys;
+        engine::MultiRadixSort::sortInPlace(&gpu, elements);
+        failures += elements != sortedKeys ? 1 : 0;
+
+        pass->release();
+        for (const auto &buffer: {keysIn, keysOut, valuesIn, valuesOut, counters}) {
+            buffer->release();
+        }
+        gpu.shutdown();
+
+        std::cout << "[MultiRadixSortCounting] Counting sort of " << numElements << " pairs in a range of " << numKeys << " keys (" << pass->m_pushConstants.g_num_workgroups << " workgroups) in " << (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * 1e-3) << "[ms]." << std::endl;
+        if (failures > 0) {
+            std::cout << "[MultiRadixSortCounting] TEST FAILED (" << failures << " failures)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[MultiRadixSortCounting] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
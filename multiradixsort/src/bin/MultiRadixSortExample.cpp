@@ -2,7 +2,8 @@
 #include "engine/core/GPUContext.h"
 #include "engine/util/Paths.h"
 
-int main() {
+// usage: multiradixsortexample [--profile-json path] [--distribution uniform|sorted|reverse-sorted|nearly-sorted|all-equal|few-unique|zipf|morton]
+int main(int argc, char *argv[]) {
 #ifdef RESOURCE_DIRECTORY_PATH
     engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
 #endif
@@ -11,10 +12,22 @@ int main() {
 
     //    for (uint32_t i = 0; i < 16; i++) {
     try {
+        auto app = std::make_shared<engine::MultiRadixSort>();
+        std::string profilingJsonPath;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string arg = argv[i];
+            if (arg == "--profile-json") {
+                profilingJsonPath = argv[i + 1];
+            } else if (arg == "--distribution") {
+                app->setDistribution(engine::KeyGenerator::parseDistribution(argv[i + 1]));
+            } else {
+                throw std::invalid_argument("Unknown argument " + arg + "!");
+            }
+        }
+
         gpu.init();
 
-        auto app = std::make_shared<engine::MultiRadixSort>();
-        app->execute(&gpu);
+        app->execute(&gpu, profilingJsonPath);
 
         gpu.shutdown();
     } catch (const std::exception &e) {
@@ -0,0 +1,46 @@
+#include "MultiRadixSortExternal.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/KeyGenerator.h"
+#include "engine/util/Paths.h"
+
+// usage: multiradixsortexternalexample [numElements] [maxChunkElements]
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY | engine::Queues::ASYNC_TRANSFER_FAMILY);
+
+    const uint64_t numElements = argc > 1 ? std::stoull(argv[1]) : 64000000;
+    const uint32_t maxChunkElements = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 0;
+
+    try {
+        gpu.init();
+
+        std::vector<SORT_TYPE> input(numElements);
+        engine::KeyGenerator({.m_keyBits = 28}, numElements).generate(std::span<SORT_TYPE>(input));
+        std::vector<SORT_TYPE> output(numElements);
+
+        engine::MultiRadixSortExternal sorter(&gpu);
+        sorter.setMaxChunkElements(maxChunkElements);
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        sorter.sort(input.data(), output.data(), numElements);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double time = (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3));
+        std::cout << "[MultiRadixSortExternal] Sorted " << numElements << " elements in " << time << "[ms]." << std::endl;
+
+        gpu.shutdown();
+
+        std::sort(input.begin(), input.end());
+        if (input != output) {
+            throw std::runtime_error("TEST FAILED.");
+        }
+        std::cout << "[MultiRadixSortExternal] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
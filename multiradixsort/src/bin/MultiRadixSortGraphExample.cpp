@@ -0,0 +1,118 @@
+#include "MultiRadixSort.h"
+#include "engine/core/GPUContext.h"
+#include "engine/passes/PassGraph.h"
+#include "engine/util/Paths.h"
+
+#include <random>
+
+// usage: multiradixsortgraphexample [numElements] [numExecutions]
+// a pass graph of two independent sorts: upload A, sort A, download A, upload B, sort B, download B
+// the uploads and sorts run on the compute queues (A and B on different ones if the device has several), the downloads on the async transfer queue,
+// the download of A overlaps with the sort of B
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numElements = argc > 1 ? static_cast<uint32_t>(std::stod(argv[1])) : 1 << 22;
+    const uint32_t numExecutions = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 4;
+    const VkDeviceSize numElementsBytes = static_cast<VkDeviceSize>(numElements) * sizeof(SORT_TYPE);
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY | engine::Queues::ASYNC_TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        struct Sort {
+            std::shared_ptr<engine::MultiRadixSortPass> m_pass;
+            std::shared_ptr<engine::Buffer> m_upload; // host visible
+            std::shared_ptr<engine::Buffer> m_buffer0;
+            std::shared_ptr<engine::Buffer> m_buffer1;
+            std::shared_ptr<engine::Buffer> m_histograms;
+            std::shared_ptr<engine::Buffer> m_download; // host visible
+            std::vector<SORT_TYPE> m_reference;
+        };
+        std::array<Sort, 2> sorts;
+        for (auto &sort: sorts) {
+            sort.m_pass = std::make_shared<engine::MultiRadixSortPass>(&gpu);
+            sort.m_pass->create();
+            sort.m_pass->setNumElements(numElements, engine::MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+            sort.m_upload = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_name = "radixSortGraph.upload"});
+            sort.m_buffer0 = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortGraph.elementBuffer0"});
+            sort.m_buffer1 = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortGraph.elementBuffer1"});
+            sort.m_histograms = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = engine::MultiRadixSortPass::getHistogramsSizeBytes(sort.m_pass->getWorkGroupCount(engine::MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortGraph.histogramsBuffer"});
+            sort.m_download = std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = numElementsBytes, .m_bufferUsages = VK_BUFFER_USAGE_TRANSFER_DST_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_name = "radixSortGraph.download"});
+            sort.m_pass->setBuffers(sort.m_buffer0.get(), sort.m_buffer1.get(), sort.m_histograms.get());
+        }
+
+        auto copy = [numElementsBytes](engine::Buffer *src, engine::Buffer *dst) {
+            return [numElementsBytes, src, dst](VkCommandBuffer commandBuffer) {
+                VkBufferCopy region{.srcOffset = 0, .dstOffset = 0, .size = numElementsBytes};
+                vkCmdCopyBuffer(commandBuffer, src->getBuffer(), dst->getBuffer(), 1, &region);
+            };
+        };
+
+        engine::PassGraph graph(&gpu);
+        const std::array<std::string, 2> names = {"A", "B"};
+        for (uint32_t i = 0; i < sorts.size(); i++) {
+            Sort &sort = sorts[i];
+            graph.addPass("upload " + names[i], engine::Queues::COMPUTE, VK_PIPELINE_STAGE_TRANSFER_BIT, {sort.m_upload.get()}, {sort.m_buffer0.get()}, copy(sort.m_upload.get(), sort.m_buffer0.get()));
+            // the ping pong reads and writes all three buffers
+            const std::vector<engine::Buffer *> sortBuffers = {sort.m_buffer0.get(), sort.m_buffer1.get(), sort.m_histograms.get()};
+            graph.addPass("sort " + names[i], engine::Queues::COMPUTE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, sortBuffers, sortBuffers, [&sort](VkCommandBuffer commandBuffer) {
+                sort.m_pass->recordSort(commandBuffer, engine::MultiRadixSort::NUM_ITERATIONS);
+            });
+            graph.addPass("download " + names[i], engine::Queues::ASYNC_TRANSFER, VK_PIPELINE_STAGE_TRANSFER_BIT, {sort.m_buffer0.get()}, {sort.m_download.get()}, copy(sort.m_buffer0.get(), sort.m_download.get()));
+            graph.readOnHost(sort.m_download.get());
+        }
+
+        std::mt19937 random(42);
+        std::vector<SORT_TYPE> elements(numElements);
+        uint32_t failures = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (uint32_t execution = 0; execution < numExecutions; execution++) {
+            for (auto &sort: sorts) {
+                for (auto &key: elements) {
+                    key = random();
+                }
+                sort.m_upload->updateHostMemory(numElementsBytes, elements.data());
+                sort.m_reference = elements;
+                std::sort(sort.m_reference.begin(), sort.m_reference.end());
+            }
+
+            graph.execute();
+            if (execution == 0) {
+                graph.print(std::cout);
+            }
+            graph.wait();
+
+            for (auto &sort: sorts) {
+                sort.m_download->download(elements.data());
+                failures += elements != sort.m_reference ? 1 : 0;
+            }
+        }
+        const double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * 1e-3;
+
+        graph.release();
+        for (auto &sort: sorts) {
+            sort.m_upload->release();
+            sort.m_buffer0->release();
+            sort.m_buffer1->release();
+            sort.m_histograms->release();
+            sort.m_download->release();
+            sort.m_pass->release();
+        }
+        gpu.shutdown();
+
+        std::cout << "[MultiRadixSortGraph] " << numExecutions << " executions of 2 x " << numElements << " elements in " << ms << "[ms]." << std::endl;
+        if (failures > 0) {
+            std::cout << "[MultiRadixSortGraph] TEST FAILED (" << failures << " failures)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[MultiRadixSortGraph] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
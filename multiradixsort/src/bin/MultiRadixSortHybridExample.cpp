@@ -0,0 +1,50 @@
+#include "MultiRadixSortHybrid.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/KeyGenerator.h"
+#include "engine/util/Paths.h"
+
+#include <algorithm>
+
+// usage: multiradixsorthybridexample [numElements] [runs]
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+
+    const uint64_t numElements = argc > 1 ? static_cast<uint64_t>(std::stod(argv[1])) : 64000000;
+    const uint32_t runs = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 8;
+
+    try {
+        gpu.init();
+
+        std::vector<SORT_TYPE> input(numElements);
+        engine::KeyGenerator({.m_keyBits = sizeof(SORT_TYPE) * 8}, numElements).generate(std::span<SORT_TYPE>(input));
+        std::vector<SORT_TYPE> reference = input;
+        std::sort(reference.begin(), reference.end()); // not the CpuRadixSort that sorts a part of the keys
+
+        // the gpu fraction adapts to the throughput of both sides over the runs
+        engine::MultiRadixSortHybrid sorter(&gpu);
+        std::vector<SORT_TYPE> elements;
+        for (uint32_t run = 0; run < runs; run++) {
+            elements = input;
+            sorter.sortInPlace(elements);
+            const auto &timings = sorter.getTimings();
+            std::cout << "[MultiRadixSortHybrid] Run " << run << ": " << timings.m_totalMs << "[ms] (gpu " << timings.m_gpuElements << " elements in " << timings.m_gpuMs << "[ms], cpu " << timings.m_cpuElements << " elements in "
+                      << timings.m_cpuMs << "[ms], merge " << timings.m_mergeMs << "[ms])." << std::endl;
+            if (elements != reference) {
+                throw std::runtime_error("TEST FAILED.");
+            }
+        }
+        sorter.release();
+
+        gpu.shutdown();
+        std::cout << "[MultiRadixSortHybrid] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include "MultiRadixSort.h"
+#include "MultiRadixSortMortonPass.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+#include <numeric>
+#include <random>
+
+// spreads the lower 10 bits of v to every third bit (expandBits of multi_radixsort_morton.glsl)
+static uint32_t expandBits(uint32_t v) {
+    v = (v * 0x00010001U) & 0xFF0000FFU;
+    v = (v * 0x00000101U) & 0x0F00F00FU;
+    v = (v * 0x00000011U) & 0xC30C30C3U;
+    v = (v * 0x00000005U) & 0x49249249U;
+    return v;
+}
+
+// usage: multiradixsortmortonexample [numPrimitives]
+// random AABBs in a scene of [0, 1024]^3 (quarter units, so the centroids and codes are computed exactly on both sides),
+// the fused pass sorts the 30-bit morton codes of their centroids together with the primitive indices, compared with a stable sort on the host
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numPrimitives = argc > 1 ? static_cast<uint32_t>(std::stod(argv[1])) : 1 << 22;
+    const float sceneSize = 1024.0F;
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        std::mt19937 random(42);
+        std::vector<float> aabbs(static_cast<size_t>(numPrimitives) * 6);
+        for (uint32_t i = 0; i < numPrimitives; i++) {
+            for (uint32_t axis = 0; axis < 3; axis++) {
+                const float min = static_cast<float>(random() % 4000) * 0.25F;
+                aabbs[6 * i + axis] = min;
+                aabbs[6 * i + 3 + axis] = min + static_cast<float>(random() % 96) * 0.25F;
+            }
+        }
+        std::vector<float> sceneBounds = {0.0F, 0.0F, 0.0F, sceneSize, sceneSize, sceneSize};
+
+        const VkDeviceSize numPrimitivesBytes = static_cast<VkDeviceSize>(numPrimitives) * sizeof(SORT_TYPE);
+        auto aabbBuffer = engine::Buffer::createDeviceLocal(&gpu, static_cast<VkDeviceSize>(numPrimitives) * engine::MultiRadixSortMortonPass::AABB_SIZE_BYTES, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.aabbs", aabbs.data());
+        auto sceneBoundsBuffer = engine::Buffer::createDeviceLocal(&gpu, sceneBounds.size() * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.sceneBounds", sceneBounds.data());
+        auto keys0 = engine::Buffer::createDeviceLocal(&gpu, numPrimitivesBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.keys0");
+        auto keys1 = engine::Buffer::createDeviceLocal(&gpu, numPrimitivesBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.keys1");
+        auto values0 = engine::Buffer::createDeviceLocal(&gpu, numPrimitivesBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.values0");
+        auto values1 = engine::Buffer::createDeviceLocal(&gpu, numPrimitivesBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.values1");
+
+        auto sortPass = std::make_shared<engine::MultiRadixSortPass>(&gpu, true);
+        sortPass->create();
+        sortPass->setNumElements(numPrimitives, engine::MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+        auto mortonPass = std::make_shared<engine::MultiRadixSortMortonPass>(&gpu);
+        mortonPass->create();
+        mortonPass->setNumElements(numPrimitives, engine::MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+        auto histograms = engine::Buffer::createDeviceLocal(&gpu, engine::MultiRadixSortPass::getHistogramsSizeBytes(sortPass->getWorkGroupCount(engine::MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "morton.histograms");
+        mortonPass->setBuffers(sortPass.get(), aabbBuffer.get(), sceneBoundsBuffer.get(), keys0.get(), keys1.get(), histograms.get(), values0.get(), values1.get());
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        mortonPass->sort();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        // reference: morton codes of the centroids and a stable argsort on the host
+        std::vector<uint32_t> codes(numPrimitives);
+        for (uint32_t i = 0; i < numPrimitives; i++) {
+            uint32_t code = 0;
+            for (uint32_t axis = 0; axis < 3; axis++) {
+                const float centroid = 0.5F * (aabbs[6 * i + axis] + aabbs[6 * i + 3 + axis]);
+                const float p = std::clamp((centroid - sceneBounds[axis]) / (sceneBounds[3 + axis] - sceneBounds[axis]) * 1024.0F, 0.0F, 1023.0F);
+                code += expandBits(static_cast<uint32_t>(p)) << (2 - axis);
+            }
+            codes[i] = code;
+        }
+        std::vector<uint32_t> reference(numPrimitives);
+        std::iota(reference.begin(), reference.end(), 0);
+        std::stable_sort(reference.begin(), reference.end(), [&codes](uint32_t a, uint32_t b) { return codes[a] < codes[b]; });
+
+        std::vector<uint32_t> sortedCodes(numPrimitives);
+        std::vector<uint32_t> primitives(numPrimitives);
+        keys0->downloadWithStagingBuffer(sortedCodes.data());
+        values0->downloadWithStagingBuffer(primitives.data());
+        uint32_t failures = primitives != reference ? 1 : 0;
+        for (uint32_t i = 0; failures == 0 && i < numPrimitives; i++) {
+            failures += sortedCodes[i] != codes[reference[i]] ? 1 : 0;
+        }
+
+        mortonPass->release();
+        sortPass->release();
+        for (const auto &buffer: {aabbBuffer, sceneBoundsBuffer, keys0, keys1, values0, values1, histograms}) {
+            buffer->release();
+        }
+        gpu.shutdown();
+
+        std::cout << "[MultiRadixSortMorton] Morton codes and sort of " << numPrimitives << " primitives in " << (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * 1e-3) << "[ms]." << std::endl;
+        if (failures > 0) {
+            std::cout << "[MultiRadixSortMorton] TEST FAILED." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[MultiRadixSortMorton] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+#include "MultiRadixSortMultiDevice.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/KeyGenerator.h"
+#include "engine/util/Paths.h"
+
+#include <algorithm>
+
+// usage: multiradixsortmultideviceexample [numElements] [numContexts] [runs]
+// numContexts: one context per suitable device by default, more contexts than devices are created round robin on the same devices
+// (e.g. several logical devices on lavapipe)
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t requiredQueueFamilies = engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY;
+    const uint64_t numElements = argc > 1 ? static_cast<uint64_t>(std::stod(argv[1])) : 64000000;
+    const uint32_t runs = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 4;
+
+    std::vector<std::unique_ptr<engine::GPUContext>> gpus;
+    try {
+        const auto devices = engine::GPUContext::enumerateDevices(requiredQueueFamilies);
+        if (devices.empty()) {
+            throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+        }
+        const uint32_t numContexts = argc > 2 ? std::max(1U, static_cast<uint32_t>(std::stoul(argv[2]))) : static_cast<uint32_t>(devices.size());
+        std::vector<engine::GPUContext *> contexts;
+        for (uint32_t i = 0; i < numContexts; i++) {
+            auto gpu = std::make_unique<engine::GPUContext>(requiredQueueFamilies);
+            gpu->m_deviceSelection = {.m_policy = engine::GPUContext::DeviceSelection::Policy::INDEX, .m_index = devices[i % devices.size()].m_index};
+            gpu->init();
+            contexts.push_back(gpu.get());
+            gpus.push_back(std::move(gpu));
+        }
+
+        std::vector<SORT_TYPE> input(numElements);
+        engine::KeyGenerator({.m_keyBits = sizeof(SORT_TYPE) * 8}, numElements).generate(std::span<SORT_TYPE>(input));
+        std::vector<SORT_TYPE> reference = input;
+        std::sort(reference.begin(), reference.end()); // independent of the CpuRadixSort used for the splitters
+
+        // the shares of the devices adapt to their throughput over the runs
+        engine::MultiRadixSortMultiDevice sorter(contexts);
+        std::vector<SORT_TYPE> elements;
+        for (uint32_t run = 0; run < runs; run++) {
+            elements = input;
+            sorter.sortInPlace(elements);
+            if (elements != reference) {
+                throw std::runtime_error("TEST FAILED.");
+            }
+        }
+        sorter.release();
+
+        for (auto &gpu: gpus) {
+            gpu->shutdown();
+        }
+        std::cout << "[MultiRadixSortMultiDevice] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
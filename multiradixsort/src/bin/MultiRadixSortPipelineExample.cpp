@@ -0,0 +1,67 @@
+#include "MultiRadixSortPipeline.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/KeyGenerator.h"
+#include "engine/util/Paths.h"
+
+int main() {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY | engine::Queues::ASYNC_TRANSFER_FAMILY);
+
+    const uint32_t NUM_BATCHES = 16;
+    const uint32_t NUM_ELEMENTS_PER_BATCH = 1000000;
+
+    try {
+        gpu.init();
+
+        engine::MultiRadixSortPipeline pipeline(&gpu, NUM_ELEMENTS_PER_BATCH);
+        pipeline.create();
+
+        // the batches are consecutive ranges of one key sequence
+        engine::KeyGenerator generator({.m_keyBits = 28}, static_cast<uint64_t>(NUM_BATCHES) * NUM_ELEMENTS_PER_BATCH);
+
+        std::vector<uint32_t> batchSizes(NUM_BATCHES, NUM_ELEMENTS_PER_BATCH);
+        std::vector<uint64_t> checksums(NUM_BATCHES, 0);
+        bool passed = true;
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        pipeline.run(
+                batchSizes,
+                [&](uint32_t batchIndex, SORT_TYPE *elements, VALUE_TYPE *, uint32_t numElements) {
+                    // written directly into the mapped staging memory of the batch
+                    generator.generate(elements, numElements, static_cast<uint64_t>(batchIndex) * NUM_ELEMENTS_PER_BATCH);
+                    for (uint32_t i = 0; i < numElements; i++) {
+                        checksums[batchIndex] += elements[i];
+                    }
+                },
+                [&](uint32_t batchIndex, const SORT_TYPE *elements, const VALUE_TYPE *, uint32_t numElements) {
+                    uint64_t checksum = 0;
+                    for (uint32_t i = 0; i < numElements; i++) {
+                        checksum += elements[i];
+                    }
+                    if (!std::is_sorted(elements, elements + numElements) || checksum != checksums[batchIndex]) {
+                        std::cerr << "[MultiRadixSortPipeline] Batch " << batchIndex << " is not sorted correctly." << std::endl;
+                        passed = false;
+                    }
+                });
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double time = (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3));
+        std::cout << "[MultiRadixSortPipeline] Sorted " << NUM_BATCHES << " batches of " << NUM_ELEMENTS_PER_BATCH << " elements in " << time << "[ms] (including generation and verification)." << std::endl;
+
+        pipeline.release();
+
+        gpu.shutdown();
+
+        if (!passed) {
+            throw std::runtime_error("TEST FAILED.");
+        }
+        std::cout << "[MultiRadixSortPipeline] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "MultiRadixSort.h"
+#include "MultiRadixSortRunsPass.h"
+#include "engine/core/GPUContext.h"
+#include "engine/passes/PassGraph.h"
+#include "engine/util/Paths.h"
+
+#include <map>
+#include <random>
+
+// usage: multiradixsortrunsexample [numElements] [numUniqueKeys]
+// histogram of (key, value) pairs: the key value sort and the reduce by key pass are recorded into one command buffer,
+// the unique keys, the counts and the sums per key are only read after the submission, the result is compared with a std::map
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numElements = argc > 1 ? static_cast<uint32_t>(std::stod(argv[1])) : 1 << 22;
+    const uint32_t numUniqueKeys = argc > 2 ? std::max(1U, static_cast<uint32_t>(std::stod(argv[2]))) : 1 << 16;
+    const VkDeviceSize numElementsBytes = static_cast<VkDeviceSize>(numElements) * sizeof(SORT_TYPE);
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        std::mt19937 random(42);
+        std::vector<SORT_TYPE> keys(numElements);
+        std::vector<VALUE_TYPE> values(numElements);
+        for (uint32_t i = 0; i < numElements; i++) {
+            keys[i] = random() % numUniqueKeys;
+            values[i] = random() % 100;
+        }
+
+        auto sortPass = std::make_shared<engine::MultiRadixSortPass>(&gpu, true);
+        sortPass->create();
+        sortPass->setNumElements(numElements, engine::MultiRadixSort::NUM_BLOCKS_PER_WORKGROUP);
+        auto runsPass = std::make_shared<engine::MultiRadixSortRunsPass>(&gpu, true);
+        runsPass->create();
+        runsPass->setNumElements(numElements);
+
+        auto hostBuffer = [&](VkDeviceSize sizeBytes, const std::string &name) {
+            return std::make_shared<engine::Buffer>(&gpu, engine::Buffer::BufferSettings{.m_sizeBytes = sizeBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_preferredMemoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = name});
+        };
+        auto keys0 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "runs.keys0", keys.data());
+        auto keys1 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "runs.keys1");
+        auto values0 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "runs.values0", values.data());
+        auto values1 = engine::Buffer::createDeviceLocal(&gpu, numElementsBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "runs.values1");
+        auto histograms = engine::Buffer::createDeviceLocal(&gpu, engine::MultiRadixSortPass::getHistogramsSizeBytes(sortPass->getWorkGroupCount(engine::MultiRadixSortPass::RADIX_SORT_HISTOGRAMS).width), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "runs.histograms");
+        auto workgroupRuns = engine::Buffer::createDeviceLocal(&gpu, runsPass->getWorkgroupRunsSizeBytes(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "runs.workgroupRuns");
+        auto numRuns = hostBuffer(sizeof(uint32_t), "runs.numRuns");
+        auto uniqueKeys = hostBuffer(numElementsBytes, "runs.uniqueKeys");
+        auto runLengths = hostBuffer(numElementsBytes, "runs.runLengths");
+        auto runSums = hostBuffer(numElementsBytes, "runs.runSums");
+
+        sortPass->setBuffers(keys0.get(), keys1.get(), histograms.get(), values0.get(), values1.get());
+        runsPass->setBuffers(keys0.get(), workgroupRuns.get(), numRuns.get(), uniqueKeys.get(), runLengths.get(), values0.get(), runSums.get());
+        runsPass->setClearOutputs(false); // cleared by a transfer pass of the graph
+
+        // the graph places the barriers between the sort, the clear and the runs and the barriers for the host reads
+        engine::PassGraph graph(&gpu);
+        const std::vector<engine::Buffer *> sortBuffers = {keys0.get(), keys1.get(), values0.get(), values1.get(), histograms.get()};
+        graph.addPass("sort", engine::Queues::COMPUTE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, sortBuffers, sortBuffers, [&](VkCommandBuffer commandBuffer) {
+            sortPass->recordSort(commandBuffer, engine::MultiRadixSort::NUM_ITERATIONS);
+        });
+        graph.addPass("clear runs", engine::Queues::COMPUTE, VK_PIPELINE_STAGE_TRANSFER_BIT, {}, {runLengths.get(), runSums.get()}, [&](VkCommandBuffer commandBuffer) {
+            runsPass->recordClear(commandBuffer);
+        });
+        graph.addPass("reduce by key", engine::Queues::COMPUTE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {keys0.get(), values0.get(), workgroupRuns.get(), runLengths.get(), runSums.get()}, {workgroupRuns.get(), numRuns.get(), uniqueKeys.get(), runLengths.get(), runSums.get()}, [&](VkCommandBuffer commandBuffer) {
+            runsPass->record(commandBuffer);
+        });
+        for (const auto &buffer: {numRuns, uniqueKeys, runLengths, runSums}) {
+            graph.readOnHost(buffer.get());
+        }
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        graph.execute();
+        graph.wait();
+        const double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * 1e-3;
+
+        uint32_t runs = 0;
+        numRuns->download(&runs);
+        std::vector<uint32_t> gpuKeys(numElements);
+        std::vector<uint32_t> gpuLengths(numElements);
+        std::vector<uint32_t> gpuSums(numElements);
+        uniqueKeys->download(gpuKeys.data());
+        runLengths->download(gpuLengths.data());
+        runSums->download(gpuSums.data());
+
+        std::map<SORT_TYPE, std::pair<uint32_t, uint32_t>> reference; // key: count, sum
+        for (uint32_t i = 0; i < numElements; i++) {
+            reference[keys[i]].first++;
+            reference[keys[i]].second += values[i];
+        }
+        uint32_t failures = runs != reference.size() ? 1 : 0;
+        uint32_t run = 0;
+        for (auto it = reference.begin(); failures == 0 && it != reference.end(); ++it, ++run) {
+            if (gpuKeys[run] != it->first || gpuLengths[run] != it->second.first || gpuSums[run] != it->second.second) {
+                std::cerr << "[MultiRadixSortRuns] Run " << run << " differs." << std::endl;
+                failures++;
+            }
+        }
+
+        graph.release();
+        runsPass->release();
+        sortPass->release();
+        for (const auto &buffer: {keys0, keys1, values0, values1, histograms, workgroupRuns, numRuns, uniqueKeys, runLengths, runSums}) {
+            buffer->release();
+        }
+        gpu.shutdown();
+
+        std::cout << "[MultiRadixSortRuns] Sort and reduce by key of " << numElements << " pairs into " << runs << " runs in " << ms << "[ms]." << std::endl;
+        if (failures > 0) {
+            std::cout << "[MultiRadixSortRuns] TEST FAILED (" << failures << " failures)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[MultiRadixSortRuns] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
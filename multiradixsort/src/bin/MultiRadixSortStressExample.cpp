@@ -0,0 +1,79 @@
+#include "MultiRadixSort.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+// usage: multiradixsortstressexample [numThreads] [iterations] [maxElements]
+// all threads sort on the same context at the same time, every thread with its own pass and random input sizes
+// the passes are spread over the compute queues of the device, sorts on different queues overlap on the GPU
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numThreads = argc > 1 ? std::max(1U, static_cast<uint32_t>(std::stoul(argv[1]))) : 16;
+    const uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 32;
+    const uint64_t maxElements = argc > 3 ? std::max<uint64_t>(1, static_cast<uint64_t>(std::stod(argv[3]))) : 1 << 20;
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<uint32_t> failures = 0;
+    std::atomic<uint64_t> sortedElements = 0;
+    std::vector<std::thread> threads;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            try {
+                // a pass is used by one thread at a time
+                auto pass = std::make_shared<engine::MultiRadixSortPass>(&gpu);
+                pass->create();
+
+                std::mt19937_64 random(t);
+                std::uniform_int_distribution<uint64_t> sizes(1, maxElements);
+                std::uniform_int_distribution<SORT_TYPE> keys;
+                for (uint32_t i = 0; i < iterations; i++) {
+                    std::vector<SORT_TYPE> elements(sizes(random));
+                    for (auto &key: elements) {
+                        key = keys(random);
+                    }
+                    std::vector<SORT_TYPE> reference = elements;
+                    std::sort(reference.begin(), reference.end());
+
+                    engine::MultiRadixSort::sortInPlace(&gpu, elements, false, pass.get());
+                    if (elements != reference) {
+                        std::cerr << "[MultiRadixSortStress] Thread " << t << " iteration " << i << " (" << elements.size() << " elements) is not sorted." << std::endl;
+                        failures++;
+                    }
+                    sortedElements += elements.size();
+                }
+                pass->release();
+            } catch (const std::exception &e) {
+                std::cerr << "[MultiRadixSortStress] Thread " << t << ": " << e.what() << std::endl;
+                failures++;
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    const double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * 1e-3;
+
+    gpu.shutdown();
+
+    std::cout << "[MultiRadixSortStress] " << numThreads << " threads sorted " << sortedElements << " elements in " << ms << "[ms] on " << gpu.m_queues->getComputeQueueCount() << " compute queue(s)." << std::endl;
+    if (failures > 0) {
+        std::cout << "[MultiRadixSortStress] TEST FAILED (" << failures << " failures)." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "[MultiRadixSortStress] Test passed." << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include "MultiRadixSortFile.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+static void printUsage() {
+    std::cerr << "usage: vkradixsort-file <input> <output> [--payload-bytes N] [--max-chunk-elements N] [--threads N] [--cpu] [--device D]" << std::endl;
+    std::cerr << "  sorts the fixed-width records of <input> by their leading " << sizeof(SORT_TYPE) * 8 << "-bit unsigned key (native byte order)" << std::endl;
+    std::cerr << "  --payload-bytes N       every key is followed by N bytes of payload (default 0)" << std::endl;
+    std::cerr << "  --max-chunk-elements N  limits the number of records sorted on the gpu at once (default: from the memory budget)" << std::endl;
+    std::cerr << "  --threads N             number of merge / gather threads (default: hardware concurrency)" << std::endl;
+    std::cerr << "  --device D              best, a device index, uuid or name regex (default: ENGINE_DEVICE or the best device)" << std::endl;
+    std::cerr << "  --cpu                   sorts with the multi-threaded cpu radix sort (also used if no vulkan device is available)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    std::vector<std::string> paths;
+    uint32_t payloadSizeBytes = 0;
+    uint32_t maxChunkElements = 0;
+    uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency());
+    bool useDevice = true;
+    std::string deviceSelection;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (arg == "--payload-bytes" && i + 1 < argc) {
+                payloadSizeBytes = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--max-chunk-elements" && i + 1 < argc) {
+                maxChunkElements = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--threads" && i + 1 < argc) {
+                numThreads = std::max(1U, static_cast<uint32_t>(std::stoul(argv[++i])));
+            } else if (arg == "--cpu") {
+                useDevice = false;
+            } else if (arg == "--device" && i + 1 < argc) {
+                deviceSelection = argv[++i];
+            } else if (arg.rfind("--", 0) == 0) {
+                throw std::invalid_argument(arg);
+            } else {
+                paths.push_back(arg);
+            }
+        }
+    } catch (const std::exception &) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    if (paths.size() != 2) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY | engine::Queues::ASYNC_TRANSFER_FAMILY);
+    if (!deviceSelection.empty()) {
+        gpu.m_deviceSelection = engine::GPUContext::DeviceSelection::parse(deviceSelection);
+    }
+
+    try {
+        if (useDevice) {
+            try {
+                gpu.init();
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << " Falling back to the cpu radix sort." << std::endl;
+                useDevice = false;
+            }
+        }
+
+        engine::MultiRadixSortFile sorter(useDevice ? &gpu : nullptr, payloadSizeBytes, numThreads);
+        sorter.setMaxChunkElements(maxChunkElements);
+        sorter.sort(paths[0], paths[1]);
+
+        if (useDevice) {
+            gpu.shutdown();
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
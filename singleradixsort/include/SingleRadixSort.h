@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SingleRadixSortPass.h"
+#include "engine/util/KeyGenerator.h"
 
 #include <random>
 #include <utility>
@@ -29,6 +30,8 @@ namespace engine {
 
         const uint32_t NUM_ELEMENTS = 1000000;
 
+        static const uint64_t SEED = 42; // of the generated keys
+
         const uint32_t NUM_ELEMENTS_BYTES = NUM_ELEMENTS * sizeof(SORT_TYPE);
 
         std::vector<std::shared_ptr<Buffer>> m_buffers = std::vector<std::shared_ptr<Buffer>>(2);
@@ -47,7 +50,8 @@ namespace engine {
 
         void releaseBuffers();
 
-        static void generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements);
+        // keys with 4 (32-bit) or 20 (64-bit) leading zero bits, deterministic for the seed
+        static void generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements, KeyGenerator::Distribution distribution = KeyGenerator::Distribution::UNIFORM);
 
         static void generateZeros(std::vector<SORT_TYPE> &buffer, uint32_t numElements);
 
@@ -6,7 +6,9 @@
 namespace engine {
     class SingleRadixSortPass : public ComputePass {
     public:
-        explicit SingleRadixSortPass(GPUContext *gpuContext) : ComputePass(gpuContext) {
+        // segmented: every workgroup sorts one (offset, count) segment of the buffers (SEGMENTED variant, segments at binding 2),
+        // dispatch one workgroup per segment with setWorkGroupCount
+        explicit SingleRadixSortPass(GPUContext *gpuContext, bool segmented = false) : ComputePass(gpuContext), m_segmented(segmented) {
         }
 
         enum ComputeStage {
@@ -19,11 +21,24 @@ namespace engine {
 
         PushConstants m_pushConstants{};
 
+        // (offset, count) of a segment in the SEGMENTED variant
+        struct Segment {
+            uint32_t m_offset;
+            uint32_t m_count;
+        };
+
+        [[nodiscard]] bool isSegmented() const {
+            return m_segmented;
+        }
+
     protected:
         std::vector<std::shared_ptr<Shader>> createShaders() override;
 
         void recordCommands(VkCommandBuffer commandBuffer) override;
 
         void createPipelineLayouts() override;
+
+    private:
+        bool m_segmented;
     };
 } // namespace engine
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "SingleRadixSort.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <span>
+#include <thread>
+
+namespace engine {
+    /**
+     * Coalesces many small independent sorts into segmented batches of the single workgroup sort (SingleRadixSortPass SEGMENTED variant).
+     * Requests are gathered until the oldest one has waited m_maxLatency or a batch is full, packed into one host visible buffer
+     * with one (offset, count) segment per request, sorted with a single submit (one workgroup per segment) and copied back to the callers.
+     * m_maxLatency bounds the added tail latency, larger batches (m_maxBatchElements, m_maxBatchRequests) increase the throughput.
+     * submit may be called from any thread, the batches are formed and submitted by a worker thread of the scheduler.
+     */
+    class SingleRadixSortScheduler {
+    public:
+        struct Settings {
+            std::chrono::microseconds m_maxLatency{500}; // time the oldest request waits for more requests before its batch is submitted
+            uint64_t m_maxBatchElements = 1 << 22;       // keys per batch, a request must not be larger
+            uint32_t m_maxBatchRequests = 4096;          // segments (workgroups) per batch, at most maxComputeWorkGroupCount[0]
+        };
+
+        struct Statistics {
+            uint64_t m_batches = 0;
+            uint64_t m_requests = 0;
+            uint64_t m_elements = 0;
+            double m_totalLatencyMs = 0.0; // from submit to completion, summed over the requests
+            double m_maxLatencyMs = 0.0;
+
+            [[nodiscard]] double getAverageLatencyMs() const {
+                return m_requests > 0 ? m_totalLatencyMs / static_cast<double>(m_requests) : 0.0;
+            }
+
+            [[nodiscard]] double getAverageRequestsPerBatch() const {
+                return m_batches > 0 ? static_cast<double>(m_requests) / static_cast<double>(m_batches) : 0.0;
+            }
+        };
+
+        SingleRadixSortScheduler(GPUContext *gpuContext, Settings settings);
+
+        explicit SingleRadixSortScheduler(GPUContext *gpuContext) : SingleRadixSortScheduler(gpuContext, Settings{}) {
+        }
+
+        ~SingleRadixSortScheduler();
+
+        SingleRadixSortScheduler(const SingleRadixSortScheduler &) = delete;
+
+        SingleRadixSortScheduler &operator=(const SingleRadixSortScheduler &) = delete;
+
+        // sorts the keys in place, they have to stay valid until the future is ready (it rethrows errors of the batch)
+        std::future<void> submit(std::span<SORT_TYPE> keys);
+
+        void sort(std::span<SORT_TYPE> keys) {
+            submit(keys).get();
+        }
+
+        // sorts the pending requests, stops the worker and releases the pass and the buffers
+        void release();
+
+        [[nodiscard]] Statistics getStatistics();
+
+        [[nodiscard]] const Settings &getSettings() const {
+            return m_settings;
+        }
+
+    private:
+        struct Request {
+            std::span<SORT_TYPE> m_keys;
+            std::promise<void> m_promise;
+            std::chrono::steady_clock::time_point m_submitted;
+        };
+
+        GPUContext *m_gpuContext;
+        Settings m_settings;
+
+        std::shared_ptr<SingleRadixSortPass> m_pass;
+        std::shared_ptr<Buffer> m_keys0; // host visible, the packed requests before and after the sort
+        std::shared_ptr<Buffer> m_keys1;
+        std::shared_ptr<Buffer> m_segments; // host visible
+        SORT_TYPE *m_keys0Memory = nullptr;
+        SingleRadixSortPass::Segment *m_segmentsMemory = nullptr;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Request> m_requests;
+        uint64_t m_pendingElements = 0;
+        bool m_stop = false;
+        Statistics m_statistics;
+        std::thread m_worker;
+
+        static inline const char *PRINT_PREFIX = "[SingleRadixSortScheduler] ";
+
+        [[nodiscard]] bool isBatchFull() const {
+            return m_requests.size() >= m_settings.m_maxBatchRequests || m_pendingElements >= m_settings.m_maxBatchElements;
+        }
+
+        void workerLoop();
+
+        void sortBatch(std::vector<Request> &batch);
+    };
+} // namespace engine
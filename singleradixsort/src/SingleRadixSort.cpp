@@ -25,7 +25,7 @@ namespace engine {
         // execute pass
         std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
         m_pass->execute(VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_gpuContext->m_queues->getQueue(Queues::COMPUTE));
+        m_pass->wait();
         std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
         double gpuSortTime = (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) * std::pow(10, -3));
         std::cout << PRINT_PREFIX << "GPU sort finished in " << gpuSortTime << "[ms]." << std::endl;
@@ -82,19 +82,10 @@ namespace engine {
         }
     }
 
-    void SingleRadixSort::generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements) {
-        // https://en.cppreference.com/w/cpp/numeric/random/uniform_int_distribution
-        std::random_device rd;
-        std::mt19937 gen(rd());
-#ifdef SORT_32BIT
-        std::uniform_int_distribution<uint32_t> distrib(0, 0x0FFFFFFF);
-#else
-        std::uniform_int_distribution<uint64_t> distrib(0, 0x0FFFFFFFFFFF);
-#endif
-        for (int i = 0; i < numElements; i++) {
-            buffer.push_back(distrib(gen));
-            // buffer.push_back(numElements - i);
-        }
+    void SingleRadixSort::generateRandomNumbers(std::vector<SORT_TYPE> &buffer, uint32_t numElements, KeyGenerator::Distribution distribution) {
+        KeyGenerator generator({.m_distribution = distribution, .m_seed = SEED, .m_keyBits = sizeof(SORT_TYPE) == 4 ? 28U : 44U}, numElements);
+        buffer.resize(numElements);
+        generator.generate(std::span<SORT_TYPE>(buffer));
     }
 
     void SingleRadixSort::generateZeros(std::vector<SORT_TYPE> &buffer, uint32_t numElements) {
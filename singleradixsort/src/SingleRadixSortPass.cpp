@@ -1,9 +1,14 @@
 #include "SingleRadixSortPass.h"
+#include "shaders/single_radix_sort_shaders.h"
 
 namespace engine {
 
     std::vector<std::shared_ptr<Shader>> SingleRadixSortPass::createShaders() {
-        return {std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "single_radixsort.comp")};
+        std::vector<std::string> defines = {"SUBGROUP_SIZE=" + std::to_string(m_gpuContext->getSubgroupSize())};
+        if (m_segmented) {
+            defines.emplace_back("SEGMENTED");
+        }
+        return {std::make_shared<Shader>(m_gpuContext, Paths::m_resourceDirectoryPath + "/shaders", "single_radixsort.comp", defines, SINGLE_RADIX_SORT_SHADERS)};
     }
 
     void SingleRadixSortPass::recordCommands(VkCommandBuffer commandBuffer) {
@@ -11,6 +16,11 @@ namespace engine {
         recordCommandComputeShaderExecution(commandBuffer, RADIX_SORT);
         VkMemoryBarrier memoryBarrier0{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT};
         vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, {}, 1, &memoryBarrier0, 0, nullptr, 0, nullptr);
+        if (m_segmented) {
+            // the sorted keys of the segments are read back by the host from host visible memory
+            VkMemoryBarrier hostBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT, .dstAccessMask = VK_ACCESS_HOST_READ_BIT};
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, {}, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+        }
     }
 
     void SingleRadixSortPass::createPipelineLayouts() {
@@ -0,0 +1,150 @@
+#include "SingleRadixSortScheduler.h"
+
+namespace engine {
+
+    SingleRadixSortScheduler::SingleRadixSortScheduler(GPUContext *gpuContext, Settings settings) : m_gpuContext(gpuContext), m_settings(settings) {
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(m_gpuContext->m_physicalDevice, &deviceProperties);
+        m_settings.m_maxBatchRequests = std::clamp(m_settings.m_maxBatchRequests, 1U, deviceProperties.limits.maxComputeWorkGroupCount[0]);
+        m_settings.m_maxBatchElements = std::clamp<uint64_t>(m_settings.m_maxBatchElements, 1, deviceProperties.limits.maxStorageBufferRange / sizeof(SORT_TYPE));
+
+        m_pass = std::make_shared<SingleRadixSortPass>(m_gpuContext, true);
+        m_pass->create();
+
+        const VkDeviceSize keysBytes = m_settings.m_maxBatchElements * sizeof(SORT_TYPE);
+        const VkDeviceSize segmentsBytes = m_settings.m_maxBatchRequests * sizeof(SingleRadixSortPass::Segment);
+        m_keys0 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = keysBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_preferredMemoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortScheduler.keys0"});
+        m_keys1 = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = keysBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortScheduler.keys1"});
+        m_segments = std::make_shared<Buffer>(m_gpuContext, Buffer::BufferSettings{.m_sizeBytes = segmentsBytes, .m_bufferUsages = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, .m_preferredMemoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .m_name = "radixSortScheduler.segments"});
+        m_keys0Memory = static_cast<SORT_TYPE *>(m_keys0->mapHostMemory()); // persistently mapped
+        m_segmentsMemory = static_cast<SingleRadixSortPass::Segment *>(m_segments->mapHostMemory());
+
+        m_pass->setStorageBuffer(SingleRadixSortPass::RADIX_SORT, 0, m_keys0.get());
+        m_pass->setStorageBuffer(SingleRadixSortPass::RADIX_SORT, 1, m_keys1.get());
+        m_pass->setStorageBuffer(SingleRadixSortPass::RADIX_SORT, 2, m_segments.get());
+
+        m_worker = std::thread([this]() { workerLoop(); });
+    }
+
+    SingleRadixSortScheduler::~SingleRadixSortScheduler() {
+        release();
+    }
+
+    std::future<void> SingleRadixSortScheduler::submit(std::span<SORT_TYPE> keys) {
+        Request request{.m_keys = keys, .m_submitted = std::chrono::steady_clock::now()};
+        std::future<void> future = request.m_promise.get_future();
+        if (keys.size() <= 1) {
+            request.m_promise.set_value();
+            return future;
+        }
+        if (keys.size() > m_settings.m_maxBatchElements) {
+            throw std::runtime_error("Failed to schedule sort, the request is larger than a batch!");
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) {
+                throw std::runtime_error("Failed to schedule sort, the scheduler has been released!");
+            }
+            m_pendingElements += keys.size();
+            m_requests.push_back(std::move(request));
+        }
+        m_condition.notify_one();
+        return future;
+    }
+
+    void SingleRadixSortScheduler::release() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_one();
+        if (m_worker.joinable()) {
+            m_worker.join(); // after the pending requests
+        }
+        if (m_pass) {
+            m_keys0->unmapHostMemory();
+            m_segments->unmapHostMemory();
+            m_keys0->release();
+            m_keys1->release();
+            m_segments->release();
+            m_pass->release();
+            m_pass = nullptr;
+        }
+    }
+
+    SingleRadixSortScheduler::Statistics SingleRadixSortScheduler::getStatistics() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    void SingleRadixSortScheduler::workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_condition.wait(lock, [this]() { return m_stop || !m_requests.empty(); });
+            if (m_requests.empty()) {
+                return; // stopped and drained
+            }
+
+            // gather more requests within the latency budget of the oldest one
+            const auto deadline = m_requests.front().m_submitted + m_settings.m_maxLatency;
+            m_condition.wait_until(lock, deadline, [this]() { return m_stop || isBatchFull(); });
+
+            std::vector<Request> batch;
+            uint64_t batchElements = 0;
+            while (!m_requests.empty() && batch.size() < m_settings.m_maxBatchRequests && batchElements + m_requests.front().m_keys.size() <= m_settings.m_maxBatchElements) {
+                batchElements += m_requests.front().m_keys.size();
+                batch.push_back(std::move(m_requests.front()));
+                m_requests.pop_front();
+            }
+            m_pendingElements -= batchElements;
+
+            lock.unlock(); // requests keep arriving while the batch is sorted
+            sortBatch(batch);
+            lock.lock();
+
+            const auto completed = std::chrono::steady_clock::now();
+            m_statistics.m_batches++;
+            for (const auto &request: batch) {
+                const double latencyMs = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(completed - request.m_submitted).count()) * 1e-3;
+                m_statistics.m_requests++;
+                m_statistics.m_elements += request.m_keys.size();
+                m_statistics.m_totalLatencyMs += latencyMs;
+                m_statistics.m_maxLatencyMs = std::max(m_statistics.m_maxLatencyMs, latencyMs);
+            }
+        }
+    }
+
+    void SingleRadixSortScheduler::sortBatch(std::vector<Request> &batch) {
+        std::exception_ptr exception;
+        try {
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < batch.size(); i++) {
+                const auto &keys = batch[i].m_keys;
+                std::memcpy(m_keys0Memory + offset, keys.data(), keys.size_bytes());
+                m_segmentsMemory[i] = {offset, static_cast<uint32_t>(keys.size())};
+                offset += static_cast<uint32_t>(keys.size());
+            }
+
+            m_pass->m_pushConstants.g_num_elements = offset;
+            m_pass->setWorkGroupCount(SingleRadixSortPass::RADIX_SORT, static_cast<uint32_t>(batch.size()), 1, 1); // one workgroup per segment
+            m_pass->execute(VK_NULL_HANDLE);
+            m_pass->wait();
+
+            // an even number of iterations, the sorted segments are in keys0
+            for (uint32_t i = 0; i < batch.size(); i++) {
+                std::memcpy(batch[i].m_keys.data(), m_keys0Memory + m_segmentsMemory[i].m_offset, batch[i].m_keys.size_bytes());
+            }
+        } catch (...) {
+            std::cerr << PRINT_PREFIX << "Failed to sort a batch of " << batch.size() << " requests." << std::endl;
+            exception = std::current_exception();
+        }
+
+        for (auto &request: batch) {
+            if (exception) {
+                request.m_promise.set_exception(exception);
+            } else {
+                request.m_promise.set_value();
+            }
+        }
+    }
+} // namespace engine
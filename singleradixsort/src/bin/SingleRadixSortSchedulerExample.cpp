@@ -0,0 +1,73 @@
+#include "SingleRadixSortScheduler.h"
+#include "engine/core/GPUContext.h"
+#include "engine/util/Paths.h"
+
+#include <random>
+
+// usage: singleradixsortschedulerexample [numThreads] [requestsPerThread] [maxElements] [maxLatencyUs]
+// many threads submit small sorts at the same time, the scheduler coalesces them into segmented batches
+int main(int argc, char *argv[]) {
+#ifdef RESOURCE_DIRECTORY_PATH
+    engine::Paths::m_resourceDirectoryPath = RESOURCE_DIRECTORY_PATH;
+#endif
+
+    const uint32_t numThreads = argc > 1 ? std::max(1U, static_cast<uint32_t>(std::stoul(argv[1]))) : 8;
+    const uint32_t requestsPerThread = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 1000;
+    const uint32_t maxElements = argc > 3 ? std::max(1U, static_cast<uint32_t>(std::stoul(argv[3]))) : 4096;
+    engine::SingleRadixSortScheduler::Settings settings{};
+    if (argc > 4) {
+        settings.m_maxLatency = std::chrono::microseconds(std::stoul(argv[4]));
+    }
+
+    engine::GPUContext gpu(engine::Queues::QueueFamilies::COMPUTE_FAMILY | engine::Queues::TRANSFER_FAMILY);
+    try {
+        gpu.init();
+
+        engine::SingleRadixSortScheduler scheduler(&gpu, settings);
+        std::atomic<uint32_t> failures = 0;
+        std::vector<std::thread> threads;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (uint32_t t = 0; t < numThreads; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 random(t);
+                std::uniform_int_distribution<uint32_t> sizes(1, maxElements);
+                for (uint32_t i = 0; i < requestsPerThread; i++) {
+                    std::vector<SORT_TYPE> keys(sizes(random));
+                    for (auto &key: keys) {
+                        key = random();
+                    }
+                    std::vector<SORT_TYPE> reference = keys;
+                    std::sort(reference.begin(), reference.end());
+                    try {
+                        scheduler.sort(keys);
+                    } catch (const std::exception &e) {
+                        std::cerr << e.what() << std::endl;
+                        failures++;
+                        continue;
+                    }
+                    failures += keys != reference ? 1 : 0;
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        const double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()) * 1e-3;
+        const auto statistics = scheduler.getStatistics();
+        scheduler.release();
+        gpu.shutdown();
+
+        std::cout << "[SingleRadixSortScheduler] " << statistics.m_requests << " requests (" << statistics.m_elements << " elements) in " << statistics.m_batches << " batches ("
+                  << statistics.getAverageRequestsPerBatch() << " requests per batch), " << ms << "[ms], latency avg " << statistics.getAverageLatencyMs() << "[ms] max " << statistics.m_maxLatencyMs << "[ms]." << std::endl;
+        if (failures > 0) {
+            std::cout << "[SingleRadixSortScheduler] TEST FAILED (" << failures << " failures)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "[SingleRadixSortScheduler] Test passed." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}